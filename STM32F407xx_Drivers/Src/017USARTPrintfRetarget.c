@@ -0,0 +1,111 @@
+/*
+ * 017USARTPrintfRetarget.c
+ *
+ *  Created on: Oct 4, 2020
+ *      Author: Donavan Tran
+ *      Description: Write a program that prints debug messages with printf
+ *      			 over USART2 without blocking the main loop. printf only
+ *      			 copies the message into the Tx ring buffer, the TXE
+ *      			 interrupt sends it in the background. Characters typed
+ *      			 on the serial monitor are echoed back.
+ *
+ *      			 Baudrate: 115200 bps
+ *      			 Frame format: 1 stop bit, 8 bits data frame, no parity
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+GPIO_Handle_t USART_GPIO;
+USART_Handle_t USART_Handler;
+
+/*
+ * Ring buffers of the retarget layer (power of 2 sizes)
+ */
+RingBuffer_t TxRing;
+RingBuffer_t RxRing;
+uint8_t TxStorage[1024];
+uint8_t RxStorage[64];
+
+/*
+ * Helper function prototypes
+ */
+void USART_GPIO_Init();
+void USART_Handler_Init();
+
+int main(void) {
+	uint32_t loopCount = 0;
+	char ch;
+
+	//Set all element to 0
+	memset(&USART_GPIO, 0, sizeof(USART_GPIO));
+	memset(&USART_Handler, 0, sizeof(USART_Handler));
+
+	USART_GPIO_Init();
+	USART_Handler_Init();
+
+	RingBuffer_Init(&TxRing, TxStorage, sizeof(TxStorage));
+	RingBuffer_Init(&RxRing, RxStorage, sizeof(RxStorage));
+
+	USART_IRQITConfig(USART2_IRQ_NO, ENABLE);
+	USART_PeripheralEnable(USART2, ENABLE);
+
+	//Hot loop prints must never stall the application: drop on overflow
+	USART_Retarget_Init(&USART_Handler, &TxRing, &RxRing, USART_RETARGET_DROP);
+
+	//stdout is line buffered by newlib, make every printf reach _write right away
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	printf("USART printf retarget\r\n");
+
+	while(1) {
+		loopCount++;
+		if ((loopCount & 0xFFFFF) == 0) {
+			printf("loop %lu, dropped %lu\r\n", (unsigned long) loopCount, (unsigned long) USART_Retarget_GetDropCount());
+		}
+
+		//Echo the received characters
+		if (RingBuffer_Count(&RxRing)) {
+			ch = getchar();
+			putchar(ch);
+		}
+	}
+
+	return EXIT_SUCCESS;
+
+}
+
+void USART_GPIO_Init() {
+
+	//Use USART2
+	//USART2_TX		: PA2
+	//USART2_Rx		: PA3
+	USART_GPIO.pGPIOx = GPIOA;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinMode = GPIO_ALT_FUNC_MODE;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinAltFuncMode = AF7;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinOPType = GPIO_PUSH_PULL;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_PU;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_HIGH_SPEED;
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_2;
+	GPIO_Init(&USART_GPIO);
+
+	USART_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_3;
+	GPIO_Init(&USART_GPIO);
+}
+
+void USART_Handler_Init() {
+
+	//Using USART2
+	USART_Handler.pUSARTx = USART2;
+	USART_Handler.USART_Config.HWFlowControl = USART_HW_FLOW_CTRL_NONE;
+	USART_Handler.USART_Config.Mode = USART_MODE_TX_RX;
+	USART_Handler.USART_Config.Oversampling = USART_OVERSAMPLING_BY_16;
+	USART_Handler.USART_Config.BaudRate = USART_STD_BAUD_115200;
+	USART_Handler.USART_Config.NoOfStopBits = USART_STOPBITS_1;
+	USART_Handler.USART_Config.ParityControl = USART_PARITY_DI;
+	USART_Handler.USART_Config.WordLength = USART_WORDLEN_8BITS;
+	USART_Init(&USART_Handler);
+}
+
+void USART2_IRQHandler(void) {
+	USART_IRQHandling(&USART_Handler);
+}
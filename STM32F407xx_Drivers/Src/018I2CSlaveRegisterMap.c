@@ -0,0 +1,141 @@
+/*
+ * 018I2CSlaveRegisterMap.c
+ *
+ *  Created on: Oct 14, 2020
+ *      Author: Donavan Tran
+ *      Description: STM32 as I2C slave emulating a simple sensor. The host
+ *      			 controller writes [register][data...] and reads from the
+ *      			 register pointer on, like with any I2C sensor. Every byte
+ *      			 is handled by the driver ISR, the application is only
+ *      			 notified once the host has written registers (after STOP).
+ *
+ *      			 1. Use I2C SCL = 400 kHz (Fast mode), slave address 0x68
+ *      			 2. Use internall pull-up resistors for SDA and SCl lines
+ *
+ *      			 Register map:
+ *      			 0x00 WHO_AM_I	(read-only, 0xA5)
+ *      			 0x01 CTRL		(bit 0: enable, bits 7:4 sample rate)
+ *      			 0x02 STATUS	(read-only, bit 0: new sample)
+ *      			 0x03 DATA_L	(read-only)
+ *      			 0x04 DATA_H	(read-only)
+ *      			 0x05 THRESHOLD
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define SLAVE_ADDR			0x68
+
+#define REG_WHO_AM_I		0x00
+#define REG_CTRL			0x01
+#define REG_STATUS			0x02
+#define REG_DATA_L			0x03
+#define REG_DATA_H			0x04
+#define REG_THRESHOLD		0x05
+#define REG_COUNT			6
+
+GPIO_Handle_t I2C_GPIO;
+I2C_Handle_t I2C_Handler;
+
+/*
+ * Register file and the bits the host is allowed to write
+ */
+I2C_RegMap_t RegMap;
+uint8_t Regs[REG_COUNT] = { 0xA5, 0x00, 0x00, 0x00, 0x00, 0x80 };
+const uint8_t RegWriteMask[REG_COUNT] = { 0x00, 0xF1, 0x00, 0x00, 0x00, 0xFF };
+
+__vo uint8_t CtrlChanged = 0;
+
+/*
+ * Helper function prototypes
+ */
+void I2C_GPIO_Init();
+void I2C_Handler_Init();
+
+int main(void) {
+	uint16_t sample = 0;
+	uint32_t primask;
+
+	//Set all element to 0
+	memset(&I2C_GPIO, 0, sizeof(I2C_GPIO));
+	memset(&I2C_Handler, 0, sizeof(I2C_Handler));
+
+	I2C_GPIO_Init();
+	I2C_Handler_Init();
+	I2C_SlaveRegMapInit(&I2C_Handler, &RegMap, Regs, RegWriteMask, REG_COUNT);
+
+	//Enable the NVIC table for I2C Event an Error Interrupt
+	I2C_IRQITConfig(I2C1_EV_IRQ_NO, ENABLE);
+	I2C_IRQITConfig(I2C1_ER_IRQ_NO, ENABLE);
+	I2C_InterruptCtrl(I2C1, ENABLE);
+	I2C_PeripheralEnable(I2C1, ENABLE);
+
+	while(1) {
+		if (CtrlChanged) {
+			CtrlChanged = 0;
+			sample = 0;
+		}
+
+		if (Regs[REG_CTRL] & 0x01) {
+			sample++;
+
+			//DATA_L/DATA_H must not be read by the host in between the two writes
+			ENTER_CRITICAL(primask);
+			Regs[REG_DATA_L] = sample & 0xFF;
+			Regs[REG_DATA_H] = sample >> 8;
+			Regs[REG_STATUS] = ((sample & 0xFF) >= Regs[REG_THRESHOLD]) ? 0x01 : 0x00;
+			EXIT_CRITICAL(primask);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+//Called once per write transaction of the host, from the I2C ISR
+void I2C_ApplicationEventCallBack(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
+	I2C_RegMap_t* pRegMap = pI2CHandler->pRegMap;
+
+	if (appEvt == I2C_EVT_REGMAP_WRITE) {
+		if (pRegMap->ChangeStart <= REG_CTRL && (pRegMap->ChangeStart + pRegMap->ChangeLen) > REG_CTRL) {
+			CtrlChanged = 1;
+		}
+	}
+}
+
+void I2C_GPIO_Init() {
+
+	//Use I2C1
+	//I2C1_SCL	: PB6
+	//I2C1_SDA	: PB7
+	I2C_GPIO.pGPIOx = GPIOB;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinMode = GPIO_ALT_FUNC_MODE;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinAltFuncMode = AF4;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinOPType = GPIO_OPEN_DRAIN;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_PU;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_HIGH_SPEED;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&I2C_GPIO);
+
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&I2C_GPIO);
+}
+
+void I2C_Handler_Init() {
+	I2C_Handler.pI2Cx = I2C1;
+	I2C_Handler.I2C_Config.ACKControl = I2C_ACK_EN;
+	I2C_Handler.I2C_Config.FMDutyCycle = I2C_FM_DUTY_2;
+	I2C_Handler.I2C_Config.SCLSpeed = I2C_SCL_SPEED_FM;
+	I2C_Handler.I2C_Config.DeviceAddress = SLAVE_ADDR;
+
+	I2C_DeInit(I2C_Handler.pI2Cx);
+	I2C_Init(&I2C_Handler);
+}
+
+//Interrupt Service Routine to handle I2C1 Event Interrupt
+void I2C1_EV_IRQHandler(void) {
+	I2C_EV_IRQHandling(&I2C_Handler);
+}
+
+//Interrupt Service Routine to handle I2C1 Error Interrupt
+void I2C1_ER_IRQHandler(void) {
+	I2C_ER_IRQHandling(&I2C_Handler);
+}
@@ -0,0 +1,124 @@
+/*
+ * 019I2CEEPROMSimSlave.c
+ *
+ *  Created on: Oct 15, 2020
+ *      Author: Donavan Tran
+ *      Description: STM32 as I2C slave simulating a 24C02 EEPROM (256 bytes, 8-byte
+ *      			 pages) to test the EEPROM driver without the part. The memory is
+ *      			 served by the register map of the I2C driver. After each write
+ *      			 the slave stops acknowledging its address for the write cycle
+ *      			 time, like the real device, so the ACK polling of the master
+ *      			 is exercised.
+ *
+ *      			 1. Use I2C SCL = 400 kHz (Fast mode), slave address 0x50
+ *      			 2. Use internall pull-up resistors for SDA and SCl lines
+ *      			 3. Run 020I2CEEPROMParams.c on the master board
+ *
+ *      			 Note: The address counter wraps at the end of the array, not at
+ *      			 	   the end of the page like a real 24C02. The driver never
+ *      			 	   writes across a page so the difference is not seen
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define SLAVE_ADDR			EEPROM_24CXX_ADDR
+#define EEPROM_SIZE			256
+#define WRITE_CYCLE_MS		5
+
+GPIO_Handle_t I2C_GPIO;
+I2C_Handle_t I2C_Handler;
+
+/*
+ * Memory array, erased like a new part
+ */
+I2C_RegMap_t RegMap;
+uint8_t Memory[EEPROM_SIZE];
+
+__vo uint8_t WriteCycle = RESET;
+__vo uint32_t WriteCycleStart = 0;
+
+/*
+ * Helper function prototypes
+ */
+void I2C_GPIO_Init();
+void I2C_Handler_Init();
+
+int main(void) {
+	uint32_t cycleTime;
+
+	//Set all element to 0
+	memset(&I2C_GPIO, 0, sizeof(I2C_GPIO));
+	memset(&I2C_Handler, 0, sizeof(I2C_Handler));
+	memset(Memory, 0xFF, sizeof(Memory));
+
+	I2C_GPIO_Init();
+	I2C_Handler_Init();
+	I2C_SlaveRegMapInit(&I2C_Handler, &RegMap, Memory, NULL, EEPROM_SIZE);
+
+	//Enable the NVIC table for I2C Event an Error Interrupt
+	I2C_IRQITConfig(I2C1_EV_IRQ_NO, ENABLE);
+	I2C_IRQITConfig(I2C1_ER_IRQ_NO, ENABLE);
+	I2C_InterruptCtrl(I2C1, ENABLE);
+	I2C_PeripheralEnable(I2C1, ENABLE);
+
+	cycleTime = (RCC_GetHCLKFreq() / 1000U) * WRITE_CYCLE_MS;
+
+	while(1) {
+		//End of the write cycle: answer the address again
+		if (WriteCycle && (DWT_CYCCNT - WriteCycleStart) >= cycleTime) {
+			WriteCycle = RESET;
+			BITBAND_PERIPH(I2C1->CR1, I2C_CR1_ACK) = 1U;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+//Called once per write transaction of the master, from the I2C ISR
+void I2C_ApplicationEventCallBack(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
+	if (appEvt == I2C_EVT_REGMAP_WRITE) {
+		//Start of the write cycle: the address is not acknowledged (NACK) until it ends
+		BITBAND_PERIPH(pI2CHandler->pI2Cx->CR1, I2C_CR1_ACK) = 0U;
+		WriteCycleStart = DWT_CYCCNT;
+		WriteCycle = SET;
+	}
+}
+
+void I2C_GPIO_Init() {
+
+	//Use I2C1
+	//I2C1_SCL	: PB6
+	//I2C1_SDA	: PB7
+	I2C_GPIO.pGPIOx = GPIOB;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinMode = GPIO_ALT_FUNC_MODE;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinAltFuncMode = AF4;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinOPType = GPIO_OPEN_DRAIN;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_PU;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_HIGH_SPEED;
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&I2C_GPIO);
+
+	I2C_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&I2C_GPIO);
+}
+
+void I2C_Handler_Init() {
+	I2C_Handler.pI2Cx = I2C1;
+	I2C_Handler.I2C_Config.ACKControl = I2C_ACK_EN;
+	I2C_Handler.I2C_Config.FMDutyCycle = I2C_FM_DUTY_2;
+	I2C_Handler.I2C_Config.SCLSpeed = I2C_SCL_SPEED_FM;
+	I2C_Handler.I2C_Config.DeviceAddress = SLAVE_ADDR;
+
+	I2C_DeInit(I2C_Handler.pI2Cx);
+	I2C_Init(&I2C_Handler);
+}
+
+//Interrupt Service Routine to handle I2C1 Event Interrupt
+void I2C1_EV_IRQHandler(void) {
+	I2C_EV_IRQHandling(&I2C_Handler);
+}
+
+//Interrupt Service Routine to handle I2C1 Error Interrupt
+void I2C1_ER_IRQHandler(void) {
+	I2C_ER_IRQHandling(&I2C_Handler);
+}
@@ -0,0 +1,170 @@
+/*
+ * 020I2CEEPROMParams.c
+ *
+ *  Created on: Oct 15, 2020
+ *      Author: Donavan Tran
+ *      Description: STM32 master storing a parameter block in a 24C02 EEPROM with
+ *      			 the EEPROM driver. The block is updated field by field, first
+ *      			 with every write going to the device (write-through), then
+ *      			 through the write-back cache. The DWT cycles of both runs and the
+ *      			 driver statistics can be compared in the debugger: the cached
+ *      			 run merges the field writes into one page write per page.
+ *
+ *      			 1. Use I2C SCL = 400 kHz (Fast mode)
+ *      			 2. Use internall pull-up resistors for SDA and SCl lines
+ *      			 3. Use a 24C02 at 0x50, or a second board running 019I2CEEPROMSimSlave.c
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define MY_ADDR				0x61
+#define PARAMS_ADDR			0x10	//page aligned
+
+/*
+ * Parameter block (16 bytes, two 8-byte pages)
+ */
+typedef struct {
+	uint16_t	Magic;
+	uint16_t	Version;
+	uint32_t	BootCount;
+	uint16_t	Threshold;
+	uint8_t		Mode;
+	uint8_t		Flags;
+	uint32_t	Checksum;
+} Params_t;
+
+I2C_Handle_t I2C_Handler;
+EEPROM_Handle_t EEPROM_Handler;
+uint8_t EEPROMCache[8];
+
+Params_t Params;
+Params_t ParamsCheck;
+
+/*
+ * Results (watch them in the debugger)
+ */
+uint32_t CyclesWriteThrough = 0;
+uint32_t CyclesCached = 0;
+EEPROM_Stats_t StatsWriteThrough;
+EEPROM_Stats_t StatsCached;
+uint8_t ParamsMatch = RESET;
+uint8_t LastStatus = EEPROM_OK;
+
+/*
+ * Helper function prototypes
+ */
+void I2C_GPIO_Init();
+void I2C_Handler_Init();
+void EEPROM_Handler_Init(uint8_t* pCache);
+uint32_t SaveParams();
+
+int main(void) {
+
+	//Set all element to 0
+	memset(&I2C_Handler, 0, sizeof(I2C_Handler));
+
+	I2C_GPIO_Init();
+	I2C_Handler_Init();
+	I2C_PeripheralEnable(I2C1, ENABLE);
+
+	Params.Magic = 0xA55A;
+	Params.Version = 1;
+	Params.BootCount = 0;
+	Params.Threshold = 512;
+	Params.Mode = 2;
+	Params.Flags = 0x01;
+
+	//Every field write is a write cycle of its own
+	EEPROM_Handler_Init(NULL);
+	CyclesWriteThrough = SaveParams();
+	StatsWriteThrough = EEPROM_Handler.Stats;
+
+	//Field writes merged in the cache, one write cycle per page
+	EEPROM_Handler_Init(EEPROMCache);
+	CyclesCached = SaveParams();
+	StatsCached = EEPROM_Handler.Stats;
+
+	LastStatus = EEPROM_Read(&EEPROM_Handler, PARAMS_ADDR, (uint8_t*) &ParamsCheck, sizeof(ParamsCheck));
+	ParamsMatch = (LastStatus == EEPROM_OK && memcmp(&Params, &ParamsCheck, sizeof(Params)) == 0) ? SET : RESET;
+
+	while(1);
+
+	return EXIT_SUCCESS;
+}
+
+//Update the parameter block one field at a time, returns the DWT cycles spent
+//until the last write cycle is over
+uint32_t SaveParams() {
+	uint32_t start = DWT_CYCCNT;
+	uint8_t* pParams = (uint8_t*) &Params;
+
+	Params.BootCount++;
+	Params.Checksum = Params.Magic + Params.Version + Params.BootCount + Params.Threshold +
+					  Params.Mode + Params.Flags;
+
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Magic),
+				 pParams + offsetof(Params_t, Magic), sizeof(Params.Magic));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Version),
+				 pParams + offsetof(Params_t, Version), sizeof(Params.Version));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, BootCount),
+				 pParams + offsetof(Params_t, BootCount), sizeof(Params.BootCount));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Threshold),
+				 pParams + offsetof(Params_t, Threshold), sizeof(Params.Threshold));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Mode),
+				 pParams + offsetof(Params_t, Mode), sizeof(Params.Mode));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Flags),
+				 pParams + offsetof(Params_t, Flags), sizeof(Params.Flags));
+	EEPROM_Write(&EEPROM_Handler, PARAMS_ADDR + offsetof(Params_t, Checksum),
+				 pParams + offsetof(Params_t, Checksum), sizeof(Params.Checksum));
+
+	LastStatus = EEPROM_Flush(&EEPROM_Handler);
+	if (LastStatus == EEPROM_OK) {
+		LastStatus = EEPROM_WaitReady(&EEPROM_Handler);
+	}
+
+	return DWT_CYCCNT - start;
+}
+
+void I2C_GPIO_Init() {
+
+	//Use I2C1
+	//I2C1_SCL	: PB6
+	//I2C1_SDA	: PB7
+	//Both pins share one configuration, the port registers are written once
+	static const GPIO_PinConfig_t portB[] = {
+		{ GPIO_PIN_6 | GPIO_PIN_7, GPIO_ALT_FUNC_MODE, GPIO_HIGH_SPEED, GPIO_PU, GPIO_OPEN_DRAIN, AF4 },
+	};
+
+	GPIO_InitPort(GPIOB, portB, sizeof(portB) / sizeof(portB[0]));
+}
+
+void I2C_Handler_Init() {
+	I2C_Handler.pI2Cx = I2C1;
+	I2C_Handler.I2C_Config.ACKControl = I2C_ACK_EN;
+	I2C_Handler.I2C_Config.FMDutyCycle = I2C_FM_DUTY_2;
+	I2C_Handler.I2C_Config.SCLSpeed = I2C_SCL_SPEED_FM;
+	I2C_Handler.I2C_Config.DeviceAddress = MY_ADDR;
+
+	//Bus recovery pins
+	I2C_Handler.pSCLPort = GPIOB;
+	I2C_Handler.SCLPin = GPIO_PIN_6;
+	I2C_Handler.pSDAPort = GPIOB;
+	I2C_Handler.SDAPin = GPIO_PIN_7;
+
+	I2C_DeInit(I2C_Handler.pI2Cx);
+	I2C_Init(&I2C_Handler);
+}
+
+void EEPROM_Handler_Init(uint8_t* pCache) {
+	memset(&EEPROM_Handler, 0, sizeof(EEPROM_Handler));
+
+	//24C02: 256 bytes, 8-byte pages, 8-bit address
+	EEPROM_Handler.pI2CHandler = &I2C_Handler;
+	EEPROM_Handler.EEPROM_Config.DeviceAddress = EEPROM_24CXX_ADDR;
+	EEPROM_Handler.EEPROM_Config.Size = 256;
+	EEPROM_Handler.EEPROM_Config.PageSize = 8;
+	EEPROM_Handler.EEPROM_Config.AddrSize = I2C_MEM_ADDR_SIZE_8BIT;
+	EEPROM_Handler.pCache = pCache;
+
+	EEPROM_Init(&EEPROM_Handler);
+}
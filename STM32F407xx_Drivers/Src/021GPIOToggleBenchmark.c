@@ -0,0 +1,97 @@
+/*
+ * 021GPIOToggleBenchmark.c
+ *
+ *  Created on: Oct 15, 2020
+ *      Author: Donavan Tran
+ *      Description: Toggle frequency of an output pin with the driver calls and with
+ *      			 the inline fast path of gpio_driver.h. Each loop toggles the pin
+ *      			 TOGGLE_COUNT times and is timed with the DWT cycle counter.
+ *      			 Watch the results in the debugger, or measure PD12 with a scope.
+ *
+ *      			 Frequency of the pin (Hz) = HCLK / (2 * cycles per toggle)
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define TOGGLE_COUNT		10000U
+#define LED_PIN				GPIO_PIN_12
+
+/*
+ * Results in cycles per toggle (x100 to keep two decimals) and pin frequency in Hz
+ */
+uint32_t CyclesDriverToggle = 0;
+uint32_t CyclesDriverWrite = 0;
+uint32_t CyclesInlineToggle = 0;
+uint32_t CyclesInlineSetClear = 0;
+uint32_t FreqDriverToggle = 0;
+uint32_t FreqDriverWrite = 0;
+uint32_t FreqInlineToggle = 0;
+uint32_t FreqInlineSetClear = 0;
+
+/*
+ * Helper function prototypes
+ */
+void LED_GPIO_Init();
+uint32_t PinFrequency(uint32_t cycles);
+
+int main(void) {
+	uint32_t start;
+
+	LED_GPIO_Init();
+	DWT_CYCCNT_EN();
+
+	//Out-of-line driver calls
+	start = DWT_CYCCNT;
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i++) {
+		GPIO_ToggleOutputPin(GPIOD, LED_PIN);
+	}
+	CyclesDriverToggle = ((DWT_CYCCNT - start) * 100U) / TOGGLE_COUNT;
+
+	start = DWT_CYCCNT;
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i += 2) {
+		GPIO_WriteToOutputPin(GPIOD, LED_PIN, GPIO_PIN_SET);
+		GPIO_WriteToOutputPin(GPIOD, LED_PIN, GPIO_PIN_RESET);
+	}
+	CyclesDriverWrite = ((DWT_CYCCNT - start) * 100U) / TOGGLE_COUNT;
+
+	//Inline fast path
+	start = DWT_CYCCNT;
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i++) {
+		GPIO_TogglePins(GPIOD, LED_PIN);
+	}
+	CyclesInlineToggle = ((DWT_CYCCNT - start) * 100U) / TOGGLE_COUNT;
+
+	start = DWT_CYCCNT;
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i += 2) {
+		GPIO_SetPins(GPIOD, LED_PIN);
+		GPIO_ClearPins(GPIOD, LED_PIN);
+	}
+	CyclesInlineSetClear = ((DWT_CYCCNT - start) * 100U) / TOGGLE_COUNT;
+
+	FreqDriverToggle = PinFrequency(CyclesDriverToggle);
+	FreqDriverWrite = PinFrequency(CyclesDriverWrite);
+	FreqInlineToggle = PinFrequency(CyclesInlineToggle);
+	FreqInlineSetClear = PinFrequency(CyclesInlineSetClear);
+
+	while(1);
+
+	return EXIT_SUCCESS;
+}
+
+//One period of the pin is two toggles
+uint32_t PinFrequency(uint32_t cycles) {
+	return (uint32_t) (((uint64_t) RCC_GetHCLKFreq() * 100U) / (2U * cycles));
+}
+
+void LED_GPIO_Init() {
+	GPIO_Handle_t GPIO_LED;
+
+	memset(&GPIO_LED, 0, sizeof(GPIO_LED));
+	GPIO_LED.pGPIOx = GPIOD;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinNumber = LED_PIN;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinMode = GPIO_OUTPUT_MODE;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_VERY_HIGH_SPEED;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinOPType = GPIO_PUSH_PULL;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_NO_PU_PD;
+	GPIO_Init(&GPIO_LED);
+}
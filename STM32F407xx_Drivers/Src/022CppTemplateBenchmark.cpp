@@ -0,0 +1,112 @@
+/*
+ * 022CppTemplateBenchmark.cpp
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: The same work done with the C driver API and with the C++
+ *      			 template layer (stm32f407xx.hpp): LED pin init, 1000 toggles of
+ *      			 the LED and SPI1 master init. Each variant lives in its own
+ *      			 noinline function timed with the DWT cycle counter.
+ *
+ *      			 Cycles: watch the Cycles* results in the debugger
+ *      			 Size  : arm-none-eabi-nm -S --size-sort -C Debug/STM32F407xx_Drivers.elf | grep Bench
+ *
+ *      			 Build with the G++ compiler (-std=c++17), -Os or -O2
+ */
+
+#include "../drivers/Inc/stm32f407xx.hpp"
+
+using namespace stm32f407;
+
+#define TOGGLE_COUNT		1000U
+
+using Led = Gpio<PortD, 12>;
+using Spi1 = Spi<1>;
+
+/*
+ * Results in DWT cycles (watch them in the debugger)
+ */
+uint32_t CyclesInitC = 0;
+uint32_t CyclesInitCpp = 0;
+uint32_t CyclesToggleC = 0;
+uint32_t CyclesToggleCpp = 0;
+uint32_t CyclesSpiInitC = 0;
+uint32_t CyclesSpiInitCpp = 0;
+
+/*
+ * Benchmark functions (one symbol each for the size comparison)
+ */
+__attribute__((noinline)) void BenchInitC() {
+	GPIO_Handle_t GPIO_LED;
+
+	memset(&GPIO_LED, 0, sizeof(GPIO_LED));
+	GPIO_LED.pGPIOx = GPIOD;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_12;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinMode = GPIO_OUTPUT_MODE;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_LOW_SPEED;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinOPType = GPIO_PUSH_PULL;
+	GPIO_LED.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_NO_PU_PD;
+	GPIO_Init(&GPIO_LED);
+}
+
+__attribute__((noinline)) void BenchInitCpp() {
+	Led::output();
+}
+
+__attribute__((noinline)) void BenchToggleC() {
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i++) {
+		GPIO_ToggleOutputPin(GPIOD, GPIO_PIN_12);
+	}
+}
+
+__attribute__((noinline)) void BenchToggleCpp() {
+	for (uint32_t i = 0; i < TOGGLE_COUNT; i++) {
+		Led::toggle();
+	}
+}
+
+__attribute__((noinline)) void BenchSpiInitC() {
+	SPI_Handle_t SPI_Handler;
+
+	memset(&SPI_Handler, 0, sizeof(SPI_Handler));
+	SPI_Handler.pSPIx = SPI1;
+	SPI_Handler.SPI_Config.DeviceMode = SPI_DEVICE_MASTER_MODE;
+	SPI_Handler.SPI_Config.BusConfig = SPI_BUS_CONFIG_FULL_DUPLX;
+	SPI_Handler.SPI_Config.SclkSpeed = SPI_SCLK_SPEED_DIV8;
+	SPI_Handler.SPI_Config.DFF = SPI_DFF_8_BIT;
+	SPI_Handler.SPI_Config.CPOLConfig = SPI_CPOL_LOW;
+	SPI_Handler.SPI_Config.CPHAConfig = SPI_CPHA_LOW;
+	SPI_Handler.SPI_Config.SSM = SPI_SSM;
+	SPI_Init(&SPI_Handler);
+	SPI_PeripheralEnable(SPI1, ENABLE);
+}
+
+__attribute__((noinline)) void BenchSpiInitCpp() {
+	Spi1::master<SPI_SCLK_SPEED_DIV8>();
+}
+
+//Run one benchmark function and return its DWT cycles
+static uint32_t Measure(void (*pBench)()) {
+	uint32_t start = DWT_CYCCNT;
+	pBench();
+	return DWT_CYCCNT - start;
+}
+
+int main(void) {
+	DWT_CYCCNT_EN();
+
+	CyclesInitC = Measure(BenchInitC);
+	CyclesInitCpp = Measure(BenchInitCpp);
+	CyclesToggleC = Measure(BenchToggleC);
+	CyclesToggleCpp = Measure(BenchToggleCpp);
+
+	//SPI1 pins PA5/PA6/PA7 (checked at compile time)
+	Spi1::pins<Gpio<PortA, 5>, Gpio<PortA, 6>, Gpio<PortA, 7>>();
+	CyclesSpiInitC = Measure(BenchSpiInitC);
+	Spi1::disable();
+	CyclesSpiInitCpp = Measure(BenchSpiInitCpp);
+
+	while(1);
+
+	return EXIT_SUCCESS;
+}
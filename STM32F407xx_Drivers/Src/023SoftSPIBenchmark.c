@@ -0,0 +1,109 @@
+/*
+ * 023SoftSPIBenchmark.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: SCLK reached by the software SPI master in each mode. Every run
+ *      			 sends BENCH_LEN bytes with SoftSPI_TransmitReceive() and is timed
+ *      			 with the DWT cycle counter. MOSI is looped back to MISO, so every
+ *      			 run also checks the data received. Build with -O2 and watch the
+ *      			 results in the debugger, or measure PE2 with a scope.
+ *
+ *      			 SCLK (Hz) = HCLK * bits sent / cycles of the run
+ *
+ *      			 1. SCK: PE2, MOSI: PE6, MISO: PE5
+ *      			 2. Connect PE6 to PE5 with a jumper wire
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define BENCH_LEN			256U
+
+/*
+ * Runs of the benchmark
+ */
+#define RUN_MODE0			0U		//CPOL 0, CPHA 0, 8-bit, MSB first
+#define RUN_MODE1			1U		//CPOL 0, CPHA 1
+#define RUN_MODE2			2U		//CPOL 1, CPHA 0
+#define RUN_MODE3			3U		//CPOL 1, CPHA 1
+#define RUN_LSB_FIRST		4U		//mode 0, LSB first
+#define RUN_16_BIT			5U		//mode 0, 16-bit frames
+#define RUN_PACED_1MHZ		6U		//mode 0, paced at 1 MHz
+#define RUN_COUNT			7U
+
+/*
+ * Results: SCLK frequency in Hz and bytes received wrong of each run
+ */
+uint32_t SclkFreq[RUN_COUNT];
+uint32_t Errors[RUN_COUNT];
+
+uint8_t TxBuffer[BENCH_LEN];
+uint8_t RxBuffer[BENCH_LEN];
+
+SoftSPI_Handle_t SoftSPI_Handler;
+
+/*
+ * Helper function prototypes
+ */
+void SoftSPI_Handler_Init(uint8_t cpol, uint8_t cpha, uint8_t dff, uint8_t firstBit, uint32_t speed);
+void Bench_Run(uint8_t run);
+
+int main(void) {
+	for (uint32_t i = 0; i < BENCH_LEN; i++) {
+		TxBuffer[i] = (uint8_t) (i * 37U + 11U);
+	}
+	DWT_CYCCNT_EN();
+
+	SoftSPI_Handler_Init(SPI_CPOL_LOW, SPI_CPHA_LOW, SPI_DFF_8_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_MODE0);
+	SoftSPI_Handler_Init(SPI_CPOL_LOW, SPI_CPHA_HIGH, SPI_DFF_8_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_MODE1);
+	SoftSPI_Handler_Init(SPI_CPOL_HIGH, SPI_CPHA_LOW, SPI_DFF_8_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_MODE2);
+	SoftSPI_Handler_Init(SPI_CPOL_HIGH, SPI_CPHA_HIGH, SPI_DFF_8_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_MODE3);
+	SoftSPI_Handler_Init(SPI_CPOL_LOW, SPI_CPHA_LOW, SPI_DFF_8_BIT, SOFTSPI_LSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_LSB_FIRST);
+	SoftSPI_Handler_Init(SPI_CPOL_LOW, SPI_CPHA_LOW, SPI_DFF_16_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_MAX);
+	Bench_Run(RUN_16_BIT);
+	SoftSPI_Handler_Init(SPI_CPOL_LOW, SPI_CPHA_LOW, SPI_DFF_8_BIT, SOFTSPI_MSB_FIRST, SOFTSPI_SCLK_1MHZ);
+	Bench_Run(RUN_PACED_1MHZ);
+
+	while(1);
+
+	return EXIT_SUCCESS;
+}
+
+void Bench_Run(uint8_t run) {
+	uint32_t start, cycles;
+
+	memset(RxBuffer, 0, sizeof(RxBuffer));
+
+	start = DWT_CYCCNT;
+	SoftSPI_TransmitReceive(&SoftSPI_Handler, TxBuffer, RxBuffer, BENCH_LEN);
+	cycles = DWT_CYCCNT - start;
+
+	SclkFreq[run] = (uint32_t) (((uint64_t) RCC_GetHCLKFreq() * BENCH_LEN * 8U) / cycles);
+
+	Errors[run] = 0;
+	for (uint32_t i = 0; i < BENCH_LEN; i++) {
+		if (RxBuffer[i] != TxBuffer[i]) {
+			Errors[run]++;
+		}
+	}
+}
+
+void SoftSPI_Handler_Init(uint8_t cpol, uint8_t cpha, uint8_t dff, uint8_t firstBit, uint32_t speed) {
+	SoftSPI_Handler.pSCKPort = GPIOE;
+	SoftSPI_Handler.SCKPin = GPIO_PIN_2;
+	SoftSPI_Handler.pMOSIPort = GPIOE;
+	SoftSPI_Handler.MOSIPin = GPIO_PIN_6;
+	SoftSPI_Handler.pMISOPort = GPIOE;
+	SoftSPI_Handler.MISOPin = GPIO_PIN_5;
+	SoftSPI_Handler.SoftSPI_Config.CPOLConfig = cpol;
+	SoftSPI_Handler.SoftSPI_Config.CPHAConfig = cpha;
+	SoftSPI_Handler.SoftSPI_Config.DFF = dff;
+	SoftSPI_Handler.SoftSPI_Config.FirstBit = firstBit;
+	SoftSPI_Handler.SoftSPI_Config.SclkSpeed = speed;
+	SoftSPI_Init(&SoftSPI_Handler);
+}
@@ -0,0 +1,76 @@
+/*
+ * 024OneWireDS18B20.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: Chain of DS18B20 temperature sensors on one 1-Wire bus. The ROM
+ *      			 codes are found once by the ROM search, then every second all the
+ *      			 sensors convert at once (SKIP ROM) and are read one by one with
+ *      			 the CRC-8 of the scratchpad checked. Watch Temperature[] (x100 in
+ *      			 degree Celsius) and the bus statistics in the debugger.
+ *
+ *      			 1. 1-Wire bus: PC9, external 4.7 kOhm pull-up to 3V3
+ *      			 2. Sensors powered from VDD (no parasite power)
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define MAX_SENSORS			8U
+#define PERIOD_MS			1000U
+
+/*
+ * Results
+ */
+uint8_t SensorRom[MAX_SENSORS][OW_ROM_SIZE];
+uint8_t SensorCount = 0;
+int32_t Temperature[MAX_SENSORS];	//degree Celsius x100
+uint8_t Status[MAX_SENSORS];		//@OW_STATUS of the last read
+
+OW_Handle_t OW_Handler;
+
+/*
+ * Helper function prototypes
+ */
+void OW_Handler_Init();
+void delay_ms(uint32_t ms);
+
+int main(void) {
+	int16_t raw;
+
+	OW_Handler_Init();
+
+	SensorCount = OW_SearchAll(&OW_Handler, SensorRom, MAX_SENSORS);
+
+	while (1) {
+		//One conversion for the whole chain instead of one per sensor
+		if (DS18B20_StartConversion(&OW_Handler, NULL) == OW_OK) {
+			while (!DS18B20_IsConversionDone(&OW_Handler));
+		}
+
+		for (uint8_t i = 0; i < SensorCount; i++) {
+			Status[i] = DS18B20_ReadTemperature(&OW_Handler, SensorRom[i], &raw);
+			if (Status[i] == OW_OK) {
+				Temperature[i] = ((int32_t) raw * 100) / 16;
+			}
+		}
+
+		delay_ms(PERIOD_MS);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+void OW_Handler_Init() {
+	memset(&OW_Handler, 0, sizeof(OW_Handler));
+	OW_Handler.OW_GPIO.pGPIOx = GPIOC;
+	OW_Handler.OW_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_9;
+	OW_Handler.OW_GPIO.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_NO_PU_PD;
+	OW_Init(&OW_Handler);
+}
+
+void delay_ms(uint32_t ms) {
+	uint32_t start = DWT_CYCCNT;
+	uint32_t cycles = (RCC_GetHCLKFreq() / 1000U) * ms;
+
+	while ((DWT_CYCCNT - start) < cycles);
+}
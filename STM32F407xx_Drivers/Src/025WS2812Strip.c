@@ -0,0 +1,128 @@
+/*
+ * 025WS2812Strip.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: Rainbow running on a WS2812 LED strip. TIM4 channel 1 sends the
+ *      			 bit stream, DMA1 Stream 6 feeds its CCR1 from a small circular
+ *      			 buffer refilled in the half/full transfer interrupts, the CPU is
+ *      			 free during the refresh. Watch FrameCount in the debugger.
+ *
+ *      			 1. Data in: PB6 (TIM4_CH1, AF2), through a 3V3 to 5V level shifter
+ *      			 2. Strip powered from its own 5V supply, common ground
+ */
+
+#include "../drivers/Inc/stm32f407xx.h"
+
+#define NUM_LEDS			60U
+#define PERIOD_MS			20U
+
+uint8_t Pixels[NUM_LEDS * 3U];
+__vo uint32_t FrameCount = 0;
+
+GPIO_Handle_t WS2812_GPIO;
+DMA_Handle_t DMA_Handler;
+WS2812_Handle_t WS2812_Handler;
+
+/*
+ * Helper function prototypes
+ */
+void WS2812_GPIO_Init();
+void WS2812_Handler_Init();
+void wheel(uint8_t pos, uint8_t* pRed, uint8_t* pGreen, uint8_t* pBlue);
+void delay_ms(uint32_t ms);
+
+int main(void) {
+	uint8_t offset = 0;
+	uint8_t red, green, blue;
+
+	if (!(DWT_CTRL & (1 << DWT_CTRL_CYCCNTENA))) {
+		DWT_CYCCNT_EN();
+	}
+
+	WS2812_GPIO_Init();
+	WS2812_Handler_Init();
+
+	DMA_IRQITConfig(DMA1_STREAM6_IRQ_NO, ENABLE);
+
+	while (1) {
+		//The previous frame is still read by the DMA interrupt
+		while (WS2812_Handler.State == WS2812_BUSY);
+
+		for (uint16_t i = 0; i < NUM_LEDS; i++) {
+			wheel((uint8_t) (offset + i * 256U / NUM_LEDS), &red, &green, &blue);
+			WS2812_SetPixel(&WS2812_Handler, i, red >> 3, green >> 3, blue >> 3);
+		}
+		offset++;
+
+		WS2812_Refresh(&WS2812_Handler);
+		delay_ms(PERIOD_MS);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+void WS2812_GPIO_Init() {
+	memset(&WS2812_GPIO, 0, sizeof(WS2812_GPIO));
+	WS2812_GPIO.pGPIOx = GPIOB;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinMode = GPIO_ALT_FUNC_MODE;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinAltFuncMode = AF2;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinOPType = GPIO_PUSH_PULL;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_NO_PU_PD;
+	WS2812_GPIO.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_HIGH_SPEED;
+	GPIO_Init(&WS2812_GPIO);
+}
+
+void WS2812_Handler_Init() {
+	//TIM4_UP: DMA1 Stream 6 Channel 2
+	memset(&DMA_Handler, 0, sizeof(DMA_Handler));
+	DMA_Handler.pDMAx = DMA1;
+	DMA_Handler.DMA_Config.Stream = 6;
+	DMA_Handler.DMA_Config.Channel = 2;
+	DMA_Handler.DMA_Config.Priority = DMA_PRIORITY_HIGH;
+
+	memset(&WS2812_Handler, 0, sizeof(WS2812_Handler));
+	WS2812_Handler.pTIMx = TIM4;
+	WS2812_Handler.Channel = 1;
+	WS2812_Handler.pDMAHandler = &DMA_Handler;
+	WS2812_Handler.pPixels = Pixels;
+	WS2812_Handler.NumLeds = NUM_LEDS;
+	WS2812_Init(&WS2812_Handler);
+}
+
+//Color wheel: red -> green -> blue -> red
+void wheel(uint8_t pos, uint8_t* pRed, uint8_t* pGreen, uint8_t* pBlue) {
+	uint8_t step = (pos % 85U) * 3U;
+
+	if (pos < 85U) {
+		*pRed = 255U - step;
+		*pGreen = step;
+		*pBlue = 0;
+	} else if (pos < 170U) {
+		*pRed = 0;
+		*pGreen = 255U - step;
+		*pBlue = step;
+	} else {
+		*pRed = step;
+		*pGreen = 0;
+		*pBlue = 255U - step;
+	}
+}
+
+void delay_ms(uint32_t ms) {
+	uint32_t start = DWT_CYCCNT;
+	uint32_t cycles = (RCC_GetHCLKFreq() / 1000U) * ms;
+
+	while ((DWT_CYCCNT - start) < cycles);
+}
+
+void DMA1_Stream6_IRQHandler(void) {
+	DMA_IRQHandling(&DMA_Handler);
+}
+
+void WS2812_ApplicationEventCallback(WS2812_Handle_t* pWS2812Handler, uint8_t appEvt) {
+	if (appEvt == WS2812_EVT_REFRESH_CMPLT) {
+		FrameCount++;
+	}
+}
@@ -0,0 +1,114 @@
+/*
+ * STM32F407xx_DMA_Driver.h
+ *
+ *  Created on: Oct 12, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains specific details and implementations
+ *      			 of the DMA1/DMA2 stream controllers
+ */
+
+//Outside of the guard: included first, the main header pulls the drivers in its
+//own order and the ones built on DMA_Handle_t (I2C, WS2812) see the complete types
+#include "stm32f407xx.h"
+
+#ifndef INC_STM32F407XX_DMA_DRIVER_H_
+#define INC_STM32F407XX_DMA_DRIVER_H_
+
+/*****************SPECIFIC MACROS FOR DMA*********************/
+
+/*
+ * @DMA_DIRECTION
+ * Note: Memory-to-memory is only available on DMA2
+ */
+#define DMA_DIR_PERIPH_TO_MEM			0U
+#define DMA_DIR_MEM_TO_PERIPH			1U
+#define DMA_DIR_MEM_TO_MEM				2U
+
+/*
+ * @DMA_PRIORITY
+ */
+#define DMA_PRIORITY_LOW				0U
+#define DMA_PRIORITY_MEDIUM				1U
+#define DMA_PRIORITY_HIGH				2U
+#define DMA_PRIORITY_VERY_HIGH			3U
+
+/*
+ * @DMA_DATA_SIZE (same width on the peripheral and the memory side)
+ */
+#define DMA_DATA_SIZE_BYTE				0U
+#define DMA_DATA_SIZE_HALFWORD			1U
+#define DMA_DATA_SIZE_WORD				2U
+
+/*
+ * DMA application events
+ */
+#define DMA_EVT_TRANSFER_CMPLT			0U
+#define DMA_EVT_HALF_CMPLT				1U
+#define DMA_ERR_TRANSFER				2U		//Bus error, the stream is disabled by hardware
+#define DMA_ERR_DIRECT_MODE				3U
+#define DMA_ERR_FIFO					4U
+
+/*************************************************************/
+
+/*
+ * DMA stream configuration structure
+ */
+typedef struct {
+	uint8_t  Stream;			//0 to 7
+	uint8_t  Channel;			//Request channel 0 to 7 (see the DMA request mapping table of the RM)
+	uint8_t  Direction;			//@DMA_DIRECTION
+	uint8_t  Priority;			//@DMA_PRIORITY
+	uint8_t  DataSize;			//@DMA_DATA_SIZE
+	uint8_t  MemInc;			//ENABLE: increment the memory address after each data
+	uint8_t  Circular;			//ENABLE: reload NDTR at the end of the transfer
+	uint8_t  HalfTransferIT;	//ENABLE: report DMA_EVT_HALF_CMPLT
+} DMA_Config_t;
+
+/*
+ * DMA Handle structure
+ */
+typedef struct DMA_Handle DMA_Handle_t;
+typedef void (*DMA_Callback_t)(DMA_Handle_t* pDMAHandler, uint8_t appEvt);
+
+struct DMA_Handle {
+	DMA_Reg_t*			pDMAx;			//DMA1 or DMA2
+	DMA_Stream_Reg_t*	pStream;		//Filled by DMA_Init()
+	DMA_Config_t		DMA_Config;
+	DMA_Callback_t		Callback;		//Called from DMA_IRQHandling(), NULL: DMA_ApplicationEventCallback
+	void*				pContext;		//Owner of the stream (e.g. a peripheral handle)
+};
+
+/********************************DMA FUNCTION API DECLARATION*************************/
+
+/*
+ * Peripheral clock control
+ */
+void DMA_PeriClkCtrl(DMA_Reg_t* pDMAx, uint8_t EnOrDi);
+
+/*
+ * DMA stream initialization and de-initialization
+ */
+void DMA_Init(DMA_Handle_t* pDMAHandler);
+void DMA_DeInit(DMA_Reg_t* pDMAx);
+
+/*
+ * Transfer control
+ * Note: DMA_Start() disables the stream first, len is a number of data items (max 65535)
+ */
+void DMA_Start(DMA_Handle_t* pDMAHandler, uint32_t periphAddr, uint32_t memAddr, uint16_t len);
+void DMA_Stop(DMA_Handle_t* pDMAHandler);
+uint16_t DMA_GetRemaining(DMA_Handle_t* pDMAHandler);
+
+/*
+ * DMA Interrupt Configuration and Handling
+ */
+void DMA_IRQITConfig(uint8_t IRQNumber, uint8_t EnOrDi);
+void DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriorityValue);
+void DMA_IRQHandling(DMA_Handle_t* pDMAHandler);
+
+/*
+ * Application callback
+ */
+void DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt);
+
+#endif /* INC_STM32F407XX_DMA_DRIVER_H_ */
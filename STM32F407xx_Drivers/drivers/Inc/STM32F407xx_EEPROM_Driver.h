@@ -0,0 +1,111 @@
+/*
+ * STM32F407xx_EEPROM_Driver.h
+ *
+ *  Created on: Oct 15, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the 24Cxx I2C EEPROM driver built on
+ *      			 the blocking I2C master API. Writes are split on page boundaries,
+ *      			 the end of the internal write cycle is found by ACK polling and an
+ *      			 optional one-page write-back cache merges small writes
+ */
+
+#ifndef INC_STM32F407XX_EEPROM_DRIVER_H_
+#define INC_STM32F407XX_EEPROM_DRIVER_H_
+#include "stm32f407xx.h"
+#include "STM32F407xx_I2C_Driver.h"
+
+/*****************SPECIFIC MACROS FOR EEPROM*********************/
+
+/*
+ * Bound of the ACK polling after a page write (tWR is 5 ms on most 24Cxx)
+ * Note: Can be overridden from the compiler command line (-DEEPROM_WRITE_TIMEOUT_US=...)
+ */
+#ifndef EEPROM_WRITE_TIMEOUT_US
+#define EEPROM_WRITE_TIMEOUT_US		10000U
+#endif
+
+/*
+ * Default base address of the 24Cxx family (A2..A0 tied low)
+ */
+#define EEPROM_24CXX_ADDR			0x50U
+
+/*
+ * @EEPROM_STATUS
+ * Note: The I2C_ERR_xxx of the bus are passed through unchanged
+ */
+#define EEPROM_OK					I2C_OK
+#define EEPROM_ERR_CONFIG			32U		//PageSize not a power of 2 or Size not a multiple of it
+#define EEPROM_ERR_RANGE			33U		//access outside of the memory array
+#define EEPROM_ERR_WRITE_TIMEOUT	34U		//still busy after EEPROM_WRITE_TIMEOUT_US
+
+/*
+ * Common parts (Size, PageSize, AddrSize)
+ * 		24C02	: 256,		8,		I2C_MEM_ADDR_SIZE_8BIT
+ * 		24C16	: 2048,		16,		I2C_MEM_ADDR_SIZE_8BIT	(A10..A8 in the device address)
+ * 		24C32	: 4096,		32,		I2C_MEM_ADDR_SIZE_16BIT
+ * 		24C256	: 32768,	64,		I2C_MEM_ADDR_SIZE_16BIT
+ * 		24C512	: 65536,	128,	I2C_MEM_ADDR_SIZE_16BIT
+ * 		24M02	: 262144,	256,	I2C_MEM_ADDR_SIZE_16BIT	(A17..A16 in the device address)
+ */
+
+/****************************************************************/
+
+/*
+ * EEPROM configuration structure
+ */
+typedef struct {
+	uint16_t	DeviceAddress;	//7-bit base address, see EEPROM_24CXX_ADDR
+	uint32_t	Size;			//memory array in bytes
+	uint16_t	PageSize;		//page write buffer in bytes (power of 2)
+	uint8_t		AddrSize;		//address bytes sent after the device address. See @I2C_MEM_ADDR_SIZE
+} EEPROM_Config_t;
+
+/*
+ * EEPROM bus statistics
+ */
+typedef struct {
+	uint32_t	WriteCycles;	//page writes (internal write cycles started)
+	uint32_t	BytesWritten;	//bytes sent by the page writes
+	uint32_t	Polls;			//NACKed address probes while a write cycle was running
+	uint32_t	CacheHits;		//EEPROM_Write merged into the dirty cache page
+} EEPROM_Stats_t;
+
+/*
+ * EEPROM Handle structure
+ * Note: pCache (PageSize bytes) is set by the application before EEPROM_Init(),
+ * 		 NULL: every EEPROM_Write goes to the device (write-through)
+ */
+typedef struct {
+	I2C_Handle_t*		pI2CHandler;	//initialized master on the EEPROM bus
+	EEPROM_Config_t		EEPROM_Config;
+	uint8_t*			pCache;			//write-back cache of one page
+	uint32_t			CachePage;		//address of the cached page
+	uint16_t			DirtyStart;		//dirty range of the cache [DirtyStart, DirtyEnd), empty: clean
+	uint16_t			DirtyEnd;
+	uint8_t				WriteBusy;		//SET: a write cycle may still be running, poll before the next access
+	EEPROM_Stats_t		Stats;
+} EEPROM_Handle_t;
+
+/********************************EEPROM FUNCTION API DECLARATION*************************/
+
+/*
+ * Initialization
+ */
+uint8_t EEPROM_Init(EEPROM_Handle_t* pEEPROMHandler);
+
+/*
+ * Data access (blocking, return EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx)
+ * Note: EEPROM_Read returns the cached data not yet written to the device.
+ * 		 With a cache, EEPROM_Write only reaches the device when another page is
+ * 		 written or on EEPROM_Flush(): call it before the power goes down
+ */
+uint8_t EEPROM_Read(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pRxBuffer, uint32_t len);
+uint8_t EEPROM_Write(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pTxBuffer, uint32_t len);
+uint8_t EEPROM_Flush(EEPROM_Handle_t* pEEPROMHandler);
+
+/*
+ * Wait for the end of the last write cycle (ACK polling)
+ */
+uint8_t EEPROM_WaitReady(EEPROM_Handle_t* pEEPROMHandler);
+
+#endif /* INC_STM32F407XX_EEPROM_DRIVER_H_ */
@@ -5,10 +5,13 @@
  *      Author: Donavan Tran
  */
 
+//Outside of the guard: included first, the main header pulls the drivers in its
+//own order and the ones built on I2C_Handle_t (EEPROM) see the complete types
+#include "stm32f407xx.h"
+
 #ifndef INC_STM32F407XX_I2C_DRIVER_H_
 #define INC_STM32F407XX_I2C_DRIVER_H_
-
-#include "stm32f407xx.h"
+#include "STM32F407xx_DMA_Driver.h"
 
 /*
  * @I2C_APPLICATION_STATES
@@ -22,6 +25,12 @@
  */
 #define I2C_SR_SET				SET
 #define I2C_SR_RESET			RESET
+/*
+ * @I2C_MEM_ADDR_SIZE (width of the register/memory address of the slave)
+ */
+#define I2C_MEM_ADDR_SIZE_8BIT	1U
+#define I2C_MEM_ADDR_SIZE_16BIT	2U
+
 /*
  * @I2C_MODE_SELECTION macros
  */
@@ -36,20 +45,84 @@
 #define I2C_ADDR_MODE_7_BIT		0U		//7-bit slave addressing mode
 #define I2C_ADDR_MODE_10_BIT	1U  	//10-bit slave addressing mode
 
+/*
+ * First byte of a 10-bit address: 11110 A9 A8 r/w
+ */
+#define I2C_10BIT_HEADER(__ADDR__)	(0xF0U | (((__ADDR__) >> 7) & 0x06U))
+
+/*
+ * @I2C_SLAVE_MATCH (own address matched by the last slave transfer)
+ */
+#define I2C_MATCH_OWN			0U		//OAR1 (7 or 10-bit DeviceAddress)
+#define I2C_MATCH_DUAL			1U		//OAR2 (DualAddress)
+#define I2C_MATCH_GENCALL		2U		//General call address 0x00
+
 /*
  * @I2C_SCL_SPEED
- * Note: STM32F407xx only supports either standard or fast mode
+ * Note: SCLSpeed is the SCL frequency in Hz, any value up to 400 kHz is accepted.
+ * 		 STM32F407xx only supports standard mode (up to 100 kHz) and fast mode
+ */
+#define I2C_SCL_SPEED_SM		100000U		//Standard Mode (100Kbps)
+#define I2C_SCL_SPEED_FM		400000U		//Fast Mode 	(400Kbps)
+
+/*
+ * I2C bus specification limits (UM10204) used by I2C_ComputeTiming
+ * Note: Maximum rise time of Sm is 1000ns, maximum rise time of Fm is 300ns
+ */
+#define I2C_T_RISE_SM_NS		1000U
+#define I2C_T_RISE_FM_NS		300U
+#define I2C_T_LOW_SM_NS			4700U		//minimum SCL low period
+#define I2C_T_HIGH_SM_NS		4000U		//minimum SCL high period
+#define I2C_T_LOW_FM_NS			1300U
+#define I2C_T_HIGH_FM_NS		600U
+
+/*
+ * Peripheral clock range of the I2C (RM0090 I2C_CR2 FREQ)
+ */
+#define I2C_PCLK1_MIN_MHZ		2U
+#define I2C_PCLK1_MIN_FM_MHZ	4U
+#define I2C_PCLK1_MAX_MHZ		42U
+
+/*
+ * @I2C_TIMING_STATUS
+ */
+#define I2C_TIMING_OK			0U
+#define I2C_TIMING_ERR_PCLK		1U		//PCLK1 outside 2-42 MHz (4 MHz minimum in fast mode)
+#define I2C_TIMING_ERR_SPEED	2U		//SCL of 0 or above 400 kHz
+#define I2C_TIMING_ERR_RANGE	3U		//SCL too slow, CCR does not fit in 12 bits
+
+/*
+ * @I2C_STATUS (return value of the blocking API)
+ * Note: On error the blocking API returns the matching I2C_ERR_xxx event code
  */
-#define I2C_SCL_SPEED_SM		0U		//Standard Mode (100Kbps)
-#define I2C_SCL_SPEED_FM		1U		//Fast Mode 	(400Kbps)
-#define I2C_SCL_SPEED(__SCL_SPEED__)    ((__SCL_SPEED__) ==  I2C_SCL_SPEED_FM) ? 400000U : 100000U
+#define I2C_OK					0U
 
 /*
- * Maximum Rise time in Sm/Fm mode (microsecond)
- * Note: Maximum rise time of Sm is 1000ns = 1 microseconds = 1/1000000 s
- * 	     Maximum rise time of Fm is 300ns = 0.3 microseconds = 1/300000 s
+ * Longest wait for one step of a blocking transfer (START, address, one byte)
+ * Note: One byte at 10 kHz takes 900 us. Can be overridden from the compiler
+ * 		 command line (-DI2C_STEP_TIMEOUT_US=...)
  */
-#define I2C_T_RISE(__SCL_SPEED__) 		((__SCL_SPEED__) == I2C_SCL_SPEED_FM) ? 3U : 10U
+#ifndef I2C_STEP_TIMEOUT_US
+#define I2C_STEP_TIMEOUT_US		2000U
+#endif
+
+/*
+ * SCL half period of the bus recovery clocks (5 us: 100 kHz)
+ */
+#define I2C_RECOVERY_HALF_PERIOD_US	5U
+#define I2C_RECOVERY_CLOCKS		9U
+
+/*
+ * @I2C_BUS_MODE
+ */
+#define I2C_BUS_I2C				0U
+#define I2C_BUS_SMBUS_DEVICE	1U
+#define I2C_BUS_SMBUS_HOST		2U
+
+/*
+ * SMBus Alert Response Address: the device pulling SMBALERT low answers with its address
+ */
+#define I2C_SMBUS_ARA			0x0CU
 
 /*
  * @I2C_ACK_CTRL macros
@@ -86,6 +159,9 @@
  */
 #define I2C_FLAG_SR2_SML		(1 << I2C_SR2_MSL)
 #define I2C_FLAG_SR2_TRA		(1 << I2C_SR2_TRA)
+#define I2C_FLAG_SR2_BUSY		(1 << I2C_SR2_BUSY)
+#define I2C_FLAG_SR2_GENCALL	(1 << I2C_SR2_GENCALL)
+#define I2C_FLAG_SR2_DUALF		(1 << I2C_SR2_DUALF)
 /*
  * @I2C Application Event Status
  */
@@ -101,30 +177,153 @@
 #define I2C_ERR_SMBALERT		9U
 #define I2C_EVT_DATA_REQ		10U
 #define I2C_EVT_DATA_RCV		11U
+#define I2C_ERR_DMA				12U		//DMA stream error, the transfer is aborted
+#define I2C_EVT_REGMAP_WRITE	13U		//Slave register map written, see I2C_RegMap_t ChangeStart/ChangeLen
+#define I2C_ERR_BUS_STUCK		14U		//SDA or BUSY still stuck after the bus recovery
+#define I2C_ERR_BLOCK_SIZE		15U		//SMBus block count larger than the buffer
+
+/*
+ * @I2C_DMA_XFER (direction of the DMA transfer in progress)
+ * Note: DMA request mapping (RM0090 tables 42/43):
+ * 		 I2C1 Tx DMA1 Stream6/7 channel 1, Rx DMA1 Stream0/5 channel 1
+ * 		 I2C2 Tx DMA1 Stream7 channel 7, Rx DMA1 Stream2/3 channel 7
+ * 		 I2C3 Tx DMA1 Stream4 channel 3, Rx DMA1 Stream2 channel 3
+ */
+#define I2C_DMA_NONE			0U
+#define I2C_DMA_TX				1U
+#define I2C_DMA_RX				2U
+
+/*
+ * @I2C_XFER_TYPE (transaction queue)
+ */
+#define I2C_XFER_WRITE			0U		//I2C_MasterSendDataIT
+#define I2C_XFER_READ			1U		//I2C_MasterReceiveDataIT
+#define I2C_XFER_MEM_WRITE		2U		//I2C_MemWriteIT
+#define I2C_XFER_MEM_READ		3U		//I2C_MemReadIT
+
+/*
+ * @I2C_XFER_STATUS (transaction queue)
+ */
+#define I2C_XFER_IDLE			0U
+#define I2C_XFER_PENDING		1U		//Waiting in the queue
+#define I2C_XFER_ACTIVE			2U		//On the bus
+#define I2C_XFER_DONE			3U		//Completed successfully
+#define I2C_XFER_ERROR			4U		//Aborted, the callback received the I2C_ERR_xxx event
 
 /*******************************I2C FUNCTION MACROS**************************************/
 /*
  * I2C Peripheral Clock Enable
  */
-#define I2Cx_PCLK_EN(__I2Cx__) 	((__I2Cx__) == I2C1) ? I2C1_PCLK_EN() :\
-								((__I2Cx__) == I2C2) ? I2C2_PCLK_EN() : I2C3_PCLK_EN()
+#define I2Cx_PCLK_EN(__I2Cx__) 	RCC_PeriphClockControl((__I2Cx__), ENABLE)
 /*
  * I2C Peripheral Clock Disable
  */
-#define I2Cx_PCLK_DI(__I2Cx__) 	((__I2Cx__) == I2C1) ? I2C1_PCLK_DI() :\
-								((__I2Cx__) == I2C2) ? I2C2_PCLK_DI() : I2C3_PCLK_DI()
+#define I2Cx_PCLK_DI(__I2Cx__) 	RCC_PeriphClockControl((__I2Cx__), DISABLE)
 
 /****************************************************************************************/
 /*
  * I2C configuration structure
  */
 typedef struct {
-	uint8_t SCLSpeed;		//See @I2C_SCLSPEED macros for more details
-	uint8_t DeviceAddress;	//For slave device
+	uint32_t SCLSpeed;		//SCL frequency in Hz. See @I2C_SCL_SPEED macros for more details
+	uint16_t DeviceAddress;	//For slave device (7 or 10 bits)
+	uint8_t AddressingMode;	//Own address and addresses of the master API. See @I2C_ADDRESSING_MODE
+	uint8_t DualAddress;	//Second 7-bit own address (OAR2), 0: single address
+	uint8_t GeneralCall;	//ENABLE: acknowledge the general call address 0x00
 	uint8_t ACKControl;		//By default, ACK is not enabled. See @I2C_ACK_CTRL macros for more details
 	uint8_t FMDutyCycle; 	//Fast mode duty cycles. See @I2C_DUTY_CYCLE macros for more details
+	uint8_t BusMode;		//I2C or SMBus. See @I2C_BUS_MODE macros for more details
+	uint8_t PECControl;		//ENABLE: PEC computed and checked by the hardware (SMBus API)
 } I2C_Config_t;
 
+/*
+ * I2C bus timing computed by I2C_ComputeTiming
+ */
+typedef struct {
+	uint8_t		Freq;			//I2C_CR2 FREQ field (PCLK1 in MHz)
+	uint16_t	CCR;			//I2C_CCR register value (F/S, DUTY and CCR fields)
+	uint8_t		TRise;			//I2C_TRISE register value
+	uint32_t	SCLActual;		//achieved SCL frequency in Hz (bus rise/fall times not included)
+	uint32_t	TLowNs;			//achieved SCL low period
+	uint32_t	THighNs;		//achieved SCL high period
+} I2C_Timing_t;
+
+/*
+ * I2C transaction descriptor (transaction queue)
+ * Note: The descriptor must stay valid until its callback is called
+ */
+typedef struct I2C_Transaction I2C_Transaction_t;
+typedef void (*I2C_XferCallback_t)(I2C_Transaction_t* pXfer, uint8_t appEvt);
+
+struct I2C_Transaction {
+	uint8_t				Type;			//See @I2C_XFER_TYPE macros for more details
+	uint16_t			SlaveAddress;	//7 or 10-bit slave address, see I2C_Config_t AddressingMode
+	uint16_t			MemAddress;		//Register address (I2C_XFER_MEM_xxx only)
+	uint8_t				MemAddrSize;	//See @I2C_MEM_ADDR_SIZE (I2C_XFER_MEM_xxx only)
+	uint8_t*			pBuffer;		//Tx or Rx buffer
+	uint32_t			Len;			//length of the buffer
+	I2C_XferCallback_t	Callback;		//Called from the ISR when done, NULL: I2C_ApplicationEventCallBack
+	void*				pContext;		//User data for the callback
+	__vo uint8_t		Status;			//See @I2C_XFER_STATUS macros for more details
+	uint8_t				Attempts;		//restarts after a lost arbitration (cleared by I2C_QueueSubmit)
+};
+
+/*
+ * I2C transaction queue
+ * Note: Ring of descriptor pointers, the slot array is provided by the application
+ */
+typedef struct {
+	I2C_Transaction_t**	pSlots;			//descriptor array (power of 2 entries)
+	uint8_t				Size;			//number of slots
+	__vo uint8_t		Head;			//next slot to fill
+	__vo uint8_t		Tail;			//next slot to start
+	I2C_Transaction_t*	pActive;		//transaction currently on the bus
+} I2C_Queue_t;
+
+/*
+ * I2C retry policy of the transaction queue (multi-master bus)
+ * Note: A queued transaction that loses the arbitration goes back to the head
+ * 		 of the queue. It restarts once the bus has been free for a random delay
+ * 		 drawn in [0, window], the window doubles with each retry up to BackoffMaxUs
+ */
+typedef struct {
+	uint8_t				MaxRetries;		//restarts per transaction, 0: I2C_ERR_ARLO is reported at once
+	uint16_t			BackoffUs;		//backoff window of the first retry
+	uint16_t			BackoffMaxUs;	//largest backoff window
+} I2C_RetryPolicy_t;
+
+/*
+ * I2C slave register map
+ * Note: The master writes [pointer][data...] and reads from the pointer on,
+ * 		 the pointer auto-increments and wraps around at Size. A register
+ * 		 only takes the bits set in its write mask (0x00: read-only)
+ */
+typedef struct {
+	uint8_t*			pRegs;			//register file
+	const uint8_t*		pWriteMask;		//per-register writable bits, NULL: all writable
+	uint16_t			Size;			//number of registers (up to 256)
+	__vo uint16_t		Pointer;		//register pointer
+	__vo uint16_t		ChangeStart;	//first register changed by the last write transaction
+	__vo uint16_t		ChangeLen;		//number of registers changed by the last write transaction
+	uint8_t				AddrPhase;		//SET: the next received byte is the register pointer
+} I2C_RegMap_t;
+
+/*
+ * I2C error statistics (one block per bus)
+ */
+typedef struct {
+	uint32_t			BERR;			//misplaced START/STOP
+	uint32_t			AF;				//NACK received in master mode
+	uint32_t			ARLO;			//arbitration lost
+	uint32_t			OVR;			//overrun/underrun
+	uint32_t			PECERR;			//PEC mismatch in reception
+	uint32_t			Timeout;		//step of a transfer not completed in time
+	uint32_t			Recovery;		//runs of I2C_BusRecovery
+	uint32_t			Reset;			//runs of I2C_SoftwareReset
+	uint32_t			Retry;			//queued transactions restarted after a lost arbitration
+	uint32_t			RetryExhausted;	//queued transactions dropped with I2C_ERR_ARLO after MaxRetries
+} I2C_ErrorStats_t;
+
 /*s
  * Handle structure of I2C peripherals
  */
@@ -138,7 +337,27 @@ typedef struct {
 	uint32_t 		RxSize;			//Size of the Rx buffer
 	uint8_t 		TxRxState;		//since I2C is half-duplex in STM32, we only need 1 state
 	uint8_t 		RepeatedStart;	//repeated Start condition
-	uint8_t 		DeviceAddr;		//storing the device address
+	uint16_t 		DeviceAddr;		//storing the device address
+	uint8_t			Addr10Read;		//SET: the 10-bit slave is addressed, the read header follows a repeated start
+	uint8_t			SlaveMatch;		//See @I2C_SLAVE_MATCH macros for more details
+	uint8_t			MemAddr[2];		//register address of I2C_MemWriteIT/I2C_MemReadIT, sent from MemAddr[MemAddrLen - 1] down
+	uint8_t			MemAddrLen;		//number of register address bytes left to send
+	uint8_t			MemRxPending;	//SET when a repeated start and a read follow the register address
+	I2C_Queue_t		Queue;			//transaction queue, see I2C_QueueInit()
+	I2C_RetryPolicy_t Retry;		//retry policy of the queue after a lost arbitration
+	uint8_t			RetryPending;	//SET: the head of the queue waits for its backoff, see I2C_QueueService()
+	uint32_t		RetryAt;		//DWT cycle count the backoff runs from
+	uint32_t		RetryDelay;		//backoff in DWT cycles
+	DMA_Handle_t*	pDMATx;			//Tx stream, see I2C_AttachDMA() (NULL: interrupt only)
+	DMA_Handle_t*	pDMARx;			//Rx stream, see I2C_AttachDMA() (NULL: interrupt only)
+	uint8_t			XferDMA;		//See @I2C_DMA_XFER macros for more details
+	I2C_RegMap_t*	pRegMap;		//slave register map, see I2C_SlaveRegMapInit() (NULL: per-byte callbacks)
+	uint32_t		XferStart;		//DWT cycle count at the start of the interrupt transfer, see I2C_CheckTimeout()
+	I2C_ErrorStats_t Stats;			//error counters of the bus
+	GPIO_Reg_t*		pSCLPort;		//SCL GPIO port for the bus recovery, NULL if not used
+	GPIO_Reg_t*		pSDAPort;		//SDA GPIO port for the bus recovery, NULL if not used
+	uint8_t			SCLPin;			//SCL pin number
+	uint8_t			SDAPin;			//SDA pin number
 } I2C_Handle_t;
 
 
@@ -152,7 +371,15 @@ void I2C_PeriClkCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi);
  * I2C initialization and de-initialization
  * Parameter: Pointer to the I2C Handle Structure
  */
-void I2C_Init(I2C_Handle_t* pI2CHandler);
+uint8_t I2C_Init(I2C_Handle_t* pI2CHandler);
+
+/*
+ * I2C bus timing
+ * Note: I2C_ComputeTiming validates a configuration without touching the peripheral,
+ * 		 I2C_GetSCLSpeed returns the SCL frequency programmed in the peripheral
+ */
+uint8_t I2C_ComputeTiming(uint32_t pclk1, uint32_t sclSpeed, uint8_t dutyCycle, I2C_Timing_t* pTiming);
+uint32_t I2C_GetSCLSpeed(I2C_Reg_t* pI2Cx);
 
 /* Consult the RCC Peripheral reset registers for more details*/
 void I2C_DeInit(I2C_Reg_t* pI2Cx);
@@ -166,11 +393,29 @@ void I2C_PeripheralEnable(I2C_Reg_t* pI2Cx, uint8_t EnOrDi);
  * I2C Master Tx and Rx
  * Note: len should always be in uint32_t
  * 		 The interrupt API returns the application states
+ * 		 The blocking API returns @I2C_STATUS or I2C_ERR_xxx: every step is
+ * 		 bounded by I2C_STEP_TIMEOUT_US and the bus is released on error
+ */
+uint8_t I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
+						uint16_t pSlaveAddress, uint8_t repeatedStart);
+uint8_t I2C_MasterReceiveData(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
+		 	 	 	 	   uint16_t pSlaveAddress, uint8_t repeatedStart);
+
+/*
+ * I2C Master register access (write/read a register of the slave in one transaction)
+ * Note: MemRead runs START/addr+W/reg/RESTART/addr+R/data/STOP as a single call
+ */
+uint8_t I2C_MemWrite(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+				  uint8_t memAddrSize, uint8_t* pTxBuffer, uint32_t len);
+uint8_t I2C_MemRead(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+				 uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len);
+
+/*
+ * Address probe (START, address+W, STOP)
+ * Note: Returns I2C_OK on ACK, I2C_ERR_AF on NACK without counting it as a bus
+ * 		 error (ACK polling of a device busy with an internal write cycle)
  */
-void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
-						uint8_t pSlaveAddress, uint8_t repeatedStart);
-void I2C_MasterReceiveData(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
-		 	 	 	 	   uint8_t pSlaveAddress, uint8_t repeatedStart);
+uint8_t I2C_IsDeviceReady(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress);
 
 void I2C_SlaveSendData(I2C_Reg_t* pI2Cx, uint8_t data);
 uint8_t I2C_SlaveReceiveData(I2C_Reg_t* pI2Cx);
@@ -179,9 +424,95 @@ uint8_t I2C_SlaveReceiveData(I2C_Reg_t* pI2Cx);
  * I2C Master Tx and RX interrupt API
  */
 uint8_t I2C_MasterSendDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
-						uint8_t pSlaveAddress, uint8_t repeatedStart);
+						uint16_t pSlaveAddress, uint8_t repeatedStart);
 uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
-		 	 	 	 	     uint8_t pSlaveAddress, uint8_t repeatedStart);
+		 	 	 	 	     uint16_t pSlaveAddress, uint8_t repeatedStart);
+
+/*
+ * I2C Master register access interrupt API
+ * Note: Completion is reported with I2C_EVT_TX_CMPLT (write) or I2C_EVT_RX_CMPLT (read)
+ */
+uint8_t I2C_MemWriteIT(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					   uint8_t memAddrSize, uint8_t* pTxBuffer, uint32_t len);
+uint8_t I2C_MemReadIT(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					  uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len);
+/*
+ * I2C Master DMA Tx and Rx
+ * Note: The streams only move the data bytes: START/address stay on the event
+ * 		 interrupt, and the end of a transfer costs one BTF (Tx) or one DMA
+ * 		 transfer complete (Rx) interrupt. Receptions of less than 2 bytes and
+ * 		 handles without a stream fall back to the interrupt API.
+ * 		 For a register write, put the register address in front of the data.
+ */
+void I2C_AttachDMA(I2C_Handle_t* pI2CHandler, DMA_Handle_t* pDMATx, DMA_Handle_t* pDMARx);
+uint8_t I2C_MasterSendDataDMA(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
+							  uint16_t pSlaveAddress, uint8_t repeatedStart);
+uint8_t I2C_MasterReceiveDataDMA(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
+								 uint16_t pSlaveAddress, uint8_t repeatedStart);
+uint8_t I2C_MemReadDMA(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					   uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len);
+
+/*
+ * I2C transaction queue
+ * Note: The next transaction is started from the interrupt that completes the
+ * 		 previous one. When the STOP of the previous one is still on the bus it
+ * 		 is held back until the next I2C_QueueSubmit or I2C_QueueService
+ */
+void I2C_QueueInit(I2C_Handle_t* pI2CHandler, I2C_Transaction_t** pSlots, uint8_t size);
+uint8_t I2C_QueueSubmit(I2C_Handle_t* pI2CHandler, I2C_Transaction_t* pXfer);
+uint8_t I2C_QueueCount(I2C_Handle_t* pI2CHandler);
+
+/*
+ * Restart a queued transaction once its backoff is over (see I2C_RetryPolicy_t),
+ * or once the STOP of the previous transaction is out
+ * Note: Call it periodically (main loop, SysTick) while the queue is in use
+ */
+void I2C_QueueService(I2C_Handle_t* pI2CHandler);
+
+/*
+ * I2C slave register map emulation
+ * Note: Every byte is handled inside I2C_EV_IRQHandling, the application only
+ * 		 receives I2C_EVT_REGMAP_WRITE once per write transaction (after STOP)
+ */
+void I2C_SlaveRegMapInit(I2C_Handle_t* pI2CHandler, I2C_RegMap_t* pRegMap, uint8_t* pRegs,
+						 const uint8_t* pWriteMask, uint16_t size);
+
+/*
+ * SMBus master protocols (blocking, return I2C_OK or I2C_ERR_xxx)
+ * Note: With PECControl enabled, the PEC byte is appended and checked by the
+ * 		 hardware (I2C_ERR_PECERR on mismatch), the quick command has no PEC.
+ * 		 Words are sent low byte first. I2C_SMBusAlertResponse returns the
+ * 		 7-bit address of the device signaling SMBALERT
+ */
+uint8_t I2C_SMBusQuickCommand(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress);
+uint8_t I2C_SMBusSendByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t data);
+uint8_t I2C_SMBusReceiveByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pData);
+uint8_t I2C_SMBusWriteByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint8_t data);
+uint8_t I2C_SMBusReadByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint8_t* pData);
+uint8_t I2C_SMBusWriteWord(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint16_t data);
+uint8_t I2C_SMBusReadWord(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint16_t* pData);
+uint8_t I2C_SMBusBlockWrite(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command,
+							uint8_t* pTxBuffer, uint8_t count);
+uint8_t I2C_SMBusBlockRead(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command,
+						   uint8_t* pRxBuffer, uint8_t maxCount, uint8_t* pCount);
+uint8_t I2C_SMBusAlertResponse(I2C_Handle_t* pI2CHandler, uint8_t* pSlaveAddress);
+
+/*
+ * SMBus device: drive the SMBALERT pin low (ENABLE) or release it (DISABLE)
+ */
+void I2C_SMBusAlertCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi);
+
+/*
+ * I2C bus recovery
+ * Note: I2C_BusRecovery clocks SCL as a GPIO until the slave holding SDA low
+ * 		 lets go, generates a STOP then resets the peripheral (pSCLPort/pSDAPort
+ * 		 NULL: reset only). I2C_CheckTimeout aborts an interrupt transfer running
+ * 		 for longer than timeoutUs, call it periodically from the application
+ */
+uint8_t I2C_BusRecovery(I2C_Handle_t* pI2CHandler);
+void I2C_SoftwareReset(I2C_Handle_t* pI2CHandler);
+uint8_t I2C_CheckTimeout(I2C_Handle_t* pI2CHandler, uint32_t timeoutUs);
+
 /*
  * I2C Slave Tx and Rx
  */
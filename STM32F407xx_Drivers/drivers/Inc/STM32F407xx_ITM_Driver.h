@@ -0,0 +1,90 @@
+/*
+ * STM32F407xx_ITM_Driver.h
+ *
+ *  Created on: Oct 8, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the ITM/SWO trace driver.
+ *      			 The trace goes through the debug probe (SWO pin PB3),
+ *      			 so no UART is used and the CPU never waits on a serial frame
+ */
+
+#ifndef INC_STM32F407XX_ITM_DRIVER_H_
+#define INC_STM32F407XX_ITM_DRIVER_H_
+#include "stm32f407xx.h"
+
+/***************************ITM_CONFIG_MACROS******************/
+
+/*
+ * @ITM_SWO_PROTOCOL macros
+ */
+#define ITM_SWO_MANCHESTER			1U
+#define ITM_SWO_NRZ					2U		//UART like encoding, supported by ST-LINK
+
+/*
+ * @ITM_SWO_BAUD_RATE macros
+ * Note: The ST-LINK/V2 decodes up to 2MHz NRZ
+ */
+#define ITM_SWO_BAUD_500K			500000U
+#define ITM_SWO_BAUD_1M				1000000U
+#define ITM_SWO_BAUD_2M				2000000U
+
+/*
+ * @ITM_PORT macros
+ * Note: Channel assignment of the 32 stimulus ports
+ */
+#define ITM_PORT_PRINTF				0U		//Text (IDE SWV console)
+#define ITM_PORT_LOG				1U		//Tokenized log stream (STM32F407xx_Log)
+#define ITM_PORT_EVENT				2U		//Event markers
+#define ITM_PORT_DATA				3U		//First data stream port (3 - 31)
+#define ITM_NO_OF_PORTS				32U
+
+#define ITM_PORT_ALL				0xFFFFFFFFU
+
+/*******************************************************************/
+/*
+ * Configuration structure of ITM
+ */
+typedef struct {
+	uint32_t SWOBaudRate;		//See @ITM_SWO_BAUD_RATE macros for details
+	uint8_t  Protocol;			//See @ITM_SWO_PROTOCOL macros for details
+	uint32_t PortEnable;		//Bit n enables stimulus port n, see @ITM_PORT macros
+	uint8_t  Timestamp;			//ENABLE or DISABLE local timestamp packets
+} ITM_Config_t;
+
+/*******************************ITM_API************************/
+
+/*
+ * ITM/TPIU initialization
+ * Note: The SWO prescaler is computed from the current HCLK, so call
+ * 		 it again after the clock tree is changed
+ */
+void ITM_Init(ITM_Config_t* pITMConfig);
+uint32_t ITM_GetSWOBaudRate(void);
+
+/*
+ * Port status
+ * Note: A port is disabled when no debugger enabled the trace (TRCENA)
+ */
+uint8_t ITM_IsPortEnabled(uint8_t port);
+
+/*
+ * Blocking stimulus writes (8, 16 and 32-bit packets)
+ * Note: The data is silently discarded when the port is disabled
+ */
+void ITM_Send8(uint8_t port, uint8_t data);
+void ITM_Send16(uint8_t port, uint16_t data);
+void ITM_Send32(uint8_t port, uint32_t data);
+void ITM_Write(uint8_t port, const uint8_t* pData, uint32_t len);
+
+/*
+ * Non-blocking stimulus write
+ * Note: Returns RESET when the stimulus FIFO is full
+ */
+uint8_t ITM_TrySend32(uint8_t port, uint32_t data);
+
+/*
+ * Sink of the tokenized logger (see LOG_Init)
+ */
+uint8_t ITM_LogSink(uint32_t word);
+
+#endif /* INC_STM32F407XX_ITM_DRIVER_H_ */
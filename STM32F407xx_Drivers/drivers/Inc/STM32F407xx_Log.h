@@ -0,0 +1,95 @@
+/*
+ * STM32F407xx_Log.h
+ *
+ *  Created on: Oct 6, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the tokenized (deferred binary) logger.
+ *      			 Log calls only store the format string ID, the raw arguments and
+ *      			 a cycle timestamp into a RAM ring. The formatting is done on the
+ *      			 host by tools/log_decode.py using the .logstr section of the ELF
+ */
+
+#ifndef INC_STM32F407XX_LOG_H_
+#define INC_STM32F407XX_LOG_H_
+#include "stm32f407xx.h"
+
+/*
+ * Size of the log ring in 32-bit words (power of 2)
+ * Note: Can be overridden from the compiler command line (-DLOG_BUFFER_WORDS=...)
+ */
+#ifndef LOG_BUFFER_WORDS
+#define LOG_BUFFER_WORDS		256U
+#endif
+
+/*
+ * Record layout on the wire (little-endian 32-bit words)
+ * 		word 0			: [31:28] LOG_RECORD_SYNC, [27:24] number of arguments, [23:0] format string ID
+ * 		word 1			: DWT cycle counter at the time of the call
+ * 		word 2 - 5		: raw arguments
+ */
+#define LOG_RECORD_SYNC			0xAU
+#define LOG_MAX_ARGS			4U
+#define LOG_ID_MASK				0x00FFFFFFU
+#define LOG_ID_DROPPED			LOG_ID_MASK		//Reserved ID: 1 argument = number of records lost
+
+/*
+ * Sink called by LOG_Drain() for each word of the stream
+ * Note: Must return SET when the word is accepted, RESET when the sink is busy
+ */
+typedef uint8_t (*LOG_Sink_t)(uint32_t word);
+
+/*
+ * Format string placed in the .logstr section
+ * Note: .logstr is an INFO section: it is not loaded on the target, so the strings
+ * 		 do not use any Flash and their address in the section is used as the ID
+ */
+#define LOG_STR(__FMT__)		({ static const char __logFmt[] __attribute__((section(".logstr"), used)) = __FMT__; (uint32_t) __logFmt; })
+
+/*
+ * Argument helpers (count and pad the arguments to LOG_MAX_ARGS)
+ * Note: LOG_CHECK_ looks at the slot after the last allowed argument: it holds the
+ * 		 LOG_NO_ARG_ padding unless more than LOG_MAX_ARGS arguments are given, then
+ * 		 the call does not compile instead of sending a corrupted record
+ */
+#define LOG_NO_ARG_				((struct LOG_NoArg*) 0)
+#define LOG_CHECK_(_0, _1, _2, _3, _4, _5, ...)			_Static_assert(__builtin_types_compatible_p(__typeof__(_5), struct LOG_NoArg*), \
+																	   "LOG() takes at most LOG_MAX_ARGS arguments")
+#define LOG_NARGS_(_0, _1, _2, _3, _4, __N__, ...)		__N__
+#define LOG_NARGS(...)			LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_ARGS_(_0, _1, _2, _3, _4, ...)				(uint32_t) (_1), (uint32_t) (_2), (uint32_t) (_3), (uint32_t) (_4)
+
+/*
+ * Log a message with up to LOG_MAX_ARGS integer/pointer arguments
+ * e.g.	LOG("ADC ch%u = %d", channel, value);
+ * Note: %d %i %u %x %X %o %c %p are supported. Strings and floating point
+ * 		 values cannot be decoded (the host only sees the raw 32-bit values)
+ */
+#define LOG(__FMT__, ...)		({ LOG_CHECK_(0, ##__VA_ARGS__, LOG_NO_ARG_, LOG_NO_ARG_, LOG_NO_ARG_, LOG_NO_ARG_, LOG_NO_ARG_); \
+								   LOG_Record(LOG_STR(__FMT__), LOG_NARGS(__VA_ARGS__), LOG_ARGS_(0, ##__VA_ARGS__, 0, 0, 0, 0)); })
+
+/***********************************LOG API PROTOTYPES**************************************/
+/*
+ * Initialization
+ * Note: Also starts the DWT cycle counter used for the timestamps
+ */
+void LOG_Init(LOG_Sink_t sink);
+void LOG_AttachUSART(USART_Handle_t* pUSARTHandler);
+
+/*
+ * Store one record (called by the LOG() macro)
+ * Note: Safe to call from the main loop and any ISR
+ */
+void LOG_Record(uint32_t id, uint32_t nargs, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+/*
+ * Send the pending records to the sink
+ * Note: Call it from the idle loop or a low priority interrupt, never from two contexts
+ */
+void LOG_Drain(void);
+
+/*
+ * Statistics
+ */
+uint32_t LOG_GetDropCount(void);
+
+#endif /* INC_STM32F407XX_LOG_H_ */
@@ -0,0 +1,144 @@
+/*
+ * STM32F407xx_OneWire_Driver.h
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the 1-Wire bus master driven on an
+ *      			 open-drain GPIO pin. The slots are timed on the DWT cycle counter,
+ *      			 the interrupts are only masked inside the short timing-critical
+ *      			 part of a slot. ROM search, CRC-8 and the DS18B20 temperature
+ *      			 sensor commands are included
+ */
+
+#ifndef INC_STM32F407XX_ONEWIRE_DRIVER_H_
+#define INC_STM32F407XX_ONEWIRE_DRIVER_H_
+#include "stm32f407xx.h"
+#include "gpio_driver.h"
+
+/*****************SPECIFIC MACROS FOR 1-WIRE*********************/
+
+/*
+ * Standard speed slot timing in us (Maxim application note 126, letters A to J)
+ */
+#define OW_T_WRITE1_LOW				6U		//A: low part of a write 1 slot
+#define OW_T_WRITE1_REST			64U		//B: rest of a write 1 slot
+#define OW_T_WRITE0_LOW				60U		//C: low part of a write 0 slot
+#define OW_T_WRITE0_REST			10U		//D: rest of a write 0 slot
+#define OW_T_READ_LOW				6U		//A: low part of a read slot
+#define OW_T_READ_SAMPLE			9U		//E: release to sample of a read slot
+#define OW_T_READ_REST				55U		//F: rest of a read slot
+#define OW_T_RESET_LOW				480U	//H: reset pulse
+#define OW_T_PRESENCE_START			15U		//release of the reset to the first presence read
+#define OW_T_PRESENCE_WAIT			300U	//release of the reset to the last presence read
+#define OW_T_RESET_REST				480U	//release of the reset to the first slot
+
+/*
+ * ROM commands
+ */
+#define OW_CMD_SEARCH_ROM			0xF0U
+#define OW_CMD_READ_ROM				0x33U
+#define OW_CMD_MATCH_ROM			0x55U
+#define OW_CMD_SKIP_ROM				0xCCU
+#define OW_CMD_ALARM_SEARCH			0xECU
+
+/*
+ * DS18B20 function commands
+ */
+#define DS18B20_FAMILY_CODE			0x28U
+#define DS18B20_CMD_CONVERT_T		0x44U
+#define DS18B20_CMD_WRITE_SCRATCH	0x4EU
+#define DS18B20_CMD_READ_SCRATCH	0xBEU
+#define DS18B20_SCRATCHPAD_SIZE		9U		//byte 8 is the CRC-8 of bytes 0 - 7
+
+/*
+ * Size of a ROM code: family code, 48-bit serial number, CRC-8
+ */
+#define OW_ROM_SIZE					8U
+
+/*
+ * @OW_STATUS
+ */
+#define OW_OK						0U
+#define OW_ERR_NO_PRESENCE			1U		//no device answered the reset pulse
+#define OW_ERR_CRC					2U		//CRC-8 of the ROM code or of the data is wrong
+#define OW_ERR_SEARCH_END			3U		//all the devices were found by OW_Search
+#define OW_ERR_BUS					4U		//bus held low, or no device took part in a search bit
+
+/****************************************************************/
+
+/*
+ * 1-Wire bus statistics
+ */
+typedef struct {
+	uint32_t	Resets;			//reset pulses sent
+	uint32_t	NoPresence;		//reset pulses without presence pulse
+	uint32_t	CRCErrors;		//ROM codes and data blocks with a wrong CRC-8
+} OW_Stats_t;
+
+/*
+ * 1-Wire Handle structure
+ * Note: OW_GPIO (port, pin, pull-up) is set by the application before OW_Init(), the
+ * 		 mode is forced to open-drain output. Use an external 4.7 kOhm pull-up, the
+ * 		 internal one is too weak for more than a short bus
+ */
+typedef struct {
+	GPIO_Handle_t	OW_GPIO;
+	uint32_t		UsCycles;			//DWT cycles per us
+	uint8_t			Rom[OW_ROM_SIZE];	//ROM code of the last device found by OW_Search
+	uint8_t			LastDiscrepancy;	//search state: last bit where 0 was taken on a conflict
+	uint8_t			LastDevice;			//search state: SET when the last device was found
+	OW_Stats_t		Stats;
+} OW_Handle_t;
+
+/********************************1-WIRE FUNCTION API DECLARATION*************************/
+
+/*
+ * Initialization
+ */
+void OW_Init(OW_Handle_t* pOWHandler);
+
+/*
+ * Reset pulse, returns OW_OK when a presence pulse is seen. See @OW_STATUS
+ */
+uint8_t OW_Reset(OW_Handle_t* pOWHandler);
+
+/*
+ * Bit and byte slots (blocking, about 70 us per bit)
+ */
+void OW_WriteBit(OW_Handle_t* pOWHandler, uint8_t bit);
+uint8_t OW_ReadBit(OW_Handle_t* pOWHandler);
+void OW_WriteByte(OW_Handle_t* pOWHandler, uint8_t data);
+uint8_t OW_ReadByte(OW_Handle_t* pOWHandler);
+void OW_Write(OW_Handle_t* pOWHandler, const uint8_t* pTxBuffer, uint32_t len);
+void OW_Read(OW_Handle_t* pOWHandler, uint8_t* pRxBuffer, uint32_t len);
+
+/*
+ * Reset then address one device (MATCH ROM), or all of them with pRom = NULL (SKIP ROM)
+ */
+uint8_t OW_Select(OW_Handle_t* pOWHandler, const uint8_t* pRom);
+
+/*
+ * ROM search
+ * Note: OW_SearchReset() then OW_Search() until OW_ERR_SEARCH_END, one ROM code per call.
+ * 		 OW_SearchAll() does the loop and returns the number of ROM codes stored
+ */
+void OW_SearchReset(OW_Handle_t* pOWHandler);
+uint8_t OW_Search(OW_Handle_t* pOWHandler, uint8_t* pRom);
+uint8_t OW_SearchAll(OW_Handle_t* pOWHandler, uint8_t (*pRoms)[OW_ROM_SIZE], uint8_t maxDevices);
+
+/*
+ * Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1), 0 over a block followed by its CRC
+ */
+uint8_t OW_CRC8(const uint8_t* pData, uint32_t len);
+
+/*
+ * DS18B20 temperature sensors
+ * Note: DS18B20_StartConversion(NULL) starts every sensor of the bus at once (SKIP ROM),
+ * 		 the conversion takes up to 750 ms (12-bit): poll DS18B20_IsConversionDone() and
+ * 		 read each sensor by its ROM code. The temperature is in 1/16 degree Celsius
+ */
+uint8_t DS18B20_StartConversion(OW_Handle_t* pOWHandler, const uint8_t* pRom);
+uint8_t DS18B20_IsConversionDone(OW_Handle_t* pOWHandler);
+uint8_t DS18B20_ReadTemperature(OW_Handle_t* pOWHandler, const uint8_t* pRom, int16_t* pTemperature);
+
+#endif /* INC_STM32F407XX_ONEWIRE_DRIVER_H_ */
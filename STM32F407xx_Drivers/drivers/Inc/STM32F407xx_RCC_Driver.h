@@ -0,0 +1,103 @@
+/*
+ * STM32F407xx_RCC_Driver.h
+ *
+ *  Created on: Oct 2, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the clock tree helpers of the RCC
+ *      			 shared by the peripheral drivers (baud rate, SCL and SWO computation)
+ */
+
+#ifndef INC_STM32F407XX_RCC_DRIVER_H_
+#define INC_STM32F407XX_RCC_DRIVER_H_
+#include "stm32f407xx.h"
+
+/*
+ * @RCC_PLL_SOURCE
+ */
+#define RCC_PLL_SRC_HSI				0U
+#define RCC_PLL_SRC_HSE				1U
+
+/*
+ * @RCC_BUS
+ * Note: Word index of the xxxRSTR register in RCC_Reg_t, the matching xxxENR
+ * 		 register is always RCC_ENR_OFFSET words further
+ */
+#define RCC_BUS_AHB1				4U		//AHB1RSTR (0x10), AHB1ENR (0x30)
+#define RCC_BUS_APB1				8U		//APB1RSTR (0x20), APB1ENR (0x40)
+#define RCC_BUS_APB2				9U		//APB2RSTR (0x24), APB2ENR (0x44)
+#define RCC_ENR_OFFSET				8U
+
+/*
+ * No IRQ for this peripheral (or one per channel, like the DMA streams)
+ */
+#define RCC_IRQ_NONE				0xFFU
+
+/*
+ * Index of a peripheral in RCC_PeriphTable
+ * Note: APB1, APB2 and AHB1 are 64 KB apart from 0x40000000 and every peripheral
+ * 		 takes a 1 KB slot, so bits [17:16] give the bus and bits [14:10] the slot.
+ * 		 Bits [17:16] = 3 only keeps the index inside the table, those slots are empty
+ */
+#define RCC_PERIPH_INDEX(__ADDR__)	((((((uint32_t) (uintptr_t) (__ADDR__)) >> 16) & 0x3U) << 5) | \
+									((((uint32_t) (uintptr_t) (__ADDR__)) >> 10) & 0x1FU))
+#define RCC_PERIPH_TABLE_SIZE		(4U * 32U)
+
+/****************************************************************/
+
+/*
+ * Peripheral descriptor: everything the drivers need to clock, reset and
+ * route the interrupts of one peripheral instance
+ */
+typedef struct {
+	uint32_t	BaseAddr;		//0: empty slot
+	uint8_t		Bus;			//See @RCC_BUS
+	uint8_t		Bit;			//Bit of the peripheral in the xxxENR and xxxRSTR registers
+	uint8_t		IRQNumber;		//Main IRQ (event IRQ of the I2C), RCC_IRQ_NONE if none
+	uint8_t		IRQNumberER;	//Error IRQ of the I2C, RCC_IRQ_NONE otherwise
+} RCC_PeriphDesc_t;
+
+extern const RCC_PeriphDesc_t RCC_PeriphTable[RCC_PERIPH_TABLE_SIZE];
+
+/*
+ * Descriptor of a peripheral from its base address (one shift and one load)
+ */
+#define RCC_PERIPH_DESC(__PERIPHx__)	(&RCC_PeriphTable[RCC_PERIPH_INDEX(__PERIPHx__)])
+#define RCC_PERIPH_IRQ(__PERIPHx__)		(RCC_PERIPH_DESC(__PERIPHx__)->IRQNumber)
+#define RCC_PERIPH_IRQ_ER(__PERIPHx__)	(RCC_PERIPH_DESC(__PERIPHx__)->IRQNumberER)
+
+/***********************************RCC API PROTOTYPES**************************************/
+/*
+ * Clock frequency of each node of the clock tree (in Hz)
+ * Note: See the Clock Tree diagram in STM32F4xx Reference Manual for details
+ */
+uint32_t RCC_GetPLLClkFreq(void);
+uint32_t RCC_GetSysClkFreq(void);
+uint32_t RCC_GetHCLKFreq(void);
+uint32_t RCC_GetPCLK1Freq(void);
+uint32_t RCC_GetPCLK2Freq(void);
+
+/*
+ * Peripheral clock and reset through RCC_PeriphTable
+ * Note: Same code path for every instance of every driver, the enable bit is
+ * 		 written through its bit-band alias. Unknown addresses are ignored
+ */
+__force_inline void RCC_PeriphClockControl(const __vo void* pPeriph, uint8_t EnOrDi) {
+	const RCC_PeriphDesc_t* pDesc = RCC_PERIPH_DESC(pPeriph);
+	__vo uint32_t* pRSTR = (__vo uint32_t*) RCC + pDesc->Bus;
+
+	if (pDesc->BaseAddr == (uint32_t) (uintptr_t) pPeriph) {
+		BITBAND_PERIPH(pRSTR[RCC_ENR_OFFSET], pDesc->Bit) = EnOrDi ? 1U : 0U;
+	}
+}
+
+__force_inline void RCC_PeriphReset(const __vo void* pPeriph) {
+	const RCC_PeriphDesc_t* pDesc = RCC_PERIPH_DESC(pPeriph);
+	__vo uint32_t* pRSTR = (__vo uint32_t*) RCC + pDesc->Bus;
+
+	if (pDesc->BaseAddr == (uint32_t) (uintptr_t) pPeriph) {
+		BITBAND_PERIPH(*pRSTR, pDesc->Bit) = 1U;
+		BITBAND_PERIPH(*pRSTR, pDesc->Bit) = 0U;
+	}
+}
+
+#endif /* INC_STM32F407XX_RCC_DRIVER_H_ */
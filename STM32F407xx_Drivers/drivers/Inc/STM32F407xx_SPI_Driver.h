@@ -89,23 +89,21 @@
 /*
  * SPI Peripheral Clock Enable
  */
-#define SPIx_PCLK_EN(__SPIx__) 	((__SPIx__) == SPI1) ? SPI1_PCLK_EN() :\
-								((__SPIx__) == SPI2) ? SPI2_PCLK_EN() : SPI3_PCLK_EN()
+#define SPIx_PCLK_EN(__SPIx__) 	RCC_PeriphClockControl((__SPIx__), ENABLE)
 /*
  * SPI Peripheral Clock Disable
  */
-#define SPIx_PCLK_DI(__SPIx__) 	((__SPIx__) == SPI1) ? SPI1_PCLK_DI() :\
-								((__SPIx__) == SPI2) ? SPI2_PCLK_DI() : SPI3_PCLK_DI()
+#define SPIx_PCLK_DI(__SPIx__) 	RCC_PeriphClockControl((__SPIx__), DISABLE)
 
 /*
- * SPI Enable
+ * SPI Enable (single bit-band store)
  */
-#define SPIx_EN(__INDEX__)		(__INDEX__)->CR1 |= (1 << SPI_CR1_SPE)
+#define SPIx_EN(__INDEX__)		(BITBAND_PERIPH((__INDEX__)->CR1, SPI_CR1_SPE) = 1U)
 
 /*
- * SPI Disable
+ * SPI Disable (single bit-band store)
  */
-#define SPIx_DI(__INDEX__)		(__INDEX__)->CR1 &= ~(1 << SPI_CR1_SPE)
+#define SPIx_DI(__INDEX__)		(BITBAND_PERIPH((__INDEX__)->CR1, SPI_CR1_SPE) = 0U)
 
 /*************************************************************/
 
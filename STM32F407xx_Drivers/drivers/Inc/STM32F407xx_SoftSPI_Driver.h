@@ -0,0 +1,89 @@
+/*
+ * STM32F407xx_SoftSPI_Driver.h
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the software (bit-banged) SPI master
+ *      			 driven on any GPIO pins. Four CPOL/CPHA modes, MSB or LSB first,
+ *      			 8 or 16-bit frames. The API mirrors the blocking SPI_SendData and
+ *      			 SPI_ReceiveData of the SPI driver
+ */
+
+#ifndef INC_STM32F407XX_SOFTSPI_DRIVER_H_
+#define INC_STM32F407XX_SOFTSPI_DRIVER_H_
+#include "stm32f407xx.h"
+
+/*****************SPECIFIC MACROS FOR SOFTSPI*********************/
+
+/*
+ * @SOFTSPI_FIRST_BIT
+ */
+#define SOFTSPI_MSB_FIRST				0U
+#define SOFTSPI_LSB_FIRST				1U
+
+/*
+ * @SOFTSPI_SCLK_SPEED
+ * Note: SCLK frequency in Hz. SOFTSPI_SCLK_MAX runs the unrolled loop without
+ * 		 pacing (see 023SoftSPIBenchmark.c for the rate it reaches), any other
+ * 		 value paces every half period on the DWT cycle counter
+ */
+#define SOFTSPI_SCLK_MAX				0U
+#define SOFTSPI_SCLK_1MHZ				1000000U
+#define SOFTSPI_SCLK_100KHZ				100000U
+
+/****************************************************************/
+
+/*
+ * SoftSPI configuration structure
+ * Note: CPOLConfig, CPHAConfig and DFF take the SPI_CPOL_xxx, SPI_CPHA_xxx and
+ * 		 SPI_DFF_xxx macros of the SPI driver
+ */
+typedef struct {
+	uint32_t	SclkSpeed;		//See @SOFTSPI_SCLK_SPEED
+	uint8_t		DFF;			//Data Frame Format
+	uint8_t		CPOLConfig;		//Clock Polarity
+	uint8_t		CPHAConfig;		//Clock Phase
+	uint8_t		FirstBit;		//See @SOFTSPI_FIRST_BIT
+} SoftSPI_Config_t;
+
+/*
+ * SoftSPI Handle structure
+ * Note: The pins are masks (GPIO_PIN_x). pMOSIPort or pMISOPort can be NULL for a
+ * 		 receive only or transmit only bus. The other fields are filled by SoftSPI_Init()
+ */
+typedef struct {
+	GPIO_Reg_t*			pSCKPort;
+	GPIO_Reg_t*			pMOSIPort;
+	GPIO_Reg_t*			pMISOPort;
+	uint16_t			SCKPin;
+	uint16_t			MOSIPin;
+	uint16_t			MISOPin;
+	SoftSPI_Config_t	SoftSPI_Config;
+	uint32_t			SCKLead;		//BSRR word of the leading (first) edge of SCK
+	uint32_t			SCKTrail;		//BSRR word of the trailing edge, back to idle
+	uint32_t			HalfPeriod;		//DWT cycles per SCK half period, 0: not paced
+} SoftSPI_Handle_t;
+
+/********************************SOFTSPI FUNCTION API DECLARATION*************************/
+
+/*
+ * Initialization (enables the port clocks, configures the pins and drives SCK idle)
+ */
+void SoftSPI_Init(SoftSPI_Handle_t* pSoftSPIHandler);
+
+/*
+ * SoftSPI Send and Receive API (blocking)
+ * Note: len is in bytes as for SPI_SendData, a 16-bit frame takes 2 bytes of the buffer.
+ * 		 SoftSPI_SendData discards MISO, SoftSPI_ReceiveData shifts out 0xFF (MOSI high)
+ */
+void SoftSPI_SendData(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pTxBuffer, uint32_t len);
+void SoftSPI_ReceiveData(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pRxBuffer, uint32_t len);
+void SoftSPI_TransmitReceive(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pTxBuffer, uint8_t* pRxBuffer,
+							 uint32_t len);
+
+/*
+ * Single frame exchange (8 or 16 bits according to DFF)
+ */
+uint16_t SoftSPI_Transfer(SoftSPI_Handle_t* pSoftSPIHandler, uint16_t frame);
+
+#endif /* INC_STM32F407XX_SOFTSPI_DRIVER_H_ */
@@ -0,0 +1,53 @@
+/*
+ * STM32F407xx_USART_Retarget.h
+ *
+ *  Created on: Oct 4, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the printf/scanf retarget layer
+ *      			 (newlib _write/_read) on top of a buffered USART
+ */
+
+#ifndef INC_STM32F407XX_USART_RETARGET_H_
+#define INC_STM32F407XX_USART_RETARGET_H_
+#include "stm32f407xx.h"
+
+/*
+ * @USART_RETARGET_POLICY
+ * Note: What _write() does when the Tx ring buffer is full
+ */
+#define USART_RETARGET_DROP			0U	//Discard the bytes that do not fit (never blocks)
+#define USART_RETARGET_BLOCK		1U	//Wait for the TXE interrupt to free some space
+
+/*
+ * File descriptors routed to the USART
+ */
+#define USART_RETARGET_STDIN		0
+#define USART_RETARGET_STDOUT		1
+#define USART_RETARGET_STDERR		2
+
+/***********************************USART RETARGET API PROTOTYPES**************************************/
+/*
+ * Initialization
+ * Note: pRxRing is optional (NULL disables _read). When given, the reception
+ * 		 is started with USART_ReceiveRingIT(). The USARTx IRQ must be enabled
+ * 		 and forward to USART_IRQHandling() in the user application
+ */
+void USART_Retarget_Init(USART_Handle_t* pUSARTHandler, RingBuffer_t* pTxRing, RingBuffer_t* pRxRing, uint8_t policy);
+
+/*
+ * Wait until every queued byte has left the shift register
+ */
+void USART_Retarget_Flush(void);
+
+/*
+ * Number of bytes discarded by the USART_RETARGET_DROP policy
+ */
+uint32_t USART_Retarget_GetDropCount(void);
+
+/*
+ * Newlib system calls (override the weak ones of syscalls.c)
+ */
+int _write(int file, char* ptr, int len);
+int _read(int file, char* ptr, int len);
+
+#endif /* INC_STM32F407XX_USART_RETARGET_H_ */
@@ -68,6 +68,23 @@
 #define USART_OVERSAMPLING_BY_8		1U  //standard USART mode (SPI included)
 #define USART_OVERSAMPLING_BY_16	0U	//Smartcard, LIN, and IrDA mode
 
+/*
+ * @USART_WAKEUP macros
+ * Note: Multiprocessor communication (mute mode). While muted, the receiver
+ * 		 sets no RXNE flag, so the traffic for the other nodes costs no interrupt
+ */
+#define USART_WAKEUP_NONE			0U	//Mute mode not used
+#define USART_WAKEUP_IDLE_LINE		1U	//Leave mute mode on an idle line
+#define USART_WAKEUP_ADDRESS_MARK	2U	//Leave mute mode on a matching address byte (MSB set)
+
+/*
+ * Address mark bit of an address byte
+ * Note: bit 7 in 8-bit frames (7-bit data), bit 8 in 9-bit frames
+ */
+#define USART_ADDRESS_MARK_8BITS	0x80U
+#define USART_ADDRESS_MARK_9BITS	0x100U
+#define USART_NODE_ADDRESS_MASK		0x0FU	//4-bit node address (CR2 ADD[3:0])
+
 /*
  * @USART Status flags
  */
@@ -87,23 +104,37 @@
 #define USART_READY					0U
 #define USART_BUSY_IN_TX			1U
 #define USART_BUSY_IN_RX			2U
+#define USART_BUSY_IN_RX_RING		3U	//continuous reception into the Rx ring buffer
+#define USART_BUSY_IN_TX_RING		4U	//draining the Tx ring buffer
+
+/*
+ * @USART_APPLICATION_EVENTS
+ */
+#define USART_EVT_TX_CMPLT			0U
+#define USART_EVT_RX_CMPLT			1U
+#define USART_EVT_CTS				2U	//nCTS input toggled
+#define USART_EVT_RX_THROTTLED		3U	//Rx ring reached the high watermark, nRTS deasserted
+#define USART_EVT_RX_RESUMED		4U	//Rx ring drained below the low watermark, nRTS asserted
+#define USART_ERR_ORE				5U	//Overrun error
+#define USART_ERR_PE				6U	//Parity error
+#define USART_ERR_RX_RING_FULL		7U	//Byte dropped since the Rx ring is full (no RTS flow control)
+
+/*
+ * Default Rx ring watermarks (in percent of the ring size)
+ * Note: The high watermark must leave room for the bytes the remote transmitter
+ * 		 may still send after nRTS is deasserted
+ */
+#define USART_RX_RING_HIGH_WATER_PCT	75U
+#define USART_RX_RING_LOW_WATER_PCT		25U
 /****************************USART_FUNCTION_MACROS******************/
 /*
- * I2C Peripheral Clock Enable
+ * USART Peripheral Clock Enable
  */
-#define USARTx_PCLK_EN(__USARTx__) 	((__USARTx__) == USART1) ? USART1_PCLK_EN() :\
-								    ((__USARTx__) == USART2) ? USART2_PCLK_EN() :\
-								    ((__USARTx__) == USART3) ? USART3_PCLK_EN() :\
-								    ((__USARTx__) == UART4)  ? UART4_PCLK_EN()	:\
-								    ((__USARTx__) == UART5)  ? UART5_PCLK_EN()	: USART6_PCLK_EN()
+#define USARTx_PCLK_EN(__USARTx__) 	RCC_PeriphClockControl((__USARTx__), ENABLE)
 /*
- * I2C Peripheral Clock Disable
+ * USART Peripheral Clock Disable
  */
-#define USARTx_PCLK_DI(__USARTx__) 	((__USARTx__) == USART1) ? USART1_PCLK_DI() :\
-								    ((__USARTx__) == USART2) ? USART2_PCLK_DI() :\
-								    ((__USARTx__) == USART3) ? USART3_PCLK_DI() :\
-								    ((__USARTx__) == UART4)  ? UART4_PCLK_DI()	:\
-								    ((__USARTx__) == UART5)  ? UART5_PCLK_DI()	: USART6_PCLK_DI()
+#define USARTx_PCLK_DI(__USARTx__) 	RCC_PeriphClockControl((__USARTx__), DISABLE)
 
 
 
@@ -119,6 +150,8 @@ typedef struct {
 	uint8_t  ParityControl; //See @USART_PARITY_CONTROl for details
 	uint8_t  HWFlowControl; //See @USART_HW_FLOW_CTRL macros for details
 	uint8_t  Oversampling;	//See @USART_OVERSAMPLING macros for details
+	uint8_t  WakeUpMethod;	//See @USART_WAKEUP macros for details
+	uint8_t  NodeAddress;	//Address of this node (0 - 15) for USART_WAKEUP_ADDRESS_MARK
 } USART_Config_t;
 
 /*
@@ -131,8 +164,16 @@ typedef struct {
 	uint8_t* pRxBuffer;
 	uint32_t TxLen;
 	uint32_t RxLen;
-	uint8_t  TxState;
-	uint8_t  RxState;
+	__vo uint8_t TxState;		//Changed by the ISR, polled by USART_Retarget_Flush()
+	__vo uint8_t RxState;
+	RingBuffer_t* pRxRing;		//Rx ring buffer, see USART_ReceiveRingIT()
+	RingBuffer_t* pTxRing;		//Tx ring buffer, see USART_WriteRing()
+	uint32_t RxHighWater;		//Rx ring fill level at which reception is throttled
+	uint32_t RxLowWater;		//Rx ring fill level at which reception is resumed
+	uint8_t  RxThrottled;		//SET while nRTS is held deasserted by the driver
+	uint32_t OverrunCount;		//Number of ORE errors detected
+	GPIO_Reg_t* pDEPort;		//RS-485 driver enable (DE) GPIO port, NULL if not used
+	uint8_t  DEPin;				//RS-485 driver enable (DE) pin, driven high while transmitting
 } USART_Handle_t;
 
 /*******************************USART_API************************/
@@ -168,6 +209,29 @@ void USART_ReceiveData(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32
 uint8_t USART_SendDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pTxBuffer, uint32_t len);
 uint8_t USART_ReceiveDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32_t len);
 
+/*
+ * USART continuous reception into a ring buffer
+ * Note: With RTS flow control enabled, nRTS follows the fill level of the ring
+ */
+uint8_t USART_ReceiveRingIT(USART_Handle_t* pUSARTHandler, RingBuffer_t* pRxRing);
+uint32_t USART_ReadRing(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32_t len);
+void USART_StopReceiveRing(USART_Handle_t* pUSARTHandler);
+
+/*
+ * USART buffered transmission through a ring buffer
+ * Note: The TXE interrupt drains the ring in the background
+ */
+void USART_AttachTxRing(USART_Handle_t* pUSARTHandler, RingBuffer_t* pTxRing);
+uint32_t USART_WriteRing(USART_Handle_t* pUSARTHandler, const uint8_t* pTxBuffer, uint32_t len);
+
+
+/*
+ * USART multiprocessor communication (multi-drop bus)
+ * Note: See @USART_WAKEUP macros. The DE pin of the handle (if any) is driven
+ * 		 high from the first byte until the transmission is complete (TC)
+ */
+void USART_EnterMuteMode(USART_Handle_t* pUSARTHandler);
+void USART_SendAddress(USART_Handle_t* pUSARTHandler, uint8_t address);
 
 /*
  * USART Interrupt Configuration and Handling
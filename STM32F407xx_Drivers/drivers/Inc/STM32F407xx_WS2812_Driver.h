@@ -0,0 +1,127 @@
+/*
+ * STM32F407xx_WS2812_Driver.h
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains the WS2812 (NeoPixel) LED strip driver.
+ *      			 Each bit of the 800 kHz stream is one PWM period of a timer
+ *      			 channel, the duty cycles are moved to CCRx by DMA on the timer
+ *      			 update. A small circular buffer is refilled half by half from the
+ *      			 pixel framebuffer in the DMA interrupts
+ */
+
+#ifndef INC_STM32F407XX_WS2812_DRIVER_H_
+#define INC_STM32F407XX_WS2812_DRIVER_H_
+#include "stm32f407xx.h"
+#include "STM32F407xx_DMA_Driver.h"
+
+/*****************SPECIFIC MACROS FOR WS2812*********************/
+
+/*
+ * LEDs encoded per half of the DMA buffer
+ * Note: The half being refilled is sent next, the DMA interrupt has the time of one
+ * 		 half (LEDS_PER_HALF x 30 us) to run. Can be overridden from the compiler
+ * 		 command line (-DWS2812_LEDS_PER_HALF=...)
+ */
+#ifndef WS2812_LEDS_PER_HALF
+#define WS2812_LEDS_PER_HALF		4U
+#endif
+
+/*
+ * Stream timing
+ * Note: 1.25 us per bit, a 0 is high for 0.4 us and a 1 for 0.8 us (duty cycle
+ * 		 in % of the period). The strip latches the data after a low level of at
+ * 		 least 280 us (50 us on the first WS2812, the longest is used)
+ */
+#define WS2812_BIT_FREQ				800000U
+#define WS2812_T0H_PCT				32U
+#define WS2812_T1H_PCT				64U
+#define WS2812_RESET_US				280U
+
+#define WS2812_BITS_PER_LED			24U
+#define WS2812_SLOTS_PER_HALF		(WS2812_LEDS_PER_HALF * WS2812_BITS_PER_LED)
+#define WS2812_DMA_BUFFER_LEN		(2U * WS2812_SLOTS_PER_HALF)
+#define WS2812_RESET_SLOTS			((WS2812_RESET_US * (WS2812_BIT_FREQ / 1000U) + 999U) / 1000U)
+
+/*
+ * @WS2812_STATE
+ */
+#define WS2812_READY				0U
+#define WS2812_BUSY					1U
+
+/*
+ * @WS2812_STATUS
+ */
+#define WS2812_OK					0U
+#define WS2812_ERR_BUSY				1U		//a refresh is still running
+
+/*
+ * WS2812 application events
+ */
+#define WS2812_EVT_REFRESH_CMPLT	0U		//the strip has latched the frame
+#define WS2812_ERR_DMA				1U		//DMA error, the refresh was aborted
+
+/****************************************************************/
+
+/*
+ * WS2812 Handle structure
+ * Note: pTIMx, Channel, pDMAHandler (DMA_Config.Stream/Channel of the TIMx_UP
+ * 		 request), pPixels and NumLeds are set by the application before
+ * 		 WS2812_Init(). The timer update requests of the RM DMA mapping table:
+ * 		 		TIM1_UP	: DMA2 Stream 5 Channel 6
+ * 		 		TIM2_UP	: DMA1 Stream 1 Channel 3 (or Stream 7)
+ * 		 		TIM3_UP	: DMA1 Stream 2 Channel 5
+ * 		 		TIM4_UP	: DMA1 Stream 6 Channel 2
+ * 		 		TIM5_UP	: DMA1 Stream 0 Channel 6 (or Stream 6)
+ * 		 		TIM8_UP	: DMA2 Stream 1 Channel 7
+ * 		 The pin is set to the alternate function of the channel by the application
+ */
+typedef struct {
+	TIM_Reg_t*		pTIMx;
+	uint8_t			Channel;		//1 to 4
+	DMA_Handle_t*	pDMAHandler;
+	uint8_t*		pPixels;		//framebuffer: 3 bytes per LED in G, R, B order
+	uint16_t		NumLeds;
+	uint32_t		Bit0;			//CCRx value of a 0, filled by WS2812_Init()
+	uint32_t		Bit1;			//CCRx value of a 1
+	uint16_t		DataHalves;		//halves of the current frame holding LED data
+	uint16_t		TotalHalves;	//data and reset halves of the current frame
+	uint16_t		HalvesSent;
+	uint8_t			State;			//See @WS2812_STATE
+	uint32_t		DMABuffer[WS2812_DMA_BUFFER_LEN];	//CCRx word of each bit slot
+} WS2812_Handle_t;
+
+/********************************WS2812 FUNCTION API DECLARATION*************************/
+
+/*
+ * Initialization (timer in PWM mode 1 at 800 kHz, DMA stream in circular mode)
+ */
+void WS2812_Init(WS2812_Handle_t* pWS2812Handler);
+
+/*
+ * Framebuffer access
+ */
+void WS2812_SetPixel(WS2812_Handle_t* pWS2812Handler, uint16_t index, uint8_t red, uint8_t green, uint8_t blue);
+void WS2812_Fill(WS2812_Handle_t* pWS2812Handler, uint8_t red, uint8_t green, uint8_t blue);
+
+/*
+ * Send the framebuffer to the strip (non-blocking)
+ * Note: The framebuffer is read while the frame is sent, a pixel written during the
+ * 		 refresh may show in this frame or in the next one
+ */
+uint8_t WS2812_Refresh(WS2812_Handle_t* pWS2812Handler);
+
+/*
+ * Encode the bit slots of one half of the stream (called from the DMA interrupt)
+ * Note: Half number n of the frame holds LEDs n x WS2812_LEDS_PER_HALF and above,
+ * 		 the halves past the last LED are all 0 (low level of the reset). The stream is
+ * 		 checked on the host by tools/ws2812_stream_test.c
+ */
+void WS2812_EncodeHalf(WS2812_Handle_t* pWS2812Handler, uint16_t half, uint32_t* pSlots);
+
+/*
+ * Application callback
+ */
+void WS2812_ApplicationEventCallback(WS2812_Handle_t* pWS2812Handler, uint8_t appEvt);
+
+#endif /* INC_STM32F407XX_WS2812_DRIVER_H_ */
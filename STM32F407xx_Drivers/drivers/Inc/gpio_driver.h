@@ -7,9 +7,12 @@
  *      			 related to the GPIO peripherals of the STM32F407xx
  */
 
+//Outside of the guard: included first, the main header pulls the drivers in its
+//own order and the ones built on GPIO_Handle_t (1-Wire) see the complete types
+#include "stm32f407xx.h"
+
 #ifndef INC_GPIO_DRIVER_H_
 #define INC_GPIO_DRIVER_H_
-#include "stm32f407xx.h"
 
 /*
  * @GPIO Pin Config
@@ -21,46 +24,28 @@
 /*
  * @GPIO_PCLK_EN
  */
-#define GPIO_PCLK_EN(__GPIOx__)    ((__GPIOx__) == (GPIOA)) ? GPIOA_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOB)) ? GPIOB_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOC)) ? GPIOC_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOD)) ? GPIOD_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOE)) ? GPIOE_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOF)) ? GPIOF_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOG)) ? GPIOG_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOH)) ? GPIOH_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOI)) ? GPIOI_PCLK_EN() :\
-								   ((__GPIOx__) == (GPIOJ)) ? GPIOJ_PCLK_EN() : GPIOK_PCLK_EN()
+#define GPIO_PCLK_EN(__GPIOx__)		RCC_PeriphClockControl((__GPIOx__), ENABLE)
 
 /*
  * @GPIO_PCLK_DI
  */
-#define GPIO_PCLK_DI(__GPIOx__)    ((__GPIOx__) == (GPIOA)) ? GPIOA_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOB)) ? GPIOB_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOC)) ? GPIOC_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOD)) ? GPIOD_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOE)) ? GPIOE_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOF)) ? GPIOF_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOG)) ? GPIOG_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOH)) ? GPIOH_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOI)) ? GPIOI_PCLK_DI() :\
-								   ((__GPIOx__) == (GPIOJ)) ? GPIOJ_PCLK_DI() : GPIOK_PCLK_DI()
+#define GPIO_PCLK_DI(__GPIOx__)		RCC_PeriphClockControl((__GPIOx__), DISABLE)
 
 /*
  * @GPIO_PORT_INDEX
+ * Note: Ports are 1 KB apart on AHB1 (A = 0 ... K = 10), also the EXTICR code
  */
-#define GPIO_PORT_INDEX(__GPIOx__) 	((uint8_t) ((__GPIOx__) == (GPIOA)) ? 0U :\
-											   ((__GPIOx__) == (GPIOB)) ? 1U :\
-											   ((__GPIOx__) == (GPIOC)) ? 2U :\
-											   ((__GPIOx__) == (GPIOD)) ? 3U :\
-											   ((__GPIOx__) == (GPIOE)) ? 4U :\
-											   ((__GPIOx__) == (GPIOF)) ? 5U :\
-											   ((__GPIOx__) == (GPIOG)) ? 6U :\
-											   ((__GPIOx__) == (GPIOH)) ? 7U : 8U)
+#define GPIO_PORT_INDEX(__GPIOx__) 	((uint8_t) (((uint32_t) (__GPIOx__) - AHB1_BASEADDR) >> 10))
 /*
  * @GPIO_PIN_NUMBER
  */
 #define GPIO_PIN_NUMBER 			((uint16_t) 16)
+/*
+ * @GPIO_LCKR
+ * Note: LCKK is the lock key bit, LCK[15:0] select the pins. Once the key sequence
+ * 		 is done the configuration of the locked pins is frozen until the next reset
+ */
+#define GPIO_LCKR_LCKK				16U
 /*
  * @GPIO_PIN_NO
  */
@@ -156,6 +141,19 @@ typedef struct {
 
 } GPIO_Handle_t;
 
+/*
+ * Configuration registers of a GPIO port (see GPIO_SaveState)
+ * Note: ODR is not part of it, the level of the outputs stays in the hands of
+ * 		 the application
+ */
+typedef struct {
+	uint32_t MODER;
+	uint32_t OTYPER;
+	uint32_t OSPEEDR;
+	uint32_t PUPDR;
+	uint32_t AFR[2];
+} GPIO_PortState_t;
+
 /*****************************************************************************************************
  *									API SUPPORTED FOR THIS GPIO DRIVER 								 *
  *				For more information about this API, check the function description.				 *
@@ -177,9 +175,36 @@ void GPIO_PeriClkCtrl(GPIO_Reg_t* pGPIOx, uint8_t EnOrDi);
  */
 void GPIO_Init(GPIO_Handle_t* pGPIOHandler);
 
+/*
+ * Port initialization from a table of pin configurations
+ * Parameter 1: Pointer to the base address of the GPIO port
+ * Parameter 2: Table of pin configurations (GPIO_PinNumber may select several pins)
+ * Parameter 3: Number of entries in the table
+ * Note: Each register of the port is written once with the fields of all the
+ * 		 selected pins, the other pins are left untouched
+ */
+void GPIO_InitPort(GPIO_Reg_t* pGPIOx, const GPIO_PinConfig_t* pPinConfigs, uint8_t count);
+
 /* Consult the RCC Peripheral reset registers for more details*/
 void GPIO_DeInit(GPIO_Reg_t *pGPIOx);
 
+/*
+ * Snapshot and restore of the pin configuration
+ * Note: A mode switch (bus recovery, pins shared by two peripherals) is a save, a few
+ * 		 field writes, then a restore of the selected pins: 6 register writes instead
+ * 		 of a port reset and a GPIO_Init() per pin. The EXTI lines are not touched
+ */
+void GPIO_SaveState(GPIO_Reg_t* pGPIOx, GPIO_PortState_t* pState);
+void GPIO_RestoreState(GPIO_Reg_t* pGPIOx, const GPIO_PortState_t* pState, uint16_t pins);
+
+/*
+ * Configuration lock (LCKR key sequence)
+ * Note: pins is a mask of @GPIO_PIN_NO. The lock can be applied once per port and
+ * 		 reset: select all the pins to lock in the same call. Returns SET once locked
+ */
+uint8_t GPIO_LockPins(GPIO_Reg_t* pGPIOx, uint16_t pins);
+uint8_t GPIO_IsLocked(GPIO_Reg_t* pGPIOx);
+
 /*
  * GPIO Data Read/Write
  */
@@ -193,6 +218,45 @@ void GPIO_WriteToOutputPort(GPIO_Reg_t* pGPIOx, uint16_t value);
  */
 void GPIO_ToggleOutputPin(GPIO_Reg_t* pGPIOx, uint32_t pinNumber);
 
+/*
+ * GPIO fast path (always inlined, no argument checks)
+ * Note: pins is a mask of @GPIO_PIN_NO. Set, clear and toggle are a single BSRR
+ * 		 store, so they never race with an ISR writing other pins of the port
+ */
+__force_inline void GPIO_SetPins(GPIO_Reg_t* pGPIOx, uint16_t pins) {
+	pGPIOx->BSRR = pins;
+}
+
+__force_inline void GPIO_ClearPins(GPIO_Reg_t* pGPIOx, uint16_t pins) {
+	pGPIOx->BSRR = (uint32_t) pins << GPIO_PIN_NUMBER;
+}
+
+//Each selected pin is inverted on its own: the set pins go to the reset half
+//of BSRR, the clear pins to the set half
+__force_inline void GPIO_TogglePins(GPIO_Reg_t* pGPIOx, uint16_t pins) {
+	uint32_t odr = pGPIOx->ODR;
+	pGPIOx->BSRR = ((odr & pins) << GPIO_PIN_NUMBER) | (~odr & pins);
+}
+
+__force_inline uint16_t GPIO_ReadPins(GPIO_Reg_t* pGPIOx, uint16_t pins) {
+	return (uint16_t) (pGPIOx->IDR & pins);
+}
+
+//The pins of mask take the bits of value, in one BSRR store (the pins outside
+//of mask are never written, unlike GPIO_WriteToOutputPort)
+__force_inline void GPIO_WriteMasked(GPIO_Reg_t* pGPIOx, uint16_t mask, uint16_t value) {
+	pGPIOx->BSRR = ((uint32_t) (~value & mask) << GPIO_PIN_NUMBER) | (value & mask);
+}
+
+/*
+ * Stream of masked writes to a port (parallel bus, R-2R DAC)
+ * Note: strobe (0: none) is a mask of pins driven low with each value and
+ * 		 released high right after, the peripheral latches on the rising edge
+ * 		 (8080 WR line)
+ */
+void GPIO_WriteMaskedBulk(GPIO_Reg_t* pGPIOx, uint16_t mask, const uint16_t* pValues, uint32_t len,
+						  uint16_t strobe);
+
 /*
  * GPIO Interrupt Configuration and Handling
  */
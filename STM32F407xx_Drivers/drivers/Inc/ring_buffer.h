@@ -0,0 +1,63 @@
+/*
+ * ring_buffer.h
+ *
+ *  Created on: Oct 2, 2020
+ *      Author: Donavan Tran
+ *      Description: This header file contains a generic byte ring buffer
+ *      			 shared by the peripheral drivers (USART Tx/Rx buffering, logging)
+ */
+
+#ifndef INC_RING_BUFFER_H_
+#define INC_RING_BUFFER_H_
+#include <stdint.h>
+
+//Note: This header is self-contained since the driver headers of stm32f407xx.h
+//		embed RingBuffer_t in their handle structures
+
+/*
+ * Note: The ring buffer is lock-free for exactly one producer and one consumer
+ * 		 (e.g. an ISR filling it and the main loop draining it). Head is only
+ * 		 written by the producer, Tail is only written by the consumer.
+ * 		 Head and Tail are free-running counters, so the buffer size MUST be
+ * 		 a power of 2 for the index masking to work.
+ */
+typedef struct {
+	uint8_t*		pBuffer;		//Storage provided by the user application
+	uint32_t		Size;			//Size of the storage (power of 2)
+	volatile uint32_t	Head;			//Write counter (producer side)
+	volatile uint32_t	Tail;			//Read counter (consumer side)
+} RingBuffer_t;
+
+/*
+ * Check if the size is a power of 2
+ */
+#define RING_BUFFER_SIZE_VALID(__SIZE__)	(((__SIZE__) != 0U) && (((__SIZE__) & ((__SIZE__) - 1U)) == 0U))
+
+/***********************************RING BUFFER API PROTOTYPES**************************************/
+/*
+ * Initialization and reset
+ */
+void RingBuffer_Init(RingBuffer_t* pRing, uint8_t* pBuffer, uint32_t size);
+void RingBuffer_Flush(RingBuffer_t* pRing);
+
+/*
+ * Single byte access
+ * Note: both return SET on success and RESET when the buffer is full/empty
+ */
+uint8_t RingBuffer_Put(RingBuffer_t* pRing, uint8_t data);
+uint8_t RingBuffer_Get(RingBuffer_t* pRing, uint8_t* pData);
+
+/*
+ * Block access
+ * Note: both return the number of bytes actually copied
+ */
+uint32_t RingBuffer_Write(RingBuffer_t* pRing, const uint8_t* pData, uint32_t len);
+uint32_t RingBuffer_Read(RingBuffer_t* pRing, uint8_t* pData, uint32_t len);
+
+/*
+ * Fill level
+ */
+uint32_t RingBuffer_Count(RingBuffer_t* pRing);
+uint32_t RingBuffer_Free(RingBuffer_t* pRing);
+
+#endif /* INC_RING_BUFFER_H_ */
@@ -16,11 +16,19 @@
 #include <stddef.h>
 #include <math.h>
 
+//C linkage for C++ applications (see stm32f407xx.hpp). The driver headers are
+//included at the end of this file, so a C++ source includes this file (or the
+//.hpp) rather than a driver header directly
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*
  * Some generic macros
  */
 #define __vo   			volatile //making a shortcut for volatile
 #define __weak          __attribute__((weak))
+#define __force_inline	static inline __attribute__((always_inline))
 #define ENABLE 			1
 #define DISABLE			0
 #define SET				ENABLE
@@ -28,6 +36,13 @@
 #define FLAG_SET		SET
 #define FLAG_RESET		RESET
 
+/*
+ * Critical section macros (save PRIMASK, mask interrupts, restore PRIMASK)
+ * Note: Restoring the saved PRIMASK instead of unmasking keeps nested sections safe
+ */
+#define ENTER_CRITICAL(__PRIMASK__)	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (__PRIMASK__) : : "memory")
+#define EXIT_CRITICAL(__PRIMASK__)	__asm volatile ("msr primask, %0" : : "r" (__PRIMASK__) : "memory")
+
 /*******************************************PROCESSOR SPECIFIC DETAILS*******************************************/
 /*
  * @NVIC_IRQ_PRIORITY macros
@@ -88,6 +103,36 @@
 #define UART5_IRQ_NO		((uint8_t) 53)
 #define USART6_IRQ_NO		((uint8_t) 71)
 
+/*
+ * DMA stream IRQ Number of STM32F407xx MCU
+ */
+#define DMA1_STREAM0_IRQ_NO	((uint8_t) 11)
+#define DMA1_STREAM1_IRQ_NO	((uint8_t) 12)
+#define DMA1_STREAM2_IRQ_NO	((uint8_t) 13)
+#define DMA1_STREAM3_IRQ_NO	((uint8_t) 14)
+#define DMA1_STREAM4_IRQ_NO	((uint8_t) 15)
+#define DMA1_STREAM5_IRQ_NO	((uint8_t) 16)
+#define DMA1_STREAM6_IRQ_NO	((uint8_t) 17)
+#define DMA1_STREAM7_IRQ_NO	((uint8_t) 47)
+#define DMA2_STREAM0_IRQ_NO	((uint8_t) 56)
+#define DMA2_STREAM1_IRQ_NO	((uint8_t) 57)
+#define DMA2_STREAM2_IRQ_NO	((uint8_t) 58)
+#define DMA2_STREAM3_IRQ_NO	((uint8_t) 59)
+#define DMA2_STREAM4_IRQ_NO	((uint8_t) 60)
+#define DMA2_STREAM5_IRQ_NO	((uint8_t) 68)
+#define DMA2_STREAM6_IRQ_NO	((uint8_t) 69)
+#define DMA2_STREAM7_IRQ_NO	((uint8_t) 70)
+
+/*
+ * Timer IRQ Number of STM32F407xx MCU (update interrupt of TIM1/TIM8)
+ */
+#define TIM1_UP_IRQ_NO		((uint8_t) 25)
+#define TIM2_IRQ_NO			((uint8_t) 28)
+#define TIM3_IRQ_NO			((uint8_t) 29)
+#define TIM4_IRQ_NO			((uint8_t) 30)
+#define TIM8_UP_IRQ_NO		((uint8_t) 44)
+#define TIM5_IRQ_NO			((uint8_t) 50)
+
 /*
  * ARM Cortex Mx Processor NVIC Interrupt Set-Enable Register (ISER) base address
  */
@@ -106,6 +151,23 @@
 #define NVIC_IPR_BASEADDR	(__vo uint32_t *) 0xE000E400
 #define NVIC_IPR(__INDEX__) *((NVIC_IPR_BASEADDR) + (__INDEX__)) //Pointer arithmetic
 
+/*
+ * ARM Cortex Mx Processor Debug Exception and Monitor Control Register (DEMCR)
+ * Note: TRCENA must be set before the DWT and ITM units can be used
+ */
+#define DEMCR				*((__vo uint32_t*) 0xE000EDFC)
+#define DEMCR_TRCENA		24
+
+/*
+ * ARM Cortex Mx Processor Data Watchpoint and Trace (DWT) cycle counter
+ * Note: CYCCNT counts HCLK cycles and wraps around every 2^32 cycles
+ */
+#define DWT_CTRL			*((__vo uint32_t*) 0xE0001000)
+#define DWT_CYCCNT			*((__vo uint32_t*) 0xE0001004)
+#define DWT_CTRL_CYCCNTENA	0
+
+#define DWT_CYCCNT_EN()		do { (DEMCR |= (1 << DEMCR_TRCENA)); (DWT_CYCCNT = 0); (DWT_CTRL |= (1 << DWT_CTRL_CYCCNTENA)); } while (0)
+
 
 /*
  * ARM Cortex Mx Processor NVIC Interrupt Priority Level Bit
@@ -147,6 +209,25 @@
 #define AHB1_BASEADDR			0x40020000UL
 #define AHB2_BASEADDR			0x50000000UL
 
+/*
+ * Cortex-M4 bit-band regions (first 1 MB of SRAM and of the peripherals)
+ * Note: Each bit of the region has a 32-bit alias word. Writing 0 or 1 to the
+ * 		 alias clears or sets that bit alone in a single store (the bus does the
+ * 		 read-modify-write, an ISR cannot slip in between), reading returns the bit.
+ * 		 APB1, APB2 and AHB1 are covered, AHB2 (USB OTG FS, RNG...) is not.
+ * 		 Do not use it on registers with flags cleared by writing 0 (rc_w0): the
+ * 		 write back of the other bits would clear them
+ */
+#define SRAM_BB_REGION			SRAM1_BASEADDR
+#define SRAM_BB_ALIAS			0x22000000UL
+#define PERIPH_BB_REGION		PERIPH_BASEADDR
+#define PERIPH_BB_ALIAS			0x42000000UL
+
+#define BITBAND_PERIPH(__REG__, __BIT__)	(*(__vo uint32_t*) (PERIPH_BB_ALIAS + \
+											(((uint32_t) (uintptr_t) &(__REG__) - PERIPH_BB_REGION) * 32U) + ((__BIT__) * 4U)))
+#define BITBAND_SRAM(__VAR__, __BIT__)		(*(__vo uint32_t*) (SRAM_BB_ALIAS + \
+											(((uint32_t) (uintptr_t) &(__VAR__) - SRAM_BB_REGION) * 32U) + ((__BIT__) * 4U)))
+
 /*
  * Base addresses of all peripherals that are hanging on AHB1 bus
  */
@@ -154,7 +235,7 @@
 #define GPIOB_BASEADDR			(AHB1_BASEADDR + 0x0400)
 #define GPIOC_BASEADDR			(AHB1_BASEADDR + 0x0800)
 #define GPIOD_BASEADDR			(AHB1_BASEADDR + 0x0C00)
-#define GPIOE_BASEADDR			(AHB1_BASEADDR + 0x0100)
+#define GPIOE_BASEADDR			(AHB1_BASEADDR + 0x1000)
 #define GPIOF_BASEADDR			(AHB1_BASEADDR + 0x1400)
 #define GPIOG_BASEADDR			(AHB1_BASEADDR + 0x1800)
 #define GPIOH_BASEADDR			(AHB1_BASEADDR + 0x1C00)
@@ -162,10 +243,16 @@
 #define GPIOJ_BASEADDR			(AHB1_BASEADDR + 0x2400)
 #define GPIOK_BASEADDR			(AHB1_BASEADDR + 0x2800)
 #define RCC_BASEADDR			(AHB1_BASEADDR + 0x3800)
+#define DMA1_BASEADDR			(AHB1_BASEADDR + 0x6000)
+#define DMA2_BASEADDR			(AHB1_BASEADDR + 0x6400)
 
 /*
  * Base addresses of peripherals that are hanging to APB1 bus
  */
+#define TIM2_BASEADDR			(APB1_BASEADDR + 0x0000)
+#define TIM3_BASEADDR			(APB1_BASEADDR + 0x0400)
+#define TIM4_BASEADDR			(APB1_BASEADDR + 0x0800)
+#define TIM5_BASEADDR			(APB1_BASEADDR + 0x0C00)
 #define I2C1_BASEADDR			(APB1_BASEADDR + 0x5400)
 #define I2C2_BASEADDR			(APB1_BASEADDR + 0x5800)
 #define I2C3_BASEADDR			(APB1_BASEADDR + 0x5C00)
@@ -179,6 +266,8 @@
 /*
  * Base addresses of peripherals that are hanging to APB2 bus
  */
+#define TIM1_BASEADDR			(APB2_BASEADDR + 0x0000)
+#define TIM8_BASEADDR			(APB2_BASEADDR + 0x0400)
 #define SPI1_BASEADDR			(APB2_BASEADDR + 0x3000)
 #define USART1_BASEADDR			(APB2_BASEADDR + 0x1000)
 #define USART6_BASEADDR			(APB2_BASEADDR + 0x1400)
@@ -259,6 +348,29 @@ typedef struct RCC_Register {
 	__vo uint32_t DCKCFGR; 	  //offset: 0x8C
 } RCC_Reg_t;
 
+/*
+ * DMA controller register definition (interrupt status and clear registers)
+ */
+typedef struct DMA_Register {
+	__vo uint32_t LISR;		//offset: 0x00, streams 0 to 3
+	__vo uint32_t HISR;		//offset: 0x04, streams 4 to 7
+	__vo uint32_t LIFCR;	//offset: 0x08
+	__vo uint32_t HIFCR;	//offset: 0x0C
+} DMA_Reg_t;
+
+/*
+ * DMA stream register definition
+ * Note: Stream x registers are located at offset 0x10 + 0x18 * x of the controller
+ */
+typedef struct DMA_Stream_Register {
+	__vo uint32_t CR;		//offset: 0x00
+	__vo uint32_t NDTR;		//offset: 0x04
+	__vo uint32_t PAR;		//offset: 0x08
+	__vo uint32_t M0AR;		//offset: 0x0C
+	__vo uint32_t M1AR;		//offset: 0x10
+	__vo uint32_t FCR;		//offset: 0x14
+} DMA_Stream_Reg_t;
+
 /******************************************COMMUNICATION PROTOCOL STRUCTURE******************************************/
 /*
  * SPI register definition
@@ -303,6 +415,64 @@ typedef struct USART_Register {
 	__vo uint32_t CR3;		//offset: 0x14
 	__vo uint32_t GTPR;		//offset: 0x18
 } USART_Reg_t;
+
+/*
+ * Timer register definition (TIM1 to TIM5, TIM8)
+ * Note: RCR and BDTR only exist on TIM1/TIM8, CCRx are 32-bit on TIM2/TIM5
+ */
+typedef struct TIM_Register {
+	__vo uint32_t CR1;		//offset: 0x00
+	__vo uint32_t CR2;		//offset: 0x04
+	__vo uint32_t SMCR;		//offset: 0x08
+	__vo uint32_t DIER;		//offset: 0x0C
+	__vo uint32_t SR;		//offset: 0x10
+	__vo uint32_t EGR;		//offset: 0x14
+	__vo uint32_t CCMR1;	//offset: 0x18
+	__vo uint32_t CCMR2;	//offset: 0x1C
+	__vo uint32_t CCER;		//offset: 0x20
+	__vo uint32_t CNT;		//offset: 0x24
+	__vo uint32_t PSC;		//offset: 0x28
+	__vo uint32_t ARR;		//offset: 0x2C
+	__vo uint32_t RCR;		//offset: 0x30
+	__vo uint32_t CCR[4];	//offset: 0x34 - 0x40, CCR1 to CCR4
+	__vo uint32_t BDTR;		//offset: 0x44
+	__vo uint32_t DCR;		//offset: 0x48
+	__vo uint32_t DMAR;		//offset: 0x4C
+	__vo uint32_t OR;		//offset: 0x50
+} TIM_Reg_t;
+
+/******************************************PROCESSOR DEBUG/TRACE STRUCTURE*******************************************/
+/*
+ * ITM (Instrumentation Trace Macrocell) register definition
+ * Note: The Cortex-M4 implements 32 stimulus ports
+ */
+typedef struct ITM_Register {
+	__vo uint32_t STIM[32];		//offset: 0x000 - 0x07C
+	uint32_t RESERVED0[864];	//reserved: 0x080 - 0xDFC
+	__vo uint32_t TER;			//offset: 0xE00
+	uint32_t RESERVED1[15];		//reserved: 0xE04 - 0xE3C
+	__vo uint32_t TPR;			//offset: 0xE40
+	uint32_t RESERVED2[15];		//reserved: 0xE44 - 0xE7C
+	__vo uint32_t TCR;			//offset: 0xE80
+	uint32_t RESERVED3[75];		//reserved: 0xE84 - 0xFAC
+	__vo uint32_t LAR;			//offset: 0xFB0
+	__vo uint32_t LSR;			//offset: 0xFB4
+} ITM_Reg_t;
+
+/*
+ * TPIU (Trace Port Interface Unit) register definition
+ */
+typedef struct TPIU_Register {
+	__vo uint32_t SSPSR;		//offset: 0x000
+	__vo uint32_t CSPSR;		//offset: 0x004
+	uint32_t RESERVED0[2];		//reserved: 0x008 - 0x00C
+	__vo uint32_t ACPR;			//offset: 0x010
+	uint32_t RESERVED1[55];		//reserved: 0x014 - 0x0EC
+	__vo uint32_t SPPR;			//offset: 0x0F0
+	uint32_t RESERVED2[131];	//reserved: 0x0F4 - 0x2FC
+	__vo uint32_t FFSR;			//offset: 0x300
+	__vo uint32_t FFCR;			//offset: 0x304
+} TPIU_Reg_t;
 /********************************************************************************************************************/
 
 /*
@@ -325,6 +495,13 @@ typedef struct USART_Register {
  */
 #define RCC				((RCC_Reg_t*) RCC_BASEADDR)
 
+/*
+ * DMA controllers and streams definition
+ */
+#define DMA1			((DMA_Reg_t*) DMA1_BASEADDR)
+#define DMA2			((DMA_Reg_t*) DMA2_BASEADDR)
+#define DMA_STREAM(__DMAx__, __STREAM__)	((DMA_Stream_Reg_t*) ((uint32_t) (__DMAx__) + 0x10U + (0x18U * (__STREAM__))))
+
 /*
  * EXTI definition
  */
@@ -358,6 +535,24 @@ typedef struct USART_Register {
 #define UART4			((USART_Reg_t*) UART4_BASEADDR)
 #define UART5			((USART_Reg_t*) UART5_BASEADDR)
 #define USART6			((USART_Reg_t*) USART6_BASEADDR)
+
+/*
+ * Timer peripheral macros
+ */
+#define TIM1			((TIM_Reg_t*) TIM1_BASEADDR)
+#define TIM2			((TIM_Reg_t*) TIM2_BASEADDR)
+#define TIM3			((TIM_Reg_t*) TIM3_BASEADDR)
+#define TIM4			((TIM_Reg_t*) TIM4_BASEADDR)
+#define TIM5			((TIM_Reg_t*) TIM5_BASEADDR)
+#define TIM8			((TIM_Reg_t*) TIM8_BASEADDR)
+
+/*
+ * Processor debug/trace units
+ * Note: DBGMCU_CR is an STM32 register, it routes the trace pins (TRACESWO: PB3)
+ */
+#define ITM				((ITM_Reg_t*) 0xE0000000UL)
+#define TPIU			((TPIU_Reg_t*) 0xE0040000UL)
+#define DBGMCU_CR		*((__vo uint32_t*) 0xE0042004UL)
 /**********************************PERIPHERAL CLOCK ENABLE********************************/
 /*
  * Clock enable for GPIOx
@@ -374,6 +569,12 @@ typedef struct USART_Register {
 #define GPIOJ_PCLK_EN() (RCC->AHB1ENR |= (1 << 9))
 #define GPIOK_PCLK_EN() (RCC->AHB1ENR |= (1 << 10))
 
+/*
+ * Clock enable macros for DMA controllers
+ */
+#define DMA1_PCLK_EN()	(RCC->AHB1ENR |= (1 << 21))
+#define DMA2_PCLK_EN()	(RCC->AHB1ENR |= (1 << 22))
+
 /*
  * Clock enable for SPIx
  */
@@ -425,6 +626,12 @@ typedef struct USART_Register {
 #define GPIOJ_PCLK_DI() (RCC->AHB1ENR &= ~(1 << 9))
 #define GPIOK_PCLK_DI() (RCC->AHB1ENR &= ~(1 << 10))
 
+/*
+ * Clock disable macros for DMA controllers
+ */
+#define DMA1_PCLK_DI()	(RCC->AHB1ENR &= ~(1 << 21))
+#define DMA2_PCLK_DI()	(RCC->AHB1ENR &= ~(1 << 22))
+
 /*
  * Clock disable for SPIx
  */
@@ -474,6 +681,12 @@ typedef struct USART_Register {
 #define GPIOJ_PCLK_RST() do { (RCC->AHB1RSTR |= (1 << 9));  (RCC->AHB1RSTR &= ~(1 << 9)); } while (0)
 #define GPIOK_PCLK_RST() do { (RCC->AHB1RSTR |= (1 << 10)); (RCC->AHB1RSTR &= ~(1 << 10));} while (0)
 
+/*
+ * Reset DMA controller registers
+ */
+#define DMA1_PCLK_RST()  do { RCC->AHB1RSTR |= (1 << 21); RCC->AHB1RSTR &= ~(1 << 21); } while (0)
+#define DMA2_PCLK_RST()  do { RCC->AHB1RSTR |= (1 << 22); RCC->AHB1RSTR &= ~(1 << 22); } while (0)
+
 /*
  * Reset SPI Peripheral Registers
  */
@@ -567,6 +780,14 @@ typedef struct USART_Register {
 #define I2C_CR1_SMBUS				1U		//SMBus mode
 #define I2C_CR1_PE					0U 		//Peripheral enable
 
+/*
+ * @I2C_OAR1/OAR2 bit macros
+ */
+#define I2C_OAR1_ADDMODE			15U		//Addressing mode (slave mode), 1: 10-bit
+#define I2C_OAR1_ADD				0U		//Interface address [9:0] (bits 7:1 in 7-bit mode)
+#define I2C_OAR2_ADD2				1U		//Second interface address [7:1] (dual addressing mode)
+#define I2C_OAR2_ENDUAL				0U		//Dual addressing mode enable
+
 /*
  * @I2C_CR2 bit macros
  */
@@ -690,10 +911,160 @@ typedef struct USART_Register {
 #define USART_CR3_IRLP		2U		//IrDA low-power
 #define USART_CR3_IREN		1U		//IrDA mode enable
 #define USART_CR3_EIE		0U		//Error interrupt enable
+/**********************************************************************************************/
+/**********************************BIT DEFINITION OF RCC PERIPHERAL****************************/
+/*
+ * RCC PLL configuration register (RCC_PLLCFGR)
+ */
+#define RCC_PLLCFGR_PLLM	0U		//Division factor for the main PLL input clock [5:0]
+#define RCC_PLLCFGR_PLLN	6U		//Main PLL multiplication factor for VCO [14:6]
+#define RCC_PLLCFGR_PLLP	16U		//Main PLL division factor for main system clock [17:16]
+#define RCC_PLLCFGR_PLLSRC	22U		//Main PLL entry clock source
+#define RCC_PLLCFGR_PLLQ	24U		//Main PLL division factor for USB OTG FS, SDIO [27:24]
+
+/*
+ * RCC clock configuration register (RCC_CFGR)
+ */
+#define RCC_CFGR_SW			0U		//System clock switch [1:0]
+#define RCC_CFGR_SWS		2U		//System clock switch status [3:2]
+#define RCC_CFGR_HPRE		4U		//AHB prescaler [7:4]
+#define RCC_CFGR_PPRE1		10U		//APB low-speed prescaler (APB1) [12:10]
+#define RCC_CFGR_PPRE2		13U		//APB high-speed prescaler (APB2) [15:13]
+/**********************************************************************************************/
+/**********************************BIT DEFINITION OF DMA CONTROLLER*****************************/
+/*
+ * DMA stream x configuration register (DMA_SxCR)
+ */
+#define DMA_SxCR_EN			0U		//Stream enable / flag stream ready when read low
+#define DMA_SxCR_DMEIE		1U		//Direct mode error interrupt enable
+#define DMA_SxCR_TEIE		2U		//Transfer error interrupt enable
+#define DMA_SxCR_HTIE		3U		//Half transfer interrupt enable
+#define DMA_SxCR_TCIE		4U		//Transfer complete interrupt enable
+#define DMA_SxCR_PFCTRL		5U		//Peripheral flow controller
+#define DMA_SxCR_DIR		6U		//Data transfer direction [7:6]
+#define DMA_SxCR_CIRC		8U		//Circular mode
+#define DMA_SxCR_PINC		9U		//Peripheral increment mode
+#define DMA_SxCR_MINC		10U		//Memory increment mode
+#define DMA_SxCR_PSIZE		11U		//Peripheral data size [12:11]
+#define DMA_SxCR_MSIZE		13U		//Memory data size [14:13]
+#define DMA_SxCR_PINCOS		15U		//Peripheral increment offset size
+#define DMA_SxCR_PL			16U		//Priority level [17:16]
+#define DMA_SxCR_DBM		18U		//Double buffer mode
+#define DMA_SxCR_CT			19U		//Current target (double buffer mode)
+#define DMA_SxCR_PBURST		21U		//Peripheral burst transfer configuration [22:21]
+#define DMA_SxCR_MBURST		23U		//Memory burst transfer configuration [24:23]
+#define DMA_SxCR_CHSEL		25U		//Channel selection [27:25]
+
+/*
+ * DMA stream x FIFO control register (DMA_SxFCR)
+ */
+#define DMA_SxFCR_FTH		0U		//FIFO threshold selection [1:0]
+#define DMA_SxFCR_DMDIS		2U		//Direct mode disable
+#define DMA_SxFCR_FS		3U		//FIFO status [5:3]
+#define DMA_SxFCR_FEIE		7U		//FIFO error interrupt enable
+
+/*
+ * DMA interrupt status/clear flags of a stream (DMA_LISR, DMA_HISR, DMA_LIFCR, DMA_HIFCR)
+ * Note: The flags of streams 0/4, 1/5, 2/6 and 3/7 are shifted by 0, 6, 16 and 22 bits
+ */
+#define DMA_ISR_FEIF		0U		//FIFO error
+#define DMA_ISR_DMEIF		2U		//Direct mode error
+#define DMA_ISR_TEIF		3U		//Transfer error
+#define DMA_ISR_HTIF		4U		//Half transfer
+#define DMA_ISR_TCIF		5U		//Transfer complete
+/**********************************************************************************************/
+/**********************************BIT DEFINITION OF TIMER PERIPHERAL***************************/
+/*
+ * TIM control register 1 (TIMx_CR1)
+ */
+#define TIM_CR1_CEN			0U		//Counter enable
+#define TIM_CR1_UDIS		1U		//Update disable
+#define TIM_CR1_URS			2U		//Update request source
+#define TIM_CR1_OPM			3U		//One-pulse mode
+#define TIM_CR1_DIR			4U		//Direction
+#define TIM_CR1_ARPE		7U		//Auto-reload preload enable
+
+/*
+ * TIM DMA/interrupt enable register (TIMx_DIER)
+ */
+#define TIM_DIER_UIE		0U		//Update interrupt enable
+#define TIM_DIER_CC1IE		1U		//Capture/Compare 1 interrupt enable (CC2IE..CC4IE follow)
+#define TIM_DIER_UDE		8U		//Update DMA request enable
+#define TIM_DIER_CC1DE		9U		//Capture/Compare 1 DMA request enable (CC2DE..CC4DE follow)
+
+/*
+ * TIM event generation register (TIMx_EGR)
+ */
+#define TIM_EGR_UG			0U		//Update generation
+
+/*
+ * TIM capture/compare mode registers, output compare mode (TIMx_CCMR1/TIMx_CCMR2)
+ * Note: Channel 1/3 use the low byte, channel 2/4 the high byte (+8)
+ */
+#define TIM_CCMR_OCxFE		2U		//Output compare fast enable
+#define TIM_CCMR_OCxPE		3U		//Output compare preload enable
+#define TIM_CCMR_OCxM		4U		//Output compare mode [6:4]
+#define TIM_OCM_PWM1		0x6U	//Active while CNT < CCRx
+
+/*
+ * TIM capture/compare enable register (TIMx_CCER)
+ * Note: 4 bits per channel
+ */
+#define TIM_CCER_CCxE		0U		//Capture/Compare output enable
+#define TIM_CCER_CCxP		1U		//Capture/Compare output polarity
+
+/*
+ * TIM break and dead-time register (TIMx_BDTR, TIM1/TIM8 only)
+ */
+#define TIM_BDTR_MOE		15U		//Main output enable
+/**********************************************************************************************/
+/**********************************BIT DEFINITION OF ITM/TPIU/DBGMCU***************************/
+/*
+ * ITM trace control register (ITM_TCR)
+ */
+#define ITM_TCR_ITMENA		0U		//ITM enable
+#define ITM_TCR_TSENA		1U		//Local timestamp enable
+#define ITM_TCR_SYNCENA		2U		//Synchronization packet enable
+#define ITM_TCR_TXENA		3U		//Forward DWT packets to the ITM
+#define ITM_TCR_SWOENA		4U		//Timestamp counter clocked by the SWO clock
+#define ITM_TCR_TSPRESCALE	8U		//Local timestamp prescaler [9:8]
+#define ITM_TCR_TRACEBUSID	16U		//Trace bus ID [22:16]
+#define ITM_TCR_BUSY		23U		//ITM is processing events
 
+/*
+ * ITM lock access register (ITM_LAR)
+ */
+#define ITM_LAR_UNLOCK_KEY	0xC5ACCE55U
 
+/*
+ * TPIU formatter and flush control register (TPIU_FFCR)
+ */
+#define TPIU_FFCR_ENFCONT	1U		//Continuous formatting (must be 0 for SWO)
+#define TPIU_FFCR_TRIGIN	8U		//Trigger on trace trigger input
+
+/*
+ * STM32 debug MCU configuration register (DBGMCU_CR)
+ */
+#define DBGMCU_CR_TRACE_IOEN	5U		//Trace pin assignment enable
+#define DBGMCU_CR_TRACE_MODE	6U		//Trace pin assignment [7:6], 00: asynchronous (SWO)
+
+
+#include "../Inc/ring_buffer.h"
+#include "../Inc/STM32F407xx_RCC_Driver.h"
 #include "../Inc/gpio_driver.h"
+#include "../Inc/STM32F407xx_DMA_Driver.h"
 #include "../Inc/STM32F407xx_SPI_Driver.h"
+#include "../Inc/STM32F407xx_SoftSPI_Driver.h"
+#include "../Inc/STM32F407xx_OneWire_Driver.h"
+#include "../Inc/STM32F407xx_WS2812_Driver.h"
 #include "../Inc/STM32F407xx_I2C_Driver.h"
+#include "../Inc/STM32F407xx_EEPROM_Driver.h"
 #include "../Inc/STM32F407xx_USART_UART_Driver.h"
+#include "../Inc/STM32F407xx_USART_Retarget.h"
+#include "../Inc/STM32F407xx_Log.h"
+#include "../Inc/STM32F407xx_ITM_Driver.h"
+
+#ifdef __cplusplus
+}
+#endif
 #endif /* INC_STM32F407XX_H_ */
@@ -0,0 +1,386 @@
+/*
+ * stm32f407xx.hpp
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: Header-only C++17 layer over the register structures of
+ *      			 stm32f407xx.h. The peripheral instance and the pin are template
+ *      			 parameters: the addresses are constants, the clock enable bit is
+ *      			 a single bit-band store and the pin/alternate function choices
+ *      			 are checked at compile time. No handle, no runtime dispatch.
+ *
+ *      			 Gpio<PortA, 5>		: pin PA5
+ *      			 Spi<1>				: SPI1 (SPI1 to SPI3)
+ *      			 Usart<2>			: USART2 (USART1, 2, 3, 6)
+ *
+ *      			 The C driver API stays available for everything else
+ */
+
+#ifndef INC_STM32F407XX_HPP_
+#define INC_STM32F407XX_HPP_
+
+#if __cplusplus < 201703L
+#error "stm32f407xx.hpp needs C++17 (-std=c++17)"
+#endif
+
+#include "stm32f407xx.h"
+
+namespace stm32f407 {
+
+/*
+ * GPIO ports (A to I on the STM32F407)
+ */
+enum class Port : uint8_t { A, B, C, D, E, F, G, H, I };
+
+inline constexpr Port PortA = Port::A;
+inline constexpr Port PortB = Port::B;
+inline constexpr Port PortC = Port::C;
+inline constexpr Port PortD = Port::D;
+inline constexpr Port PortE = Port::E;
+inline constexpr Port PortF = Port::F;
+inline constexpr Port PortG = Port::G;
+inline constexpr Port PortH = Port::H;
+inline constexpr Port PortI = Port::I;
+
+/*
+ * Pin configuration values (same encoding as the C macros)
+ */
+enum class PinMode : uint8_t {
+	Input	= GPIO_INPUT_MODE,
+	Output	= GPIO_OUTPUT_MODE,
+	AltFunc	= GPIO_ALT_FUNC_MODE,
+	Analog	= GPIO_ANALOG_MODE,
+};
+
+enum class OutputType : uint8_t {
+	PushPull	= GPIO_PUSH_PULL,
+	OpenDrain	= GPIO_OPEN_DRAIN,
+};
+
+enum class Speed : uint8_t {
+	Low			= GPIO_LOW_SPEED,
+	Medium		= GPIO_MEDIUM_SPEED,
+	High		= GPIO_HIGH_SPEED,
+	VeryHigh	= GPIO_VERY_HIGH_SPEED,
+};
+
+enum class Pull : uint8_t {
+	None	= GPIO_NO_PU_PD,
+	Up		= GPIO_PU,
+	Down	= GPIO_PD,
+};
+
+namespace detail {
+
+/*
+ * Bit-band alias of a bit in a register at a fixed address
+ * Note: The alias address is a constant, so set/clear is one store
+ */
+template <uint32_t RegAddr, uint8_t Bit>
+struct BitBand {
+	static_assert(RegAddr >= PERIPH_BB_REGION && RegAddr < (PERIPH_BB_REGION + 0x100000UL),
+				  "register outside of the peripheral bit-band region");
+	static constexpr uint32_t alias = PERIPH_BB_ALIAS + ((RegAddr - PERIPH_BB_REGION) * 32U) + (Bit * 4U);
+
+	__attribute__((always_inline)) static void set() { *reinterpret_cast<__vo uint32_t*>(alias) = 1U; }
+	__attribute__((always_inline)) static void clear() { *reinterpret_cast<__vo uint32_t*>(alias) = 0U; }
+	__attribute__((always_inline)) static bool read() { return *reinterpret_cast<__vo uint32_t*>(alias) != 0U; }
+};
+
+/*
+ * RCC enable registers
+ */
+inline constexpr uint32_t RCC_AHB1ENR = RCC_BASEADDR + offsetof(RCC_Reg_t, AHB1ENR);
+inline constexpr uint32_t RCC_APB1ENR = RCC_BASEADDR + offsetof(RCC_Reg_t, APB1ENR);
+inline constexpr uint32_t RCC_APB2ENR = RCC_BASEADDR + offsetof(RCC_Reg_t, APB2ENR);
+
+/*
+ * Pin of an alternate function table
+ */
+struct PinRef {
+	Port	port;
+	uint8_t	pin;
+};
+
+template <size_t N>
+constexpr bool hasPin(const PinRef (&table)[N], Port port, uint8_t pin) {
+	for (size_t i = 0; i < N; i++) {
+		if (table[i].port == port && table[i].pin == pin) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Instance traits: base address, clock enable bit, alternate function and pins
+ * (datasheet DS8626, alternate function mapping)
+ */
+template <uint8_t N> struct SpiTraits;
+
+template <> struct SpiTraits<1> {
+	static constexpr uint32_t base = SPI1_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB2ENR;
+	static constexpr uint8_t enrBit = 12;
+	static constexpr uint8_t af = AF5;
+	static constexpr PinRef sck[] = { { Port::A, 5 }, { Port::B, 3 } };
+	static constexpr PinRef miso[] = { { Port::A, 6 }, { Port::B, 4 } };
+	static constexpr PinRef mosi[] = { { Port::A, 7 }, { Port::B, 5 } };
+};
+
+template <> struct SpiTraits<2> {
+	static constexpr uint32_t base = SPI2_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB1ENR;
+	static constexpr uint8_t enrBit = 14;
+	static constexpr uint8_t af = AF5;
+	static constexpr PinRef sck[] = { { Port::B, 10 }, { Port::B, 13 }, { Port::I, 1 } };
+	static constexpr PinRef miso[] = { { Port::B, 14 }, { Port::C, 2 }, { Port::I, 2 } };
+	static constexpr PinRef mosi[] = { { Port::B, 15 }, { Port::C, 3 }, { Port::I, 3 } };
+};
+
+template <> struct SpiTraits<3> {
+	static constexpr uint32_t base = SPI3_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB1ENR;
+	static constexpr uint8_t enrBit = 15;
+	static constexpr uint8_t af = AF6;
+	static constexpr PinRef sck[] = { { Port::B, 3 }, { Port::C, 10 } };
+	static constexpr PinRef miso[] = { { Port::B, 4 }, { Port::C, 11 } };
+	static constexpr PinRef mosi[] = { { Port::B, 5 }, { Port::C, 12 } };
+};
+
+template <uint8_t N> struct UsartTraits;
+
+template <> struct UsartTraits<1> {
+	static constexpr uint32_t base = USART1_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB2ENR;
+	static constexpr uint8_t enrBit = 4;
+	static constexpr uint8_t af = AF7;
+	static constexpr bool apb2 = true;
+	static constexpr PinRef tx[] = { { Port::A, 9 }, { Port::B, 6 } };
+	static constexpr PinRef rx[] = { { Port::A, 10 }, { Port::B, 7 } };
+};
+
+template <> struct UsartTraits<2> {
+	static constexpr uint32_t base = USART2_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB1ENR;
+	static constexpr uint8_t enrBit = 17;
+	static constexpr uint8_t af = AF7;
+	static constexpr bool apb2 = false;
+	static constexpr PinRef tx[] = { { Port::A, 2 }, { Port::D, 5 } };
+	static constexpr PinRef rx[] = { { Port::A, 3 }, { Port::D, 6 } };
+};
+
+template <> struct UsartTraits<3> {
+	static constexpr uint32_t base = USART3_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB1ENR;
+	static constexpr uint8_t enrBit = 18;
+	static constexpr uint8_t af = AF7;
+	static constexpr bool apb2 = false;
+	static constexpr PinRef tx[] = { { Port::B, 10 }, { Port::C, 10 }, { Port::D, 8 } };
+	static constexpr PinRef rx[] = { { Port::B, 11 }, { Port::C, 11 }, { Port::D, 9 } };
+};
+
+template <> struct UsartTraits<6> {
+	static constexpr uint32_t base = USART6_BASEADDR;
+	static constexpr uint32_t enr = RCC_APB2ENR;
+	static constexpr uint8_t enrBit = 5;
+	static constexpr uint8_t af = AF8;
+	static constexpr bool apb2 = true;
+	static constexpr PinRef tx[] = { { Port::C, 6 }, { Port::G, 14 } };
+	static constexpr PinRef rx[] = { { Port::C, 7 }, { Port::G, 9 } };
+};
+
+} // namespace detail
+
+/*
+ * GPIO pin
+ * Note: Configuration writes only touch the fields of this pin. With constant
+ * 		 arguments each register access is a load, a mask with constants and a store
+ */
+template <Port P, uint8_t Pin>
+class Gpio {
+	static_assert(P <= Port::I, "the STM32F407 has the GPIO ports A to I");
+	static_assert(Pin < GPIO_PIN_NUMBER, "GPIO pin number is 0 to 15");
+
+public:
+	static constexpr Port port = P;
+	static constexpr uint8_t pin = Pin;
+	static constexpr uint32_t base = AHB1_BASEADDR + (0x0400UL * static_cast<uint32_t>(P));
+	static constexpr uint16_t mask = static_cast<uint16_t>(1U << Pin);
+
+	__attribute__((always_inline)) static GPIO_Reg_t* regs() { return reinterpret_cast<GPIO_Reg_t*>(base); }
+
+	__attribute__((always_inline)) static void clockEnable() {
+		detail::BitBand<detail::RCC_AHB1ENR, static_cast<uint8_t>(P)>::set();
+	}
+
+	static void configure(PinMode mode, OutputType type = OutputType::PushPull, Speed speed = Speed::Low,
+						  Pull pull = Pull::None) {
+		GPIO_Reg_t* pGPIOx = regs();
+
+		clockEnable();
+		pGPIOx->OTYPER = (pGPIOx->OTYPER & ~(1UL << Pin)) | (static_cast<uint32_t>(type) << Pin);
+		pGPIOx->OSPEEDR = (pGPIOx->OSPEEDR & ~(0x03UL << (Pin * 2U))) | (static_cast<uint32_t>(speed) << (Pin * 2U));
+		pGPIOx->PUPDR = (pGPIOx->PUPDR & ~(0x03UL << (Pin * 2U))) | (static_cast<uint32_t>(pull) << (Pin * 2U));
+		pGPIOx->MODER = (pGPIOx->MODER & ~(0x03UL << (Pin * 2U))) | (static_cast<uint32_t>(mode) << (Pin * 2U));
+	}
+
+	static void output(OutputType type = OutputType::PushPull, Speed speed = Speed::Low) {
+		configure(PinMode::Output, type, speed, Pull::None);
+	}
+
+	static void input(Pull pull = Pull::None) {
+		configure(PinMode::Input, OutputType::PushPull, Speed::Low, pull);
+	}
+
+	template <uint8_t AF>
+	static void altFunc(OutputType type = OutputType::PushPull, Speed speed = Speed::VeryHigh,
+						Pull pull = Pull::None) {
+		static_assert(AF <= AF15, "alternate function is AF0 to AF15");
+		constexpr uint32_t shift = (Pin & 0x07U) * 4U;
+		GPIO_Reg_t* pGPIOx = regs();
+
+		clockEnable();
+		pGPIOx->AFR[Pin >> 3U] = (pGPIOx->AFR[Pin >> 3U] & ~(0x0FUL << shift)) | (static_cast<uint32_t>(AF) << shift);
+		configure(PinMode::AltFunc, type, speed, pull);
+	}
+
+	__attribute__((always_inline)) static void set() { regs()->BSRR = mask; }
+	__attribute__((always_inline)) static void clear() { regs()->BSRR = static_cast<uint32_t>(mask) << GPIO_PIN_NUMBER; }
+	__attribute__((always_inline)) static void write(bool value) {
+		regs()->BSRR = value ? static_cast<uint32_t>(mask) : (static_cast<uint32_t>(mask) << GPIO_PIN_NUMBER);
+	}
+	__attribute__((always_inline)) static void toggle() {
+		uint32_t odr = regs()->ODR;
+		regs()->BSRR = ((odr & mask) << GPIO_PIN_NUMBER) | (~odr & mask);
+	}
+	__attribute__((always_inline)) static bool read() { return (regs()->IDR & mask) != 0U; }
+};
+
+/*
+ * SPI master (blocking, software slave select)
+ */
+template <uint8_t N>
+class Spi {
+	using Traits = detail::SpiTraits<N>;
+	using SPE = detail::BitBand<Traits::base + offsetof(SPI_Reg_t, CR1), SPI_CR1_SPE>;
+
+public:
+	static constexpr uint32_t base = Traits::base;
+
+	__attribute__((always_inline)) static SPI_Reg_t* regs() { return reinterpret_cast<SPI_Reg_t*>(base); }
+
+	__attribute__((always_inline)) static void clockEnable() {
+		detail::BitBand<Traits::enr, Traits::enrBit>::set();
+	}
+
+	//Alternate function of the pins, each pin is checked against the SPIx pin table
+	template <typename Sck, typename Miso, typename Mosi>
+	static void pins(Speed speed = Speed::VeryHigh) {
+		static_assert(detail::hasPin(Traits::sck, Sck::port, Sck::pin), "pin is not an SCK pin of this SPI");
+		static_assert(detail::hasPin(Traits::miso, Miso::port, Miso::pin), "pin is not a MISO pin of this SPI");
+		static_assert(detail::hasPin(Traits::mosi, Mosi::port, Mosi::pin), "pin is not a MOSI pin of this SPI");
+
+		Sck::template altFunc<Traits::af>(OutputType::PushPull, speed);
+		Miso::template altFunc<Traits::af>(OutputType::PushPull, speed);
+		Mosi::template altFunc<Traits::af>(OutputType::PushPull, speed);
+	}
+
+	//Full duplex master, CR1 built at compile time and written in one store
+	template <uint8_t SclkSpeed = SPI_SCLK_SPEED_DIV2, uint8_t Cpol = SPI_CPOL_LOW, uint8_t Cpha = SPI_CPHA_LOW,
+			  uint8_t Dff = SPI_DFF_8_BIT>
+	static void master() {
+		static_assert(SclkSpeed <= SPI_SCLK_SPEED_DIV256, "see the SPI_SCLK_SPEED_DIVx macros");
+		static_assert(Cpol <= 1U && Cpha <= 1U && Dff <= 1U, "CPOL, CPHA and DFF are single bits");
+		constexpr uint32_t cr1 = (1UL << SPI_CR1_MSTR) | (static_cast<uint32_t>(SclkSpeed) << SPI_CR1_BR) |
+								 (static_cast<uint32_t>(Cpol) << SPI_CR1_CPOL) | (static_cast<uint32_t>(Cpha) << SPI_CR1_CPHA) |
+								 (static_cast<uint32_t>(Dff) << SPI_CR1_DFF) | (1UL << SPI_CR1_SSM) | (1UL << SPI_CR1_SSI);
+
+		clockEnable();
+		regs()->CR1 = cr1;
+		SPE::set();
+	}
+
+	__attribute__((always_inline)) static void enable() { SPE::set(); }
+	__attribute__((always_inline)) static void disable() { SPE::clear(); }
+
+	static uint16_t transfer(uint16_t data) {
+		SPI_Reg_t* pSPIx = regs();
+
+		while (!(pSPIx->SR & (1UL << SPI_SR_TXE)));
+		pSPIx->DR = data;
+		while (!(pSPIx->SR & (1UL << SPI_SR_RXNE)));
+		return static_cast<uint16_t>(pSPIx->DR);
+	}
+
+	//Send only: the received bytes are dropped, returns once the last frame is out
+	static void send(const uint8_t* pTxBuffer, uint32_t len) {
+		SPI_Reg_t* pSPIx = regs();
+
+		while (len--) {
+			while (!(pSPIx->SR & (1UL << SPI_SR_TXE)));
+			pSPIx->DR = *pTxBuffer++;
+		}
+		while (pSPIx->SR & (1UL << SPI_SR_BSY));
+		(void) pSPIx->DR;
+		(void) pSPIx->SR;
+	}
+};
+
+/*
+ * USART (8N1, blocking)
+ */
+template <uint8_t N>
+class Usart {
+	using Traits = detail::UsartTraits<N>;
+
+public:
+	static constexpr uint32_t base = Traits::base;
+
+	__attribute__((always_inline)) static USART_Reg_t* regs() { return reinterpret_cast<USART_Reg_t*>(base); }
+
+	__attribute__((always_inline)) static void clockEnable() {
+		detail::BitBand<Traits::enr, Traits::enrBit>::set();
+	}
+
+	//Alternate function of the pins, each pin is checked against the USARTx pin table
+	template <typename Tx, typename Rx>
+	static void pins() {
+		static_assert(detail::hasPin(Traits::tx, Tx::port, Tx::pin), "pin is not a TX pin of this USART");
+		static_assert(detail::hasPin(Traits::rx, Rx::port, Rx::pin), "pin is not an RX pin of this USART");
+
+		Tx::template altFunc<Traits::af>(OutputType::PushPull, Speed::High);
+		Rx::template altFunc<Traits::af>(OutputType::PushPull, Speed::High, Pull::Up);
+	}
+
+	//Oversampling by 16: BRR = PCLK / baud rate (mantissa and fraction together)
+	static void init(uint32_t baudRate) {
+		uint32_t pclk = Traits::apb2 ? RCC_GetPCLK2Freq() : RCC_GetPCLK1Freq();
+
+		clockEnable();
+		regs()->BRR = (pclk + (baudRate / 2U)) / baudRate;
+		regs()->CR1 = (1UL << USART_CR1_UE) | (1UL << USART_CR1_TE) | (1UL << USART_CR1_RE);
+	}
+
+	static void write(uint8_t data) {
+		while (!(regs()->SR & (1UL << USART_SR_TXE)));
+		regs()->DR = data;
+	}
+
+	static void write(const uint8_t* pTxBuffer, uint32_t len) {
+		while (len--) {
+			write(*pTxBuffer++);
+		}
+	}
+
+	__attribute__((always_inline)) static bool readable() { return (regs()->SR & (1UL << USART_SR_RXNE)) != 0U; }
+
+	static uint8_t read() {
+		while (!readable());
+		return static_cast<uint8_t>(regs()->DR);
+	}
+};
+
+} // namespace stm32f407
+
+#endif /* INC_STM32F407XX_HPP_ */
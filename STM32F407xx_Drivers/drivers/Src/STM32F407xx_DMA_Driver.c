@@ -0,0 +1,309 @@
+/*
+ * STM32F407xx_DMA_Driver.c
+ *
+ *  Created on: Oct 12, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the DMA1/DMA2 stream driver
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*
+ * Helper functions
+ */
+static uint8_t getFlagShift(uint8_t stream);
+static __vo uint32_t* getFlagClearReg(DMA_Handle_t* pDMAHandler);
+static uint32_t getFlags(DMA_Handle_t* pDMAHandler);
+
+/*****************************************************
+ * @fn					- DMA_PeriClkCtrl
+ *
+ * @brief				- Enable or disable the DMAx controller clock
+ *
+ * @param[in]			- Base address of the DMA controller
+ * @param[in]			- ENABLE or DISABLE macro
+ *
+ * @return				- none
+ * @note				- none
+ */
+void DMA_PeriClkCtrl(DMA_Reg_t* pDMAx, uint8_t EnOrDi) {
+	RCC_PeriphClockControl(pDMAx, EnOrDi);
+}
+
+/*****************************************************
+ * @fn					- DMA_Init
+ *
+ * @brief				- Configure a DMA stream given the handle structure
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- none
+ * @note				- The stream is left disabled, see DMA_Start()
+ */
+void DMA_Init(DMA_Handle_t* pDMAHandler) {
+	DMA_Config_t* pConfig = &pDMAHandler->DMA_Config;
+	uint32_t tempReg = 0;
+
+	DMA_PeriClkCtrl(pDMAHandler->pDMAx, ENABLE);
+	pDMAHandler->pStream = DMA_STREAM(pDMAHandler->pDMAx, pConfig->Stream);
+
+	//The stream registers are read-only while EN is set
+	DMA_Stop(pDMAHandler);
+
+	tempReg |= (uint32_t) (pConfig->Channel & 0x7U) << DMA_SxCR_CHSEL;
+	tempReg |= (uint32_t) (pConfig->Priority & 0x3U) << DMA_SxCR_PL;
+	tempReg |= (uint32_t) (pConfig->DataSize & 0x3U) << DMA_SxCR_MSIZE;
+	tempReg |= (uint32_t) (pConfig->DataSize & 0x3U) << DMA_SxCR_PSIZE;
+	tempReg |= (uint32_t) (pConfig->Direction & 0x3U) << DMA_SxCR_DIR;
+	if (pConfig->MemInc == ENABLE) {
+		tempReg |= (1 << DMA_SxCR_MINC);
+	}
+	if (pConfig->Circular == ENABLE) {
+		tempReg |= (1 << DMA_SxCR_CIRC);
+	}
+	pDMAHandler->pStream->CR = tempReg;
+
+	//Direct mode for the peripheral transfers. Memory-to-memory needs the FIFO,
+	//the "peripheral" side is then the source buffer and is incremented as well
+	if (pConfig->Direction == DMA_DIR_MEM_TO_MEM) {
+		pDMAHandler->pStream->CR |= (1 << DMA_SxCR_PINC);
+		pDMAHandler->pStream->FCR = (1 << DMA_SxFCR_DMDIS) | (0x3 << DMA_SxFCR_FTH);
+	} else {
+		pDMAHandler->pStream->FCR = 0;
+	}
+}
+
+/*****************************************************
+ * @fn					- DMA_DeInit
+ *
+ * @brief				- Reset all the registers of the DMA controller
+ *
+ * @param[in]			- Base address of the DMA controller
+ *
+ * @return				- none
+ * @note				- All 8 streams of the controller are reset
+ */
+void DMA_DeInit(DMA_Reg_t* pDMAx) {
+	RCC_PeriphReset(pDMAx);
+}
+
+/*****************************************************
+ * @fn					- DMA_Start
+ *
+ * @brief				- Program the addresses and the length, then enable the stream
+ *
+ * @param[in]			- DMA handle structure
+ * @param[in]			- peripheral address (source buffer for memory-to-memory)
+ * @param[in]			- memory address
+ * @param[in]			- number of data items
+ *
+ * @return				- none
+ * @note				- Transfer complete and error interrupts are always enabled
+ */
+void DMA_Start(DMA_Handle_t* pDMAHandler, uint32_t periphAddr, uint32_t memAddr, uint16_t len) {
+	DMA_Stream_Reg_t* pStream = pDMAHandler->pStream;
+
+	DMA_Stop(pDMAHandler);
+
+	pStream->PAR = periphAddr;
+	pStream->M0AR = memAddr;
+	pStream->NDTR = len;
+
+	pStream->CR |= (1 << DMA_SxCR_TCIE) | (1 << DMA_SxCR_TEIE) | (1 << DMA_SxCR_DMEIE);
+	if (pDMAHandler->DMA_Config.HalfTransferIT == ENABLE) {
+		pStream->CR |= (1 << DMA_SxCR_HTIE);
+	} else {
+		pStream->CR &= ~(1 << DMA_SxCR_HTIE);
+	}
+
+	pStream->CR |= (1 << DMA_SxCR_EN);
+}
+
+/*****************************************************
+ * @fn					- DMA_Stop
+ *
+ * @brief				- Disable the stream and clear its interrupt flags
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- none
+ * @note				- EN reads back low once the current data item is finished
+ */
+void DMA_Stop(DMA_Handle_t* pDMAHandler) {
+	DMA_Stream_Reg_t* pStream = pDMAHandler->pStream;
+
+	pStream->CR &= ~((1 << DMA_SxCR_EN) | (1 << DMA_SxCR_TCIE) | (1 << DMA_SxCR_HTIE) |
+					 (1 << DMA_SxCR_TEIE) | (1 << DMA_SxCR_DMEIE));
+	while (pStream->CR & (1 << DMA_SxCR_EN));
+
+	//Every flag of the stream must be cleared before it is enabled again
+	*getFlagClearReg(pDMAHandler) = 0x3DU << getFlagShift(pDMAHandler->DMA_Config.Stream);
+}
+
+/*****************************************************
+ * @fn					- DMA_GetRemaining
+ *
+ * @brief				- Number of data items left to transfer
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- NDTR value
+ * @note				- none
+ */
+uint16_t DMA_GetRemaining(DMA_Handle_t* pDMAHandler) {
+	return (uint16_t) pDMAHandler->pStream->NDTR;
+}
+
+/*****************************************************
+ * @fn					- DMA_IRQITConfig
+ *
+ * @brief				- Enable or disable the DMA stream interrupt in the NVIC
+ *
+ * @param[in]			- IRQ number of the DMA stream
+ * @param[in]			= ENABLE or DISABLE macro
+ *
+ * @return				- none
+ * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ */
+void DMA_IRQITConfig(uint8_t IRQNumber, uint8_t EnOrDi) {
+	uint32_t indx, remainder;
+	indx = IRQNumber >> 5U; //Index to configure the correct NVIC_ISER
+	remainder = IRQNumber & 0x1FU;
+	if (EnOrDi) {
+		NVIC_ISER(indx) |= 1 << remainder;
+	} else {
+		NVIC_ICER(indx) |= 1 << remainder;
+	}
+}
+
+/*****************************************************
+ * @fn					- DMA_IRQPriorityConfig
+ *
+ * @brief				- DMA stream Interrupt Priority Configuration
+ *
+ * @param[in]			- IRQ number of the DMA stream
+ * @param[in]			= The priority value of that DMA stream
+ *
+ * @return				- none
+ * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ */
+void DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriorityValue) {
+	uint32_t indx = IRQNumber >> 2U; //Note: There are 4 IRQ Priority fields in each IPR register
+	uint32_t remainder = IRQNumber & 0x3U;
+	uint32_t shift_amount = (remainder * 8U) + IMPLEMENTED_IRQ_PRIORITY_BIT;
+
+	//Configure the IRQ_PR register
+	NVIC_IPR(indx) |= IRQPriorityValue << shift_amount;
+}
+
+/*****************************************************
+ * @fn					- DMA_IRQHandling
+ *
+ * @brief				- Handle the interrupt of a DMA stream
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- none
+ * @note				- Call it from the DMAx_Streamy_IRQHandler of the stream.
+ * 						  The flags are cleared before the callback so that
+ * 						  the callback can start the next transfer
+ */
+void DMA_IRQHandling(DMA_Handle_t* pDMAHandler) {
+	uint32_t flags = getFlags(pDMAHandler);
+	uint32_t enabled = pDMAHandler->pStream->CR;
+	uint8_t shift = getFlagShift(pDMAHandler->DMA_Config.Stream);
+	__vo uint32_t* pClearReg = getFlagClearReg(pDMAHandler);
+	DMA_Callback_t callback = pDMAHandler->Callback ? pDMAHandler->Callback : DMA_ApplicationEventCallback;
+
+	//Transfer error: the stream is already disabled by hardware
+	if ((flags & (1 << DMA_ISR_TEIF)) && (enabled & (1 << DMA_SxCR_TEIE))) {
+		*pClearReg = (1U << DMA_ISR_TEIF) << shift;
+		callback(pDMAHandler, DMA_ERR_TRANSFER);
+	}
+
+	//Direct mode error
+	if ((flags & (1 << DMA_ISR_DMEIF)) && (enabled & (1 << DMA_SxCR_DMEIE))) {
+		*pClearReg = (1U << DMA_ISR_DMEIF) << shift;
+		callback(pDMAHandler, DMA_ERR_DIRECT_MODE);
+	}
+
+	//FIFO error (only reported when FEIE is set by the application)
+	if ((flags & (1 << DMA_ISR_FEIF)) && (pDMAHandler->pStream->FCR & (1 << DMA_SxFCR_FEIE))) {
+		*pClearReg = (1U << DMA_ISR_FEIF) << shift;
+		callback(pDMAHandler, DMA_ERR_FIFO);
+	}
+
+	//Half transfer
+	if ((flags & (1 << DMA_ISR_HTIF)) && (enabled & (1 << DMA_SxCR_HTIE))) {
+		*pClearReg = (1U << DMA_ISR_HTIF) << shift;
+		callback(pDMAHandler, DMA_EVT_HALF_CMPLT);
+	}
+
+	//Transfer complete
+	if ((flags & (1 << DMA_ISR_TCIF)) && (enabled & (1 << DMA_SxCR_TCIE))) {
+		*pClearReg = (1U << DMA_ISR_TCIF) << shift;
+		callback(pDMAHandler, DMA_EVT_TRANSFER_CMPLT);
+	}
+}
+
+/*****************************************************
+ * @fn					- DMA_ApplicationEventCallback
+ *
+ * @brief				- Inform the user application of the stream events
+ *
+ * @param[in]			- DMA handle structure
+ * @param[in]			- event macros
+ *
+ * @return				- none
+ * @note				- weak implementation for user application to implement,
+ * 						  only used by the streams without their own Callback
+ */
+__weak void DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt) {
+	//This API is implemented by the user application
+}
+
+/*****************************************************
+ * @fn					- getFlagShift
+ *
+ * @brief				- Position of the flags of a stream in the xISR/xIFCR registers
+ *
+ * @param[in]			- stream number
+ *
+ * @return				- bit offset of the FEIF flag of the stream
+ * @note				- none
+ */
+static uint8_t getFlagShift(uint8_t stream) {
+	static const uint8_t shift[4] = { 0U, 6U, 16U, 22U };
+	return shift[stream & 0x3U];
+}
+
+/*****************************************************
+ * @fn					- getFlagClearReg
+ *
+ * @brief				- Flag clear register (LIFCR or HIFCR) of the stream
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- pointer to the clear register
+ * @note				- none
+ */
+static __vo uint32_t* getFlagClearReg(DMA_Handle_t* pDMAHandler) {
+	return (pDMAHandler->DMA_Config.Stream < 4U) ? &pDMAHandler->pDMAx->LIFCR : &pDMAHandler->pDMAx->HIFCR;
+}
+
+/*****************************************************
+ * @fn					- getFlags
+ *
+ * @brief				- Interrupt flags of the stream, aligned on bit 0
+ *
+ * @param[in]			- DMA handle structure
+ *
+ * @return				- flags, see DMA_ISR_xxx
+ * @note				- none
+ */
+static uint32_t getFlags(DMA_Handle_t* pDMAHandler) {
+	uint8_t stream = pDMAHandler->DMA_Config.Stream;
+	uint32_t isr = (stream < 4U) ? pDMAHandler->pDMAx->LISR : pDMAHandler->pDMAx->HISR;
+
+	return (isr >> getFlagShift(stream)) & 0x3DU;
+}
@@ -0,0 +1,346 @@
+/*
+ * STM32F407xx_EEPROM_Driver.c
+ *
+ *  Created on: Oct 15, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the 24Cxx I2C EEPROM driver
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*
+ * Helper function prototypes
+ */
+static uint16_t deviceAddress(EEPROM_Handle_t* pEEPROMHandler, uint32_t address);
+static uint8_t readDevice(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pRxBuffer, uint32_t len);
+static uint8_t writeDevice(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pTxBuffer, uint32_t len);
+static uint8_t cacheWrite(EEPROM_Handle_t* pEEPROMHandler, uint32_t page, uint16_t offset,
+						  uint8_t* pTxBuffer, uint16_t len);
+
+/*****************************************************
+ * @fn					- EEPROM_Init
+ *
+ * @brief				- Check the configuration and empty the cache
+ *
+ * @param[in]			- EEPROM handle structure
+ *
+ * @return				- EEPROM_OK or EEPROM_ERR_CONFIG
+ * @note				- The I2C handle must already be initialized. The first access
+ * 						  polls the device in case a write cycle was started before reset
+ */
+uint8_t EEPROM_Init(EEPROM_Handle_t* pEEPROMHandler) {
+	EEPROM_Config_t* pConfig = &pEEPROMHandler->EEPROM_Config;
+
+	if (pConfig->PageSize == 0 || (pConfig->PageSize & (pConfig->PageSize - 1U)) != 0 ||
+		(pConfig->Size % pConfig->PageSize) != 0 ||
+		(pConfig->AddrSize != I2C_MEM_ADDR_SIZE_8BIT && pConfig->AddrSize != I2C_MEM_ADDR_SIZE_16BIT)) {
+		return EEPROM_ERR_CONFIG;
+	}
+
+	pEEPROMHandler->CachePage = 0;
+	pEEPROMHandler->DirtyStart = 0;
+	pEEPROMHandler->DirtyEnd = 0;
+	pEEPROMHandler->WriteBusy = SET;
+	return EEPROM_OK;
+}
+
+/*****************************************************
+ * @fn					- EEPROM_Read
+ *
+ * @brief				- Sequential read of any length
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- first byte address
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- One I2C transaction per device address block (256 bytes with
+ * 						  8-bit addressing, 64 KB with 16-bit addressing). The dirty
+ * 						  bytes of the cache are copied over the data of the device
+ */
+uint8_t EEPROM_Read(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pRxBuffer, uint32_t len) {
+	uint32_t dirtyStart = pEEPROMHandler->CachePage + pEEPROMHandler->DirtyStart;
+	uint32_t dirtyEnd = pEEPROMHandler->CachePage + pEEPROMHandler->DirtyEnd;
+	uint32_t start;
+	uint32_t end;
+	uint8_t status;
+
+	if (len > pEEPROMHandler->EEPROM_Config.Size ||
+		address > (pEEPROMHandler->EEPROM_Config.Size - len)) {
+		return EEPROM_ERR_RANGE;
+	}
+
+	status = readDevice(pEEPROMHandler, address, pRxBuffer, len);
+	if (status != EEPROM_OK) {
+		return status;
+	}
+
+	//Overlap of the read with the dirty range of the cache
+	start = (address > dirtyStart) ? address : dirtyStart;
+	end = ((address + len) < dirtyEnd) ? (address + len) : dirtyEnd;
+	if (start < end) {
+		memcpy(&pRxBuffer[start - address], &pEEPROMHandler->pCache[start - pEEPROMHandler->CachePage],
+			   end - start);
+	}
+	return EEPROM_OK;
+}
+
+/*****************************************************
+ * @fn					- EEPROM_Write
+ *
+ * @brief				- Write any length of data at any address
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- first byte address
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- The data is split on page boundaries (a page write wraps inside
+ * 						  the page). Without a cache one write cycle is started per page,
+ * 						  with a cache the data is merged into the cached page
+ */
+uint8_t EEPROM_Write(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pTxBuffer, uint32_t len) {
+	uint16_t pageSize = pEEPROMHandler->EEPROM_Config.PageSize;
+	uint32_t page;
+	uint16_t offset;
+	uint16_t chunk;
+	uint8_t status;
+
+	if (len > pEEPROMHandler->EEPROM_Config.Size ||
+		address > (pEEPROMHandler->EEPROM_Config.Size - len)) {
+		return EEPROM_ERR_RANGE;
+	}
+
+	while (len) {
+		page = address & ~((uint32_t) pageSize - 1U);
+		offset = (uint16_t) (address - page);
+		chunk = ((uint32_t) (pageSize - offset) < len) ? (pageSize - offset) : (uint16_t) len;
+
+		if (pEEPROMHandler->pCache == NULL) {
+			status = writeDevice(pEEPROMHandler, address, pTxBuffer, chunk);
+		} else {
+			status = cacheWrite(pEEPROMHandler, page, offset, pTxBuffer, chunk);
+		}
+		if (status != EEPROM_OK) {
+			return status;
+		}
+
+		address += chunk;
+		pTxBuffer += chunk;
+		len -= chunk;
+	}
+	return EEPROM_OK;
+}
+
+/*****************************************************
+ * @fn					- EEPROM_Flush
+ *
+ * @brief				- Write the dirty range of the cache to the device
+ *
+ * @param[in]			- EEPROM handle structure
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- Returns once the page write is sent, the write cycle itself
+ * 						  is waited for by the next access (or EEPROM_WaitReady)
+ */
+uint8_t EEPROM_Flush(EEPROM_Handle_t* pEEPROMHandler) {
+	uint16_t dirtyStart = pEEPROMHandler->DirtyStart;
+	uint16_t dirtyEnd = pEEPROMHandler->DirtyEnd;
+	uint8_t status;
+
+	if (dirtyStart == dirtyEnd) {
+		return EEPROM_OK;
+	}
+
+	status = writeDevice(pEEPROMHandler, pEEPROMHandler->CachePage + dirtyStart,
+						 &pEEPROMHandler->pCache[dirtyStart], dirtyEnd - dirtyStart);
+	if (status == EEPROM_OK) {
+		pEEPROMHandler->DirtyStart = 0;
+		pEEPROMHandler->DirtyEnd = 0;
+	}
+	return status;
+}
+
+/*****************************************************
+ * @fn					- EEPROM_WaitReady
+ *
+ * @brief				- Wait for the end of the write cycle by ACK polling
+ *
+ * @param[in]			- EEPROM handle structure
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_WRITE_TIMEOUT or I2C_ERR_xxx
+ * @note				- The device does not acknowledge its address during the write
+ * 						  cycle, so the wait lasts the actual tWR of the part instead
+ * 						  of a fixed worst case delay
+ */
+uint8_t EEPROM_WaitReady(EEPROM_Handle_t* pEEPROMHandler) {
+	uint32_t timeout = (RCC_GetHCLKFreq() / 1000000U) * EEPROM_WRITE_TIMEOUT_US;
+	uint32_t start = DWT_CYCCNT;
+	uint8_t status;
+
+	if (!pEEPROMHandler->WriteBusy) {
+		return EEPROM_OK;
+	}
+
+	while (1) {
+		status = I2C_IsDeviceReady(pEEPROMHandler->pI2CHandler, pEEPROMHandler->EEPROM_Config.DeviceAddress);
+		if (status == I2C_OK) {
+			pEEPROMHandler->WriteBusy = RESET;
+			return EEPROM_OK;
+		}
+		if (status != I2C_ERR_AF) {
+			return status;
+		}
+
+		pEEPROMHandler->Stats.Polls++;
+		if ((DWT_CYCCNT - start) > timeout) {
+			return EEPROM_ERR_WRITE_TIMEOUT;
+		}
+	}
+}
+
+/*****************************************************
+ * @fn					- deviceAddress
+ *
+ * @brief				- Device address of a byte address
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- byte address
+ *
+ * @return				- 7-bit device address
+ * @note				- The address bits above the address bytes go into the low bits
+ * 						  of the device address (24C04 to 24C16, 24M01, 24M02)
+ */
+static uint16_t deviceAddress(EEPROM_Handle_t* pEEPROMHandler, uint32_t address) {
+	return pEEPROMHandler->EEPROM_Config.DeviceAddress |
+		   (uint16_t) (address >> (8U * pEEPROMHandler->EEPROM_Config.AddrSize));
+}
+
+/*****************************************************
+ * @fn					- readDevice
+ *
+ * @brief				- Read the device, one transaction per device address block
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- first byte address
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- none
+ */
+static uint8_t readDevice(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pRxBuffer, uint32_t len) {
+	uint32_t blockSize = 1UL << (8U * pEEPROMHandler->EEPROM_Config.AddrSize);
+	uint32_t chunk;
+	uint8_t status;
+
+	status = EEPROM_WaitReady(pEEPROMHandler);
+
+	while (len && status == EEPROM_OK) {
+		chunk = blockSize - (address & (blockSize - 1U));
+		if (chunk > len) {
+			chunk = len;
+		}
+
+		status = I2C_MemRead(pEEPROMHandler->pI2CHandler, deviceAddress(pEEPROMHandler, address),
+							 (uint16_t) address, pEEPROMHandler->EEPROM_Config.AddrSize, pRxBuffer, chunk);
+
+		address += chunk;
+		pRxBuffer += chunk;
+		len -= chunk;
+	}
+	return status;
+}
+
+/*****************************************************
+ * @fn					- writeDevice
+ *
+ * @brief				- Page write to the device
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- first byte address
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len), inside a single page
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- The write cycle of the previous page is waited for first
+ */
+static uint8_t writeDevice(EEPROM_Handle_t* pEEPROMHandler, uint32_t address, uint8_t* pTxBuffer, uint32_t len) {
+	uint8_t status;
+
+	status = EEPROM_WaitReady(pEEPROMHandler);
+	if (status != EEPROM_OK) {
+		return status;
+	}
+
+	status = I2C_MemWrite(pEEPROMHandler->pI2CHandler, deviceAddress(pEEPROMHandler, address),
+						  (uint16_t) address, pEEPROMHandler->EEPROM_Config.AddrSize, pTxBuffer, len);
+	if (status != I2C_OK) {
+		return status;
+	}
+
+	pEEPROMHandler->WriteBusy = SET;
+	pEEPROMHandler->Stats.WriteCycles++;
+	pEEPROMHandler->Stats.BytesWritten += len;
+	return EEPROM_OK;
+}
+
+/*****************************************************
+ * @fn					- cacheWrite
+ *
+ * @brief				- Merge data of a single page into the write-back cache
+ *
+ * @param[in]			- EEPROM handle structure
+ * @param[in]			- page address
+ * @param[in]			- offset of the data in the page
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- EEPROM_OK, EEPROM_ERR_xxx or I2C_ERR_xxx
+ * @note				- The dirty range stays contiguous so that the flush is a single
+ * 						  page write: a hole between the dirty range and the new data is
+ * 						  filled with the current content of the device
+ */
+static uint8_t cacheWrite(EEPROM_Handle_t* pEEPROMHandler, uint32_t page, uint16_t offset,
+						  uint8_t* pTxBuffer, uint16_t len) {
+	uint8_t* pCache = pEEPROMHandler->pCache;
+	uint16_t end = offset + len;
+	uint8_t status = EEPROM_OK;
+
+	//Another page is dirty: write it out first
+	if (pEEPROMHandler->DirtyStart != pEEPROMHandler->DirtyEnd && pEEPROMHandler->CachePage != page) {
+		status = EEPROM_Flush(pEEPROMHandler);
+		if (status != EEPROM_OK) {
+			return status;
+		}
+	}
+
+	if (pEEPROMHandler->DirtyStart == pEEPROMHandler->DirtyEnd) {
+		pEEPROMHandler->CachePage = page;
+		pEEPROMHandler->DirtyStart = offset;
+		pEEPROMHandler->DirtyEnd = end;
+	} else {
+		if (offset > pEEPROMHandler->DirtyEnd) {
+			status = readDevice(pEEPROMHandler, page + pEEPROMHandler->DirtyEnd,
+								&pCache[pEEPROMHandler->DirtyEnd], offset - pEEPROMHandler->DirtyEnd);
+		} else if (end < pEEPROMHandler->DirtyStart) {
+			status = readDevice(pEEPROMHandler, page + end, &pCache[end], pEEPROMHandler->DirtyStart - end);
+		}
+		if (status != EEPROM_OK) {
+			return status;
+		}
+
+		if (offset < pEEPROMHandler->DirtyStart) {
+			pEEPROMHandler->DirtyStart = offset;
+		}
+		if (end > pEEPROMHandler->DirtyEnd) {
+			pEEPROMHandler->DirtyEnd = end;
+		}
+		pEEPROMHandler->Stats.CacheHits++;
+	}
+
+	memcpy(&pCache[offset], pTxBuffer, len);
+	return EEPROM_OK;
+}
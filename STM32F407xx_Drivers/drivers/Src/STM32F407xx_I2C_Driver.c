@@ -5,13 +5,11 @@
  *      Author: Donavan Tran
  */
 
-#include "../Inc/STM32F407xx_I2C_Driver.h"
+#include "../Inc/stm32f407xx.h"
 
 /*
  * Helper functions not accessible by the user application
  */
-static uint32_t getAPB1ClkFreq();
-static uint32_t getPLLClkFreq();
 static void generateStartCondition(I2C_Reg_t* pI2Cx);
 static void generateStopCondition(I2C_Reg_t* pI2Cx);
 static void clearFlagSB(I2C_Reg_t* pI2Cx);
@@ -21,10 +19,36 @@ static void ctrlBitACK(I2C_Reg_t* pI2Cx, uint8_t EnOrDi);
 static void ctrlBitPOS(I2C_Reg_t* pI2Cx, uint8_t EnOrDi);
 static void sendAddressToSlaveWrite(I2C_Reg_t* pI2Cs, uint8_t pSlaveAddress);
 static void sendAddressToSlaveRead(I2C_Reg_t* pI2Cs, uint8_t pSlaveAddress);
-static void singleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t repeatedStart);
-static void multipleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t len, uint8_t repeatedStart);
+static uint8_t singleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t repeatedStart);
+static uint8_t multipleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint32_t len, uint8_t repeatedStart);
 static void closeMasterTx(I2C_Handle_t* pI2CHandler);
 static void closeMasterRx(I2C_Handle_t* pI2CHandler);
+static uint8_t masterStartWrite(I2C_Handle_t* pI2CHandler, uint16_t pSlaveAddress);
+static uint8_t masterSendAddress(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint8_t read);
+static void sendAddressIT(I2C_Handle_t* pI2CHandler);
+static uint8_t sendMemAddress(I2C_Reg_t* pI2Cx, uint16_t memAddress, uint8_t memAddrSize);
+static void setMemAddress(I2C_Handle_t* pI2CHandler, uint16_t memAddress, uint8_t memAddrSize);
+static void abortMasterXfer(I2C_Handle_t* pI2CHandler);
+static void completeXfer(I2C_Handle_t* pI2CHandler, uint8_t appEvt);
+static void startNextXfer(I2C_Handle_t* pI2CHandler);
+static void startRxDMA(I2C_Handle_t* pI2CHandler);
+static void releaseDMA(I2C_Handle_t* pI2CHandler);
+static void dmaEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt);
+static void regMapWrite(I2C_RegMap_t* pRegMap, uint8_t data);
+static uint32_t usToCycles(uint32_t us);
+static void delayUs(uint32_t us);
+static uint8_t waitFlag(I2C_Reg_t* pI2Cx, uint32_t flag);
+static uint8_t masterStart(I2C_Handle_t* pI2CHandler);
+static uint8_t abortBlocking(I2C_Handle_t* pI2CHandler, uint8_t status);
+static void countError(I2C_Handle_t* pI2CHandler, uint8_t appEvt);
+static void setPinMode(GPIO_Reg_t* pGPIOx, uint8_t pinNumber, uint8_t mode);
+static uint8_t retryXfer(I2C_Handle_t* pI2CHandler);
+static uint32_t retryBackoff(I2C_Handle_t* pI2CHandler, uint8_t attempt);
+static uint8_t sendBytes(I2C_Reg_t* pI2Cx, uint8_t* pTxBuffer, uint32_t len);
+static uint8_t smbusWrite(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pHeader, uint8_t headerLen,
+						  uint8_t* pTxBuffer, uint32_t len, uint8_t stop);
+static uint8_t smbusRead(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pRxBuffer, uint8_t len,
+						 uint8_t* pBlockCount);
 
 /*****************************************************
  * @fn					- I2C_PeriClkCtrl
@@ -53,22 +77,23 @@ void I2C_PeriClkCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
  * @param[in]			- Handle Structure of I2C that contains all I2C configuration
  * 						  and port
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_TIMING_OK, or the @I2C_TIMING_STATUS error (bus timing left untouched)
+ * @note				- The bus timing follows the current PCLK1, call it again after
+ * 						  changing the clock tree
  */
-void I2C_Init(I2C_Handle_t* pI2CHandler) {
-
-
-
-
-	uint16_t ccr_value;
-	uint32_t APB1ClkFreq;
-	uint64_t temp;
-	temp = 0;
+uint8_t I2C_Init(I2C_Handle_t* pI2CHandler) {
+	I2C_Timing_t timing;
+	uint32_t tempreg;
+	uint8_t status;
 
 	//Enable the peripheral clock
 	I2C_PeriClkCtrl(pI2CHandler->pI2Cx, ENABLE);
 
+	//The step timeouts and the bus recovery count DWT cycles
+	if (!(DWT_CTRL & (1 << DWT_CTRL_CYCCNTENA))) {
+		DWT_CYCCNT_EN();
+	}
+
 	//Note: you may have the option for clock stretching, which
 	//enables the slave to pull the clock Low to slow down
 	//the communication. The clock stretching feature is one of the
@@ -76,65 +101,162 @@ void I2C_Init(I2C_Handle_t* pI2CHandler) {
 	//Clock stretching is enabled by default in slave mode. To disable it,
 	//configure the I2C_CR1 register bit 7.
 
-	//Select the peripheral clock frequency
-	//The other bits are ignored and set to 0 by default
-	APB1ClkFreq = getAPB1ClkFreq();
-	pI2CHandler->pI2Cx->CR2 |= (APB1ClkFreq / 1000000U) & 0x3F;
-	//I2C1->CR2 |= (APB1ClkFreq / 1000000U) & 0x3F;
-	//You may have option to configure the addressing mode in the I2C_OAR1
-	//register. However, we don't implement that as part of the configuration
-	//option in I2C. If you so wish to do it, implement that yourself!!!
-	pI2CHandler->pI2Cx->OAR1 |= (pI2CHandler->I2C_Config.DeviceAddress << 1) & 0xFF;
+	//Own address: 7-bit in OAR1[7:1], or 10-bit in OAR1[9:0] with ADDMODE
+	if (pI2CHandler->I2C_Config.AddressingMode == I2C_ADDR_MODE_10_BIT) {
+		tempreg = (1 << I2C_OAR1_ADDMODE) | ((pI2CHandler->I2C_Config.DeviceAddress & 0x3FFU) << I2C_OAR1_ADD);
+	} else {
+		tempreg = (pI2CHandler->I2C_Config.DeviceAddress << 1) & 0xFF;
+	}
 
 	//SPECIAL NOTE: Bit 14 of I2C_OAR1 register should be on kept at 1
 	//by the software. Reason: I don't know, figure it out if you can.
-	pI2CHandler->pI2Cx->OAR1 |= (1 << 14U);
-
-	//Configure the SCL clock frequencies depending on the mode
-	//standard mode/Fast mode and duty cycle bit
-	temp |= pI2CHandler->I2C_Config.SCLSpeed << I2C_CCR_F_S;
-	temp |= pI2CHandler->I2C_Config.FMDutyCycle << I2C_CCR_DUTY;
-
-	//Given: T(High) + T(Low) = T(I2C_SCL_SPEED)
-	//T_I2C_SCL_SPEED = (float) 1 / I2C_SCL_SPEED(pI2CHandler->I2C_Config.SCLSpeed);
-	//T_APB1ClkFreq	= (float) 1 / APB1ClkFreq;
-	if (pI2CHandler->pI2Cx->CCR & (1 << I2C_CCR_F_S)) { //Fast mode
-		if (pI2CHandler->pI2Cx->CCR & (1 << I2C_CCR_DUTY)) { //To reach 400khz
-
-			/*	Calculation: T(High) = 9 * CCR * T(PCLK1)
-			 *		   		 T(Low) = 16 * CCR * T(PCLK1)
-			 *			     T(High) + T(Low) = 25 * CCR * T(PCLK1)
-			 *			     CCR = (T(High) + T(Low)) / (25 * T(PCLK1))
-			 */
-			ccr_value = APB1ClkFreq / (25 * (I2C_SCL_SPEED(pI2CHandler->I2C_Config.SCLSpeed)));
-		} else { //To reach 100kHz
-
-			/*	Calculation: T(High) = 1 * CCR * T(PCLK1)
-			 *		   		 T(Low) = 2 * CCR * T(PCLK1)
-			 *			     T(High) + T(Low) = 3 * CCR * T(PCLK1)
-			 *			     CCR = (T(High) + T(Low)) / (3 * T(PCLK1))
-			 */
-			ccr_value = APB1ClkFreq / (3 * (I2C_SCL_SPEED(pI2CHandler->I2C_Config.SCLSpeed)));
+	tempreg |= (1 << 14U);
+	pI2CHandler->pI2Cx->OAR1 = tempreg;
+
+	//Second 7-bit own address (dual addressing, 7-bit mode only) and general call
+	if (pI2CHandler->I2C_Config.DualAddress != 0) {
+		pI2CHandler->pI2Cx->OAR2 = ((pI2CHandler->I2C_Config.DualAddress & 0x7FU) << I2C_OAR2_ADD2) | (1 << I2C_OAR2_ENDUAL);
+	} else {
+		pI2CHandler->pI2Cx->OAR2 = 0;
+	}
+	if (pI2CHandler->I2C_Config.GeneralCall == ENABLE) {
+		pI2CHandler->pI2Cx->CR1 |= (1 << I2C_CR1_ENGC);
+	} else {
+		pI2CHandler->pI2Cx->CR1 &= ~(1 << I2C_CR1_ENGC);
+	}
+
+	//SMBus mode and PEC. The PEC (CRC-8) is computed by the peripheral over
+	//every byte of the transfer, address bytes included
+	pI2CHandler->pI2Cx->CR1 &= ~((1 << I2C_CR1_SMBUS) | (1 << I2C_CR1_SMBTYPE) | (1 << I2C_CR1_ENPEC));
+	if (pI2CHandler->I2C_Config.BusMode != I2C_BUS_I2C) {
+		pI2CHandler->pI2Cx->CR1 |= (1 << I2C_CR1_SMBUS);
+		if (pI2CHandler->I2C_Config.BusMode == I2C_BUS_SMBUS_HOST) {
+			pI2CHandler->pI2Cx->CR1 |= (1 << I2C_CR1_SMBTYPE);
 		}
-	} else { //Standard Mode
+	}
+	if (pI2CHandler->I2C_Config.PECControl == ENABLE) {
+		pI2CHandler->pI2Cx->CR1 |= (1 << I2C_CR1_ENPEC);
+	}
+
+	//Compute FREQ, CCR and TRISE from the actual PCLK1 and check them against
+	//the I2C specification, see I2C_ComputeTiming for the calculation
+	status = I2C_ComputeTiming(RCC_GetPCLK1Freq(), pI2CHandler->I2C_Config.SCLSpeed,
+							   pI2CHandler->I2C_Config.FMDutyCycle, &timing);
+	if (status != I2C_TIMING_OK) {
+		return status;
+	}
+
+	//Select the peripheral clock frequency
+	//The other bits are ignored and set to 0 by default
+	pI2CHandler->pI2Cx->CR2 = (pI2CHandler->pI2Cx->CR2 & ~(0x3F << I2C_CR2_FREQ)) | (timing.Freq << I2C_CR2_FREQ);
+
+	//CCR and TRISE can only be written while the peripheral is disabled (PE = 0)
+	pI2CHandler->pI2Cx->CCR = timing.CCR;
+	pI2CHandler->pI2Cx->TRISE = timing.TRise;
+
+	return I2C_TIMING_OK;
+}
+
+/*****************************************************
+ * @fn					- I2C_ComputeTiming
+ *
+ * @brief				- Compute the FREQ, CCR and TRISE values of an SCL frequency
+ *
+ * @param[in]			- PCLK1 frequency in Hz
+ * @param[in]			- SCL frequency in Hz (up to 400 kHz, fast mode above 100 kHz)
+ * @param[in]			- fast mode duty cycle @I2C_DUTY_CYCLE
+ * @param[out]			- timing structure, SCLActual is the achieved SCL frequency
+ *
+ * @return				- @I2C_TIMING_STATUS
+ * @note				- CCR is rounded up so the bus never runs faster than asked,
+ * 						  then stretched until tLOW/tHIGH meet the I2C specification.
+ * 						  Sm: T(High) = CCR * T(PCLK1),		T(Low) = CCR * T(PCLK1)
+ * 						  Fm: T(High) = CCR * T(PCLK1),		T(Low) = 2 * CCR * T(PCLK1)
+ * 						  Fm 16/9: T(High) = 9 * CCR * T(PCLK1),	T(Low) = 16 * CCR * T(PCLK1)
+ */
+uint8_t I2C_ComputeTiming(uint32_t pclk1, uint32_t sclSpeed, uint8_t dutyCycle, I2C_Timing_t* pTiming) {
+	uint32_t freq = pclk1 / 1000000U;
+	uint32_t low, high, ccr, ccrMin, tLowMin, tHighMin, tRise;
+	uint8_t fastMode = (sclSpeed > I2C_SCL_SPEED_SM);
+
+	memset(pTiming, 0, sizeof(I2C_Timing_t));
+
+	if (sclSpeed == 0 || sclSpeed > I2C_SCL_SPEED_FM) {
+		return I2C_TIMING_ERR_SPEED;
+	}
+	if (freq < I2C_PCLK1_MIN_MHZ || freq > I2C_PCLK1_MAX_MHZ || (fastMode && freq < I2C_PCLK1_MIN_FM_MHZ)) {
+		return I2C_TIMING_ERR_PCLK;
+	}
+
+	//Number of CCR periods in the low and high phases of SCL
+	if (!fastMode) {
+		low = 1U; high = 1U; ccrMin = 4U;
+		tLowMin = I2C_T_LOW_SM_NS; tHighMin = I2C_T_HIGH_SM_NS; tRise = I2C_T_RISE_SM_NS;
+	} else if (dutyCycle == I2C_FM_DUTY_16_9) {
+		low = 16U; high = 9U; ccrMin = 1U;
+		tLowMin = I2C_T_LOW_FM_NS; tHighMin = I2C_T_HIGH_FM_NS; tRise = I2C_T_RISE_FM_NS;
+	} else {
+		low = 2U; high = 1U; ccrMin = 1U;
+		tLowMin = I2C_T_LOW_FM_NS; tHighMin = I2C_T_HIGH_FM_NS; tRise = I2C_T_RISE_FM_NS;
+	}
+
+	ccr = (pclk1 + ((low + high) * sclSpeed) - 1U) / ((low + high) * sclSpeed);
+	if (ccr < ccrMin) {
+		ccr = ccrMin;
+	}
+	while (((uint64_t) low * ccr * 1000000000U) < ((uint64_t) tLowMin * pclk1) ||
+		   ((uint64_t) high * ccr * 1000000000U) < ((uint64_t) tHighMin * pclk1)) {
+		ccr++;
+	}
+	if (ccr > 0xFFFU) {
+		return I2C_TIMING_ERR_RANGE;
+	}
 
-		/*	Calculation: T(High) = CCR * T(PCLK1)
-		 *		   		 T(Low) =   CCR * T(PCLK1)
-		 *			     T(High) + T(Low) = 2 * CCR * T(PCLK1)
-		 *			     CCR = (T(High) + T(Low)) / (2 * T(PCLK1))
-		 */
-		ccr_value = APB1ClkFreq / (2 * (I2C_SCL_SPEED(pI2CHandler->I2C_Config.SCLSpeed)));
+	pTiming->Freq = (uint8_t) freq;
+	pTiming->CCR = (uint16_t) ccr;
+	if (fastMode) {
+		pTiming->CCR |= (1 << I2C_CCR_F_S);
+		if (dutyCycle == I2C_FM_DUTY_16_9) {
+			pTiming->CCR |= (1 << I2C_CCR_DUTY);
+		}
 	}
-	temp |= (ccr_value & 0xFFF);
-	pI2CHandler->pI2Cx->CCR = temp;
 
-	//Clear the TRISE reg
-	pI2CHandler->pI2Cx->TRISE &= ~((int) 1);
+	//TRISE = maximum rise time in PCLK1 periods + 1
+	pTiming->TRise = (uint8_t) (((freq * tRise) / 1000U) + 1U);
+
+	pTiming->SCLActual = pclk1 / ((low + high) * ccr);
+	pTiming->TLowNs = (uint32_t) (((uint64_t) low * ccr * 1000000000U) / pclk1);
+	pTiming->THighNs = (uint32_t) (((uint64_t) high * ccr * 1000000000U) / pclk1);
+
+	return I2C_TIMING_OK;
+}
 
-	//Configure the Rise Time (TRISE)
-	temp = APB1ClkFreq * (I2C_T_RISE(pI2CHandler->I2C_Config.SCLSpeed)) / (10000000U);
-	pI2CHandler->pI2Cx->TRISE = (temp + 1) & 0x3F;
+/*****************************************************
+ * @fn					- I2C_GetSCLSpeed
+ *
+ * @brief				- SCL frequency programmed in the peripheral
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- SCL frequency in Hz (0 if CCR is not configured)
+ * @note				- Computed from CCR and the current PCLK1, rise/fall times not included
+ */
+uint32_t I2C_GetSCLSpeed(I2C_Reg_t* pI2Cx) {
+	uint32_t ccrReg = pI2Cx->CCR;
+	uint32_t ccr = ccrReg & 0xFFFU;
+	uint32_t periods;
 
+	if (ccr == 0) {
+		return 0;
+	}
+	if (!(ccrReg & (1 << I2C_CCR_F_S))) {
+		periods = 2U;
+	} else if (ccrReg & (1 << I2C_CCR_DUTY)) {
+		periods = 25U;
+	} else {
+		periods = 3U;
+	}
+	return RCC_GetPCLK1Freq() / (periods * ccr);
 }
 
 /*****************************************************
@@ -148,13 +270,7 @@ void I2C_Init(I2C_Handle_t* pI2CHandler) {
  * @note				- The implementation so far only covers only 3 I2C ports
  */
 void I2C_DeInit(I2C_Reg_t* pI2Cx) {
-	if (pI2Cx == I2C1) {
-		I2C1_PCLK_RST();
-	} else if (pI2Cx == I2C2) {
-		I2C2_PCLK_RST();
-	} else {
-		I2C3_PCLK_RST();
-	}
+	RCC_PeriphReset(pI2Cx);
 }
 
 /*****************************************************
@@ -190,12 +306,13 @@ void I2C_PeripheralEnable(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
  * @param[in]			- slave address
  * @param[in]			- repeated start condition set or reset
  *
- * @return				- none
+ * @return				- I2C_OK or I2C_ERR_xxx (the bus is released on error)
  * @note				- See the Transfer Sequence diagram for master transmitter on page 849
  * 						  in MCU Reference Manual for more details
  */
-void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
-		                uint32_t len, uint8_t pSlaveAddress, uint8_t repeatedStart) {
+uint8_t I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
+		                uint32_t len, uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t status;
 
     // Activate the Start condition
     // Note: Setting the START bit causes the interface to generate
@@ -203,22 +320,22 @@ void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
     //	  	the BUSY bit is cleared.
     //	  	This also set the SB bit by hardware (see I2C_SR1 register for details)
     //      You may also need to enable the I2C_CR1 PE register
-	generateStartCondition(pI2CHandler->pI2Cx);
-
 	// Poll until the SB bit in SR1 register is set
 	// This is important if any of the bit is set by HARDWARE
-	while (!I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_SB));
+	status = masterStart(pI2CHandler);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
 
 	// Clear the SB bit by reading SR1 register followed by
 	// writing DR register with Address. If SB bit not clear,
 	// SCL will be pulled low and the transmission is delay (which
 	// we don't want, obviously)
-	clearFlagSB(pI2CHandler->pI2Cx);
-	sendAddressToSlaveWrite(pI2CHandler->pI2Cx, pSlaveAddress);
-
-
-	//Polling until the ADDR bit is set
-	while (!I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_ADDR));
+	//Then poll until the ADDR bit is set (a NACK of the address sets AF instead)
+	status = masterSendAddress(pI2CHandler, pSlaveAddress, RESET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
 
 	//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
 	//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
@@ -231,7 +348,10 @@ void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
 
 		//Polling until the Transmit register buffer is empty (TXE = 1)
 		//Then write first data into DR
-		while (!I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_TXE));
+		status = waitFlag(pI2CHandler->pI2Cx, I2C_FLAG_SR1_TXE);
+		if (status != I2C_OK) {
+			return abortBlocking(pI2CHandler, status);
+		}
 
 		//Write TxBuffer into DR
 		pI2CHandler->pI2Cx->DR = *pTxBuffer;
@@ -239,9 +359,11 @@ void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
 		pTxBuffer++;
 	}
 
-	//Wait for both TXE and BTF is set before closing the communication
-	while (!(I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_BTF) &&
-			 I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_TXE)));
+	//Wait for BTF before closing the communication (BTF implies TXE in transmission)
+	status = waitFlag(pI2CHandler->pI2Cx, I2C_FLAG_SR1_BTF);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
 
 	//When Repeated Start condition is enabled, master halts generating the stop
 	//condition and continues the transaction.
@@ -253,7 +375,8 @@ void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
 		//Generate the Stop condition to terminate the communication automatically clears the BTF bit
 		generateStopCondition(pI2CHandler->pI2Cx);
 	}
-	//Memo: Cover the 10-bit addressing mode scenario later
+
+	return I2C_OK;
 }
 
 /*****************************************************
@@ -266,931 +389,2687 @@ void I2C_MasterSendData(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer,
  * @param[in]			- length of the buffer (len)
  * @param[in]			- slave address
  *
- * @return				- none
+ * @return				- I2C_OK or I2C_ERR_xxx (the bus is released on error)
  * @note				- See the Transfer Sequence diagram for master recevier on page 850
  * 						  in MCU Reference Manual for more details
  */
-void I2C_MasterReceiveData(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer,
-		                uint32_t len, uint8_t pSlaveAddress, uint8_t repeatedStart) {
+uint8_t I2C_MasterReceiveData(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer,
+		                uint32_t len, uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t status;
 
 	//Generate a start condition
-	generateStartCondition(pI2CHandler->pI2Cx);
-
 	// Poll until the SB bit in SR1 register is set
 	// This is important if any of the bit is set by HARDWARE
-	while (!I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_SB));
+	status = masterStart(pI2CHandler);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
 
 	// Clear the SB bit by reading SR1 register followed by
 	// writing DR register with Address. If SB bit not clear,
 	// SCL will be pulled low and the transmission is delay (which
 	// we don't want, obviously)
-	clearFlagSB(pI2CHandler->pI2Cx);
-	sendAddressToSlaveRead(pI2CHandler->pI2Cx, pSlaveAddress);
-
-	//Polling until the ADDR bit is set
-	while (!I2C_CheckStatusFlag(&pI2CHandler->pI2Cx->SR1, I2C_FLAG_SR1_ADDR));
+	//Then poll until the ADDR bit is set (a NACK of the address sets AF instead)
+	status = masterSendAddress(pI2CHandler, pSlaveAddress, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
 
 	if (len > 1) {
 		//Handle len > 2 bytes reception
-		multipleDataRecepHandler(pI2CHandler->pI2Cx, pRxBuffer, len, repeatedStart);
+		status = multipleDataRecepHandler(pI2CHandler->pI2Cx, pRxBuffer, len, repeatedStart);
 	} else {
 		//Handle single data byte reception
-		singleDataRecepHandler(pI2CHandler->pI2Cx, pRxBuffer, repeatedStart);
+		status = singleDataRecepHandler(pI2CHandler->pI2Cx, pRxBuffer, repeatedStart);
 	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+
+	//POS only applies to the 2-byte reception, it would shift the ACK of the next one
+	ctrlBitPOS(pI2CHandler->pI2Cx, DISABLE);
 
 	//Re-enable the ACK
 	if (pI2CHandler->I2C_Config.ACKControl == ENABLE) {
 		ctrlBitACK(pI2CHandler->pI2Cx, ENABLE);
 	}
+
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_SlaveSendData
+ * @fn					- I2C_MemWrite
  *
- * @brief				- send request for data from slave to master
+ * @brief				- Write data into a register (memory location) of the slave
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- 1 byte data
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
  *
- * @return				- none
- * @note				- See the Transfer Sequence diagram for master recevier on page 850
- * 						  in MCU Reference Manual for more details
+ * @return				- I2C_OK or I2C_ERR_xxx (the bus is released on error)
+ * @note				- START, address+W, register address (MSB first), data, STOP.
+ * 						  The register address and the data share one transaction
+ * 						  without copying them into a single buffer
  */
-void I2C_SlaveSendData(I2C_Reg_t* pI2Cx, uint8_t data) {
-	//Write data to specific I2C peripheral data  register
-	pI2Cx->DR = data;
+uint8_t I2C_MemWrite(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+				  uint8_t memAddrSize, uint8_t* pTxBuffer, uint32_t len) {
+	uint8_t status;
+
+	status = masterStartWrite(pI2CHandler, slaveAddress);
+	if (status == I2C_OK) {
+		status = sendMemAddress(pI2CHandler->pI2Cx, memAddress, memAddrSize);
+	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+
+	while (len) {
+		status = waitFlag(pI2CHandler->pI2Cx, I2C_FLAG_SR1_TXE);
+		if (status != I2C_OK) {
+			return abortBlocking(pI2CHandler, status);
+		}
+		pI2CHandler->pI2Cx->DR = *pTxBuffer;
+		len--;
+		pTxBuffer++;
+	}
+
+	//Wait for BTF before closing the communication
+	status = waitFlag(pI2CHandler->pI2Cx, I2C_FLAG_SR1_BTF);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+
+	generateStopCondition(pI2CHandler->pI2Cx);
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_SlaveReceiveData
+ * @fn					- I2C_MemRead
  *
- * @brief				- Receive the data from slave to master
+ * @brief				- Read data from a register (memory location) of the slave
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len)
  *
- * @return				- 1 byte unsigned integer
- * @note				- See the Transfer Sequence diagram for master recevier on page 850
- * 						  in MCU Reference Manual for more details
+ * @return				- I2C_OK or I2C_ERR_xxx (the bus is released on error)
+ * @note				- START, address+W, register address (MSB first), repeated START,
+ * 						  address+R, data, STOP. The bus is never released in between,
+ * 						  so no other master can slip in before the read
  */
-uint8_t I2C_SlaveReceiveData(I2C_Reg_t* pI2Cx) {
-	return (uint8_t) pI2Cx->DR;
+uint8_t I2C_MemRead(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+				 uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len) {
+	uint8_t status;
+
+	status = masterStartWrite(pI2CHandler, slaveAddress);
+	if (status == I2C_OK) {
+		status = sendMemAddress(pI2CHandler->pI2Cx, memAddress, memAddrSize);
+	}
+
+	//The register address must be fully shifted out before the repeated start
+	if (status == I2C_OK) {
+		status = waitFlag(pI2CHandler->pI2Cx, I2C_FLAG_SR1_BTF);
+	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+
+	//Setting START while the master owns the bus generates the repeated start
+	return I2C_MasterReceiveData(pI2CHandler, pRxBuffer, len, slaveAddress, I2C_SR_RESET);
 }
 
 /*****************************************************
- * @fn					- I2C_CheckStatusFlag
+ * @fn					- I2C_IsDeviceReady
  *
- * @brief				- Check the status of the given flag in either SR1 or SR2 register
+ * @brief				- Check whether a slave acknowledges its address
  *
- * @param[in]			- address of status register of specific I2C peripherals
- * @param[in]			- the status flag
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_OK (ACK), I2C_ERR_AF (NACK) or the I2C_ERR_xxx of the bus
+ * @note				- No data byte is sent: the ADDR flag is cleared and the STOP
+ * 						  follows at once. A NACK is the normal answer of a device busy
+ * 						  with an internal write cycle, it is not counted in the statistics
  */
-uint8_t I2C_CheckStatusFlag(__vo uint32_t* statusReg, uint16_t flag) {
-	if ((*statusReg) & flag) {
-		return FLAG_SET;
+uint8_t I2C_IsDeviceReady(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint8_t status;
+
+	status = masterStart(pI2CHandler);
+	if (status == I2C_OK) {
+		status = masterSendAddress(pI2CHandler, slaveAddress, RESET);
 	}
-	return FLAG_RESET;
+
+	if (status == I2C_ERR_AF) {
+		generateStopCondition(pI2Cx);
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_AF;
+		return I2C_ERR_AF;
+	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+
+	clearFlagADDR(pI2Cx);
+	generateStopCondition(pI2Cx);
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_IRQITConfig
+ * @fn					- I2C_BusRecovery
  *
- * @brief				- I2C Interrupt configuration
+ * @brief				- Free a bus held low by a slave, then reset the peripheral
  *
- * @param[in]			- IRQ Number of the I2C interrupt peripheral
- * @param[in]			= ENABLE or DISABLE macro
+ * @param[in]			- I2C handle structure
  *
- * @return				- none
- * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ * @return				- I2C_OK or I2C_ERR_BUS_STUCK
+ * @note				- A slave interrupted in the middle of a read keeps driving SDA
+ * 						  low until it has shifted out its byte: SCL is clocked as an
+ * 						  open-drain GPIO (up to 9 clocks, about 100 us) until SDA is
+ * 						  released, then a STOP resets the state machine of every slave.
+ * 						  Without pSCLPort/pSDAPort only the peripheral is reset
  */
-void I2C_IRQITConfig(uint8_t IRQNumber, uint8_t EnOrDi) {
-	//In order to trigger the interrupt on the processor side,
-	//configuration enable on the ISER of the NVIC is needed
-	//Note: There are 7 different NVIC_ISER and NVIC_ICER register
-	//at certain range
-	uint32_t indx, remainder;
-	indx = IRQNumber >> 5U; //Index to configure the correct NVIC_ISER
-	if (indx >= 0U  && indx <= 7U) {
-		remainder = IRQNumber & (~(~(int)0 << 5U)); //find the remainder
-		if (EnOrDi) {
-			NVIC_ISER(indx) |= 1 << remainder; //See NVIC_ISER(__INDEX__) declaration for more implementation details
-		} else {
-			NVIC_ICER(indx) |= 1 << remainder; //See NVIC_ICER(__INDEX__) declaration for more implementation details
+uint8_t I2C_BusRecovery(I2C_Handle_t* pI2CHandler) {
+	GPIO_Reg_t* pSCLPort = pI2CHandler->pSCLPort;
+	GPIO_Reg_t* pSDAPort = pI2CHandler->pSDAPort;
+	uint8_t sclPin = pI2CHandler->SCLPin;
+	uint8_t sdaPin = pI2CHandler->SDAPin;
+	uint8_t status = I2C_OK;
+	uint8_t clocks;
+	GPIO_PortState_t sclState, sdaState;
+
+	if (pSCLPort != NULL && pSDAPort != NULL) {
+		pI2CHandler->Stats.Recovery++;
+		GPIO_SaveState(pSCLPort, &sclState);
+		GPIO_SaveState(pSDAPort, &sdaState);
+
+		//The peripheral lets go of the lines once disabled
+		pI2CHandler->pI2Cx->CR1 &= ~(1 << I2C_CR1_PE);
+
+		//Take over the pins as released open-drain outputs (the AF number is kept)
+		pSCLPort->BSRR = (1 << sclPin);
+		pSDAPort->BSRR = (1 << sdaPin);
+		pSCLPort->OTYPER |= (1 << sclPin);
+		pSDAPort->OTYPER |= (1 << sdaPin);
+		setPinMode(pSCLPort, sclPin, GPIO_OUTPUT_MODE);
+		setPinMode(pSDAPort, sdaPin, GPIO_OUTPUT_MODE);
+		delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+
+		//Clock SCL until the slave releases SDA (8 data bits and the ACK at most)
+		for (clocks = 0; clocks < I2C_RECOVERY_CLOCKS && !(pSDAPort->IDR & (1 << sdaPin)); clocks++) {
+			pSCLPort->BSRR = (1 << (sclPin + 16));
+			delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+			pSCLPort->BSRR = (1 << sclPin);
+			delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		}
+
+		//STOP condition: SDA rises while SCL is high
+		pSCLPort->BSRR = (1 << (sclPin + 16));
+		delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		pSDAPort->BSRR = (1 << (sdaPin + 16));
+		delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		pSCLPort->BSRR = (1 << sclPin);
+		delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		pSDAPort->BSRR = (1 << sdaPin);
+		delayUs(I2C_RECOVERY_HALF_PERIOD_US);
+
+		if (!(pSDAPort->IDR & (1 << sdaPin)) || !(pSCLPort->IDR & (1 << sclPin))) {
+			status = I2C_ERR_BUS_STUCK;
 		}
+
+		//Hand the pins back to the peripheral with their configuration of before
+		GPIO_RestoreState(pSCLPort, &sclState, (uint16_t) (1U << sclPin));
+		GPIO_RestoreState(pSDAPort, &sdaState, (uint16_t) (1U << sdaPin));
+	}
+
+	//The glitches on the lines can leave BUSY set: only SWRST clears it
+	I2C_SoftwareReset(pI2CHandler);
+
+	if (pI2CHandler->pI2Cx->SR2 & I2C_FLAG_SR2_BUSY) {
+		status = I2C_ERR_BUS_STUCK;
 	}
+	return status;
 }
 
 /*****************************************************
- * @fn					- I2C_IRQPriorityConfig
+ * @fn					- I2C_SoftwareReset
  *
- * @brief				- I2C Interrupt Priority Configuration
+ * @brief				- Reset the I2C peripheral with SWRST and restore its configuration
  *
- * @param[in]			- IRQ number of the I2C interrupt peripheral
- * @param[in]			= The priority value of that I2C interrupt peripheral
+ * @param[in]			- I2C handle structure
  *
  * @return				- none
- * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ * @note				- SWRST clears every register and the stuck BUSY flag: the timing
+ * 						  and own address are written again by I2C_Init, then the
+ * 						  interrupt enables are restored and the peripheral is enabled.
+ * 						  A transfer in progress is lost
  */
-void I2C_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriorityValue) {
-	uint32_t indx = IRQNumber >> 2U; //Note: There are IRQ Priority field in each IPR register
-	uint32_t remainder = IRQNumber & (~(~(int)0 << 2U));
-	uint32_t shift_amount = (remainder * 8U) + IMPLEMENTED_IRQ_PRIORITY_BIT;
+void I2C_SoftwareReset(I2C_Handle_t* pI2CHandler) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint32_t itEnable;
 
-	//Configure the IRQ_PR register
-	NVIC_IPR(indx) |= IRQPriorityValue << shift_amount;
+	pI2CHandler->Stats.Reset++;
+
+	//The slave mode keeps the interrupts on between transfers
+	itEnable = pI2Cx->CR2 & ((1 << I2C_CR2_ITBUFEN) | (1 << I2C_CR2_ITEVTEN) | (1 << I2C_CR2_ITERREN));
+
+	pI2Cx->CR1 |= (1 << I2C_CR1_SWRST);
+	pI2Cx->CR1 &= ~(1 << I2C_CR1_SWRST);
+
+	I2C_Init(pI2CHandler);
+	pI2Cx->CR2 |= itEnable;
+	I2C_PeripheralEnable(pI2Cx, ENABLE);
+	if (pI2CHandler->I2C_Config.ACKControl != ENABLE) {
+		ctrlBitACK(pI2Cx, DISABLE);
+	}
 }
 
 /*****************************************************
- * @fn					- I2C_MasterSendDataIT()
+ * @fn					- I2C_CheckTimeout
  *
- * @brief				- I2C Interrupt Priority Configuration
+ * @brief				- Abort an interrupt/DMA master transfer that runs for too long
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- buffer for transmission (TxBuffer)
- * @param[in]			- length of the buffer (len)
- * @param[in]			- slave address
- * @param[in]			- repeated start condition set or reset
+ * @param[in]			- I2C handle structure
+ * @param[in]			- longest duration of a transfer in microseconds
  *
- * @return				- I2C current state
- * @note				- This is the non-blocking API
+ * @return				- I2C_OK or I2C_ERR_TIMEOUT (the transfer was aborted)
+ * @note				- Call it periodically (main loop, SysTick). The transfer ends with
+ * 						  I2C_ERR_TIMEOUT to its callback after the bus recovery, and the
+ * 						  next queued transaction is started
  */
-uint8_t I2C_MasterSendDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
-						uint8_t pSlaveAddress, uint8_t repeatedStart) {
-	uint8_t state;
-	state = pI2CHandler->TxRxState;
-
-	//Since I2C bus is bidirectional, only transmit when the bus is in ready state
-	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+uint8_t I2C_CheckTimeout(I2C_Handle_t* pI2CHandler, uint32_t timeoutUs) {
+	uint32_t primask;
+
+	ENTER_CRITICAL(primask);
+	if (pI2CHandler->TxRxState == I2C_READY ||
+		(DWT_CYCCNT - pI2CHandler->XferStart) < usToCycles(timeoutUs)) {
+		EXIT_CRITICAL(primask);
+		return I2C_OK;
+	}
 
-		//Storing the arguments globally in the I2C Handle structure
-		pI2CHandler->TxLen = len;
-		pI2CHandler->pTxBuffer = pTxBuffer;
-		pI2CHandler->DeviceAddr = pSlaveAddress;
-		pI2CHandler->RepeatedStart = repeatedStart;
+	//Stop the interrupts first so the ISR cannot step in during the recovery
+	abortMasterXfer(pI2CHandler);
+	countError(pI2CHandler, I2C_ERR_TIMEOUT);
+	EXIT_CRITICAL(primask);
 
-		//Mark the I2C bus as busy in transmitting so that other master
-		//cannot take over the same bus (avoid arbitration error)
-		pI2CHandler->TxRxState = I2C_BUSY_IN_TX;
+	I2C_BusRecovery(pI2CHandler);
+	completeXfer(pI2CHandler, I2C_ERR_TIMEOUT);
+	return I2C_ERR_TIMEOUT;
+}
 
-		//Generate the Start condition
-		generateStartCondition(pI2CHandler->pI2Cx);
+/*****************************************************
+ * @fn					- I2C_SMBusQuickCommand
+ *
+ * @brief				- SMBus Quick Command: address with the write bit, then STOP
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx (I2C_ERR_AF: no device at this address)
+ * @note				- The read variant needs a master that stops before the first
+ * 						  data byte, which this peripheral cannot do
+ */
+uint8_t I2C_SMBusQuickCommand(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress) {
+	uint8_t status;
 
-		//Enable the event interrupt control bit for transmitting
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
+	status = smbusWrite(pI2CHandler, slaveAddress, NULL, 0, NULL, 0, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-		//Enable the event interrupt control bit
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+/*****************************************************
+ * @fn					- I2C_SMBusSendByte
+ *
+ * @brief				- SMBus Send Byte: one data byte without command code
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- data byte
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+uint8_t I2C_SMBusSendByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t data) {
+	uint8_t status;
 
-		//Enable the error interrupt control bit to inform
-		//the error back the user application, which is one of the main responsibily
-		//for writing the driver
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	status = smbusWrite(pI2CHandler, slaveAddress, &data, 1, NULL, 0, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
 	}
-
-	return state;
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_MasterReceiveDataIT
+ * @fn					- I2C_SMBusReceiveByte
  *
- * @brief				- Non-blocking implementation of the i2C Master Receive data using interrupt
+ * @brief				- SMBus Receive Byte: one data byte without command code
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- buffer for transmission (TxBuffer)
- * @param[in]			- length of the buffer (len)
+ * @param[in]			- I2C handle structure
  * @param[in]			- slave address
- * @param[in]			- repeated start condition set or reset
+ * @param[out]			- data byte
  *
- * @return				- I2C current state
- * @note				- This is the non-blocking API
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
  */
-uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
-		 	 	 	 	     uint8_t pSlaveAddress, uint8_t repeatedStart) {
-	uint8_t state;
-	state = pI2CHandler->TxRxState;
-
-	//check to see whether device is in ready state
-	if (state != I2C_BUSY_IN_RX && state != I2C_BUSY_IN_TX) {
+uint8_t I2C_SMBusReceiveByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pData) {
+	uint8_t status;
 
-		//Transfer device information to the I2C Handle structure
-		pI2CHandler->RxLen = len;
-		pI2CHandler->pRxBuffer = pRxBuffer;
-		pI2CHandler->RxSize	   = len;
-		pI2CHandler->DeviceAddr = pSlaveAddress;
-		pI2CHandler->RepeatedStart = repeatedStart;
-
-		//Mark the current state as busy in transmitting
-		//Note: in I2C, the BUSY bit is set and clear by hardware
-		//automaticallly. Thus, to keep track of the current state,
-		//it's best to define the state macros
-		pI2CHandler->TxRxState = I2C_BUSY_IN_RX;
+	status = smbusRead(pI2CHandler, slaveAddress, pData, 1, NULL);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-		//Generate the start condition
-		generateStartCondition(pI2CHandler->pI2Cx);
+/*****************************************************
+ * @fn					- I2C_SMBusWriteByte
+ *
+ * @brief				- SMBus Write Byte: command code and one data byte
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[in]			- data byte
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+uint8_t I2C_SMBusWriteByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint8_t data) {
+	uint8_t frame[2] = { command, data };
+	uint8_t status;
 
-		//Enable the event interrupt control bit for receiving data
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
+	status = smbusWrite(pI2CHandler, slaveAddress, frame, 2, NULL, 0, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-		//Enable the event interrupt control bit
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+/*****************************************************
+ * @fn					- I2C_SMBusReadByte
+ *
+ * @brief				- SMBus Read Byte: command code, repeated start, one data byte
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[out]			- data byte
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+uint8_t I2C_SMBusReadByte(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint8_t* pData) {
+	uint8_t status;
 
-		//Enable the error interrupt control bit in the event
-		//that error such as overrrun occurs in data reception
-		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	status = smbusWrite(pI2CHandler, slaveAddress, &command, 1, NULL, 0, RESET);
+	if (status == I2C_OK) {
+		status = smbusRead(pI2CHandler, slaveAddress, pData, 1, NULL);
 	}
-	return state;
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_EV_IRQHandling
+ * @fn					- I2C_SMBusWriteWord
  *
- * @brief				- This function provides handle implementaions for all I2C event interrupts
+ * @brief				- SMBus Write Word: command code and 16-bit data, low byte first
  *
- * @param[in]			- I2C Handle structure
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[in]			- data word
  *
- * @return				- none
- * @note				- In this function, you need to cover the case for both master AND slave
- *						  since I2C is half-duplex in STM32
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
  */
-void I2C_EV_IRQHandling(I2C_Handle_t* pI2CHandler) {
-	//Interrupt handling for both master and slave mode of a device
+uint8_t I2C_SMBusWriteWord(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint16_t data) {
+	uint8_t frame[3] = { command, (uint8_t) data, (uint8_t) (data >> 8) };
+	uint8_t status;
 
-		uint32_t temp, temp1, temp2;
-		I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	status = smbusWrite(pI2CHandler, slaveAddress, frame, 3, NULL, 0, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-		//Check status of the event interrupt control bit
-		temp1 = (pI2Cx->CR2 & (1 << I2C_CR2_ITBUFEN)) >> I2C_CR2_ITBUFEN;
-		temp2 = (pI2Cx->CR2 & (1 << I2C_CR2_ITEVTEN)) >> I2C_CR2_ITEVTEN;
+/*****************************************************
+ * @fn					- I2C_SMBusReadWord
+ *
+ * @brief				- SMBus Read Word: command code, repeated start, 16-bit data
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[out]			- data word (received low byte first)
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+uint8_t I2C_SMBusReadWord(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command, uint16_t* pData) {
+	uint8_t word[2];
+	uint8_t status;
 
-/****************************************SB_EVENT_INTERRUPT*****************************************/
-		temp  = pI2CHandler->pI2Cx->SR1 & ( 1 << I2C_SR1_SB);
-		//1. Handle For interrupt generated by SB event
-		//	Note : SB flag is only applicable in Master mode
-		//Handle for interrupt generated by SB event
-		//Note: SB flag is only applicable in master mode
-		//temp  = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_SB);
-		if (temp && temp2) {
-			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
-				clearFlagSB(pI2Cx);
-				if (pI2CHandler->TxRxState == I2C_BUSY_IN_TX) { //busy in transmission
-					//clear the SB bit by reading the SR1 register
-					//AND writing slave address to the DR with r/w bit low
-					sendAddressToSlaveWrite(pI2Cx, pI2CHandler->DeviceAddr);
-
-				} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX) { //busy in reception
-					//Write slave address to DR with r/w bit high
-					sendAddressToSlaveRead(pI2Cx, pI2CHandler->DeviceAddr);
-				}
-			} else { //slave mode
-				//implement later
-			}
-		}
+	status = smbusWrite(pI2CHandler, slaveAddress, &command, 1, NULL, 0, RESET);
+	if (status == I2C_OK) {
+		status = smbusRead(pI2CHandler, slaveAddress, word, 2, NULL);
+	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	*pData = (uint16_t) (word[0] | (word[1] << 8));
+	return I2C_OK;
+}
 
-/***************************************ADDR_EVENT_INTERRUPT******************************************/
-		//Handle interrupt generated by ADDR event
-		//Note: When device is in master mode, the Address is sent
-		//		When device is in slave mode, address matched with its own address
-		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_ADDR);
-		//temp = (pI2Cx->SR1 & ( 1 << I2C_SR1_ADDR)) >> I2C_SR1_ADDR;
-		if (temp && temp2) {
-			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
-				if (pI2CHandler->TxRxState == I2C_BUSY_IN_TX) { //busy in transmission
+/*****************************************************
+ * @fn					- I2C_SMBusBlockWrite
+ *
+ * @brief				- SMBus Block Write: command code, byte count, data bytes
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- number of data bytes (32 max for SMBus 2.0 devices)
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+uint8_t I2C_SMBusBlockWrite(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command,
+							uint8_t* pTxBuffer, uint8_t count) {
+	uint8_t header[2] = { command, count };
+	uint8_t status;
+
+	status = smbusWrite(pI2CHandler, slaveAddress, header, 2, pTxBuffer, count, SET);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-					//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
-					//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
-					//this case). Clear this by reading SR1 register followed by reading SR2
-					clearFlagADDR(pI2Cx);
-				} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX) {
+/*****************************************************
+ * @fn					- I2C_SMBusBlockRead
+ *
+ * @brief				- SMBus Block Read: command code, repeated start, byte count, data bytes
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code
+ * @param[out]			- buffer for reception (RxBuffer)
+ * @param[in]			- size of the buffer
+ * @param[out]			- number of data bytes sent by the slave
+ *
+ * @return				- I2C_OK, I2C_ERR_BLOCK_SIZE (count larger than maxCount) or I2C_ERR_xxx
+ * @note				- The length of the reception is only known from the count byte
+ */
+uint8_t I2C_SMBusBlockRead(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t command,
+						   uint8_t* pRxBuffer, uint8_t maxCount, uint8_t* pCount) {
+	uint8_t status;
 
-					//In the even of having 1 byte reception, the Acknowledge bit must be disabled
-					//in the EV6 before clearing the ADDR flag
-					if (pI2CHandler->RxSize == 1) {
-						ctrlBitACK(pI2Cx, DISABLE); //Disable ACK bit before clearing ADDR
-					} else if (pI2CHandler->RxSize == 2) {
-						ctrlBitPOS(pI2Cx, ENABLE); //enable POS bit before clearing ADDR
-					}
+	status = smbusWrite(pI2CHandler, slaveAddress, &command, 1, NULL, 0, RESET);
+	if (status == I2C_OK) {
+		status = smbusRead(pI2CHandler, slaveAddress, pRxBuffer, maxCount, pCount);
+	}
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	return I2C_OK;
+}
 
-					//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
-					//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
-					//this case). Clear this by reading SR1 register followed by reading SR2
-					clearFlagADDR(pI2Cx);
-				}
-			}
-		}
+/*****************************************************
+ * @fn					- I2C_SMBusAlertResponse
+ *
+ * @brief				- Find the device signaling SMBALERT with a read of the Alert Response Address
+ *
+ * @param[in]			- I2C handle structure
+ * @param[out]			- 7-bit address of the alerting device
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx (I2C_ERR_AF: no device is alerting)
+ * @note				- The device with the lowest address wins the arbitration and
+ * 						  releases SMBALERT, call it again while the alert is active
+ */
+uint8_t I2C_SMBusAlertResponse(I2C_Handle_t* pI2CHandler, uint8_t* pSlaveAddress) {
+	uint8_t data;
+	uint8_t status;
 
-/***************************************BTF_EVENT_INTERRUPT*******************************************/
-		//Handle for interrupt generate by BTF (Byte Transfer Finished) event
-		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_BTF);
-		if (temp && temp2) {
-			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
-				if (I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TXE)) { //the end of transmission
+	status = smbusRead(pI2CHandler, I2C_SMBUS_ARA, &data, 1, NULL);
+	if (status != I2C_OK) {
+		return abortBlocking(pI2CHandler, status);
+	}
+	*pSlaveAddress = data >> 1;
+	return I2C_OK;
+}
 
-					if (pI2CHandler->TxLen == 0) {
-						//Generate the stop condition
-						if (!pI2CHandler->RepeatedStart) {
-							generateStopCondition(pI2Cx);
-						}
+/*****************************************************
+ * @fn					- I2C_SMBusAlertCtrl
+ *
+ * @brief				- Drive or release the SMBALERT pin (SMBus device)
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- ENABLE: SMBALERT low, DISABLE: released
+ *
+ * @return				- none
+ * @note				- The host answers with a read of I2C_SMBUS_ARA, ENARP makes the
+ * 						  peripheral acknowledge it
+ */
+void I2C_SMBusAlertCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
+	if (EnOrDi) {
+		pI2Cx->CR1 |= (1 << I2C_CR1_ENARP) | (1 << I2C_CR1_ALERT);
+	} else {
+		pI2Cx->CR1 &= ~(1 << I2C_CR1_ALERT);
+	}
+}
 
-						//Close the transmission
-						closeMasterTx(pI2CHandler);
+/*****************************************************
+ * @fn					- I2C_SlaveSendData
+ *
+ * @brief				- send request for data from slave to master
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- 1 byte data
+ *
+ * @return				- none
+ * @note				- See the Transfer Sequence diagram for master recevier on page 850
+ * 						  in MCU Reference Manual for more details
+ */
+void I2C_SlaveSendData(I2C_Reg_t* pI2Cx, uint8_t data) {
+	//Write data to specific I2C peripheral data  register
+	pI2Cx->DR = data;
+}
 
-						//Application Call back
-						I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_TX_CMPLT);
-					}
-				}
-				else if (I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE)) { //the end of reception
-					if (pI2CHandler->RxLen == 2) {
-						ctrlBitACK(pI2Cx, DISABLE);
-						//Generate the stop condition
-						if (!pI2CHandler->RepeatedStart) {
-							generateStopCondition(pI2Cx);
-						}
+/*****************************************************
+ * @fn					- I2C_SlaveReceiveData
+ *
+ * @brief				- Receive the data from slave to master
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- 1 byte unsigned integer
+ * @note				- See the Transfer Sequence diagram for master recevier on page 850
+ * 						  in MCU Reference Manual for more details
+ */
+uint8_t I2C_SlaveReceiveData(I2C_Reg_t* pI2Cx) {
+	return (uint8_t) pI2Cx->DR;
+}
 
-					}
-				}
-			} else { //Slave mode
+/*****************************************************
+ * @fn					- I2C_CheckStatusFlag
+ *
+ * @brief				- Check the status of the given flag in either SR1 or SR2 register
+ *
+ * @param[in]			- address of status register of specific I2C peripherals
+ * @param[in]			- the status flag
+ *
+ * @return				- none
+ * @note				- none
+ */
+uint8_t I2C_CheckStatusFlag(__vo uint32_t* statusReg, uint16_t flag) {
+	if ((*statusReg) & flag) {
+		return FLAG_SET;
+	}
+	return FLAG_RESET;
+}
 
-			}
+/*****************************************************
+ * @fn					- I2C_IRQITConfig
+ *
+ * @brief				- I2C Interrupt configuration
+ *
+ * @param[in]			- IRQ Number of the I2C interrupt peripheral
+ * @param[in]			= ENABLE or DISABLE macro
+ *
+ * @return				- none
+ * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ */
+void I2C_IRQITConfig(uint8_t IRQNumber, uint8_t EnOrDi) {
+	//In order to trigger the interrupt on the processor side,
+	//configuration enable on the ISER of the NVIC is needed
+	//Note: There are 7 different NVIC_ISER and NVIC_ICER register
+	//at certain range
+	uint32_t indx, remainder;
+	indx = IRQNumber >> 5U; //Index to configure the correct NVIC_ISER
+	if (indx >= 0U  && indx <= 7U) {
+		remainder = IRQNumber & (~(~(int)0 << 5U)); //find the remainder
+		if (EnOrDi) {
+			NVIC_ISER(indx) |= 1 << remainder; //See NVIC_ISER(__INDEX__) declaration for more implementation details
+		} else {
+			NVIC_ICER(indx) |= 1 << remainder; //See NVIC_ICER(__INDEX__) declaration for more implementation details
 		}
-/***************************************STOPF_EVENT_INTERRUPT*****************************************/
-		//Handle for interrupt generated by STOPF event
-		//Note: Stop detection flag is applicable only in slave receiver mode.
-		//		See datasheet for more details. For master, this flag will never be set
-		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_STOPF);
-		if (temp && temp2) {
+	}
+}
 
-			if (!I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //slave mode
-				clearFlagSTOPF(pI2Cx);
-				I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_STOPF_CMPLT);
-			}
+/*****************************************************
+ * @fn					- I2C_IRQPriorityConfig
+ *
+ * @brief				- I2C Interrupt Priority Configuration
+ *
+ * @param[in]			- IRQ number of the I2C interrupt peripheral
+ * @param[in]			= The priority value of that I2C interrupt peripheral
+ *
+ * @return				- none
+ * @note				- Refer to the Cortex M4 Generic User Guide the NVIC register table
+ */
+void I2C_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriorityValue) {
+	uint32_t indx = IRQNumber >> 2U; //Note: There are IRQ Priority field in each IPR register
+	uint32_t remainder = IRQNumber & (~(~(int)0 << 2U));
+	uint32_t shift_amount = (remainder * 8U) + IMPLEMENTED_IRQ_PRIORITY_BIT;
+
+	//Configure the IRQ_PR register
+	NVIC_IPR(indx) |= IRQPriorityValue << shift_amount;
+}
+
+/*****************************************************
+ * @fn					- I2C_MasterSendDataIT()
+ *
+ * @brief				- I2C Interrupt Priority Configuration
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ * @param[in]			- slave address
+ * @param[in]			- repeated start condition set or reset
+ *
+ * @return				- I2C current state
+ * @note				- This is the non-blocking API
+ */
+uint8_t I2C_MasterSendDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
+						uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	//Since I2C bus is bidirectional, only transmit when the bus is in ready state
+	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+
+		//Storing the arguments globally in the I2C Handle structure
+		pI2CHandler->TxLen = len;
+		pI2CHandler->pTxBuffer = pTxBuffer;
+		pI2CHandler->DeviceAddr = pSlaveAddress;
+		pI2CHandler->Addr10Read = RESET;
+		pI2CHandler->RepeatedStart = repeatedStart;
+
+		//Mark the I2C bus as busy in transmitting so that other master
+		//cannot take over the same bus (avoid arbitration error)
+		pI2CHandler->TxRxState = I2C_BUSY_IN_TX;
+		pI2CHandler->XferStart = DWT_CYCCNT;
+
+		//Generate the Start condition
+		generateStartCondition(pI2CHandler->pI2Cx);
+
+		//Enable the event interrupt control bit for transmitting
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
+
+		//Enable the event interrupt control bit
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+
+		//Enable the error interrupt control bit to inform
+		//the error back the user application, which is one of the main responsibily
+		//for writing the driver
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	}
+
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_MasterReceiveDataIT
+ *
+ * @brief				- Non-blocking implementation of the i2C Master Receive data using interrupt
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ * @param[in]			- slave address
+ * @param[in]			- repeated start condition set or reset
+ *
+ * @return				- I2C current state
+ * @note				- This is the non-blocking API
+ */
+uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
+		 	 	 	 	     uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	//check to see whether device is in ready state
+	if (state != I2C_BUSY_IN_RX && state != I2C_BUSY_IN_TX) {
+
+		//Transfer device information to the I2C Handle structure
+		pI2CHandler->RxLen = len;
+		pI2CHandler->pRxBuffer = pRxBuffer;
+		pI2CHandler->RxSize	   = len;
+		pI2CHandler->DeviceAddr = pSlaveAddress;
+		pI2CHandler->Addr10Read = RESET;
+		pI2CHandler->RepeatedStart = repeatedStart;
+
+		//Mark the current state as busy in transmitting
+		//Note: in I2C, the BUSY bit is set and clear by hardware
+		//automaticallly. Thus, to keep track of the current state,
+		//it's best to define the state macros
+		pI2CHandler->TxRxState = I2C_BUSY_IN_RX;
+		pI2CHandler->XferStart = DWT_CYCCNT;
+
+		//Generate the start condition
+		generateStartCondition(pI2CHandler->pI2Cx);
+
+		//Enable the event interrupt control bit for receiving data
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
+
+		//Enable the event interrupt control bit
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+
+		//Enable the error interrupt control bit in the event
+		//that error such as overrrun occurs in data reception
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_MemWriteIT
+ *
+ * @brief				- Non-blocking write into a register (memory location) of the slave
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- I2C current state
+ * @note				- The TXE interrupt sends the register address before the data
+ */
+uint8_t I2C_MemWriteIT(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					   uint8_t memAddrSize, uint8_t* pTxBuffer, uint32_t len) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+		setMemAddress(pI2CHandler, memAddress, memAddrSize);
+		pI2CHandler->MemRxPending = RESET;
+		I2C_MasterSendDataIT(pI2CHandler, pTxBuffer, len, slaveAddress, I2C_SR_RESET);
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_MemReadIT
+ *
+ * @brief				- Non-blocking read from a register (memory location) of the slave
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- I2C current state
+ * @note				- The transaction starts as a transmission of the register address.
+ * 						  Once it is out (BTF), the interrupt turns the bus around with a
+ * 						  repeated start and continues as a reception
+ */
+uint8_t I2C_MemReadIT(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					  uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+		setMemAddress(pI2CHandler, memAddress, memAddrSize);
+		pI2CHandler->MemRxPending = SET;
+
+		//Reception phase, started by the BTF interrupt of the address phase
+		pI2CHandler->RxLen = len;
+		pI2CHandler->pRxBuffer = pRxBuffer;
+		pI2CHandler->RxSize = len;
+
+		//Address phase: no data after the register address
+		I2C_MasterSendDataIT(pI2CHandler, NULL, 0, slaveAddress, I2C_SR_RESET);
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_AttachDMA
+ *
+ * @brief				- Configure the DMA streams used by the DMA API of the I2C handle
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- Tx stream handle (pDMAx, Stream, Channel, Priority filled), or NULL
+ * @param[in]			- Rx stream handle (pDMAx, Stream, Channel, Priority filled), or NULL
+ *
+ * @return				- none
+ * @note				- Enable the stream IRQs in the NVIC and call DMA_IRQHandling()
+ * 						  from the stream handlers. See @I2C_DMA_XFER for the mapping
+ */
+void I2C_AttachDMA(I2C_Handle_t* pI2CHandler, DMA_Handle_t* pDMATx, DMA_Handle_t* pDMARx) {
+	pI2CHandler->pDMATx = pDMATx;
+	pI2CHandler->pDMARx = pDMARx;
+	pI2CHandler->XferDMA = I2C_DMA_NONE;
+
+	if (pDMATx != NULL) {
+		pDMATx->DMA_Config.Direction = DMA_DIR_MEM_TO_PERIPH;
+		pDMATx->DMA_Config.DataSize = DMA_DATA_SIZE_BYTE;
+		pDMATx->DMA_Config.MemInc = ENABLE;
+		pDMATx->DMA_Config.Circular = DISABLE;
+		pDMATx->DMA_Config.HalfTransferIT = DISABLE;
+		pDMATx->Callback = dmaEventCallback;
+		pDMATx->pContext = pI2CHandler;
+		DMA_Init(pDMATx);
+	}
+	if (pDMARx != NULL) {
+		pDMARx->DMA_Config.Direction = DMA_DIR_PERIPH_TO_MEM;
+		pDMARx->DMA_Config.DataSize = DMA_DATA_SIZE_BYTE;
+		pDMARx->DMA_Config.MemInc = ENABLE;
+		pDMARx->DMA_Config.Circular = DISABLE;
+		pDMARx->DMA_Config.HalfTransferIT = DISABLE;
+		pDMARx->Callback = dmaEventCallback;
+		pDMARx->pContext = pI2CHandler;
+		DMA_Init(pDMARx);
+	}
+}
+
+/*****************************************************
+ * @fn					- I2C_MasterSendDataDMA
+ *
+ * @brief				- Non-blocking master transmission, the data bytes are moved by DMA
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len, up to 65535)
+ * @param[in]			- slave address
+ * @param[in]			- repeated start condition set or reset
+ *
+ * @return				- I2C current state
+ * @note				- ITBUFEN stays off: TXE requests go to the DMA. The transfer ends
+ * 						  with the BTF interrupt that follows the last byte
+ */
+uint8_t I2C_MasterSendDataDMA(I2C_Handle_t* pI2CHandler, uint8_t* pTxBuffer, uint32_t len,
+							  uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+		if (pI2CHandler->pDMATx == NULL || len == 0) {
+			return I2C_MasterSendDataIT(pI2CHandler, pTxBuffer, len, pSlaveAddress, repeatedStart);
 		}
 
-/***************************************TXE_EVENT_INTERRUPT*******************************************/
-		//Handle for interrupt generated by TXE event
-		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TXE);
-		if ((temp && temp1) && temp2) {
-			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
-				//Handle for transmission
-				if (pI2CHandler->TxLen > 0) {
-					pI2CHandler->pI2Cx->DR = *(pI2CHandler->pTxBuffer);
-					pI2CHandler->TxLen--;
-					pI2CHandler->pTxBuffer++;
-				}
-			} else { //Slave mode
-				if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_TRA)) { //transmitter mode
-					I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_DATA_REQ);
-				}
-			}
+		pI2CHandler->TxLen = len;
+		pI2CHandler->pTxBuffer = pTxBuffer;
+		pI2CHandler->DeviceAddr = pSlaveAddress;
+		pI2CHandler->Addr10Read = RESET;
+		pI2CHandler->RepeatedStart = repeatedStart;
+		pI2CHandler->TxRxState = I2C_BUSY_IN_TX;
+		pI2CHandler->XferStart = DWT_CYCCNT;
+		pI2CHandler->XferDMA = I2C_DMA_TX;
+
+		//Arm the stream first, it waits for the first TXE after ADDR
+		DMA_Start(pI2CHandler->pDMATx, (uint32_t) &pI2CHandler->pI2Cx->DR, (uint32_t) pTxBuffer, (uint16_t) len);
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_DMAEN;
+
+		generateStartCondition(pI2CHandler->pI2Cx);
+
+		//Event (SB, ADDR, BTF) and error interrupts only
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_MasterReceiveDataDMA
+ *
+ * @brief				- Non-blocking master reception, the data bytes are moved by DMA
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len, up to 65535)
+ * @param[in]			- slave address
+ * @param[in]			- repeated start condition set or reset
+ *
+ * @return				- I2C current state
+ * @note				- LAST makes the hardware NACK the final byte, the STOP is
+ * 						  programmed from the DMA transfer complete interrupt
+ */
+uint8_t I2C_MasterReceiveDataDMA(I2C_Handle_t* pI2CHandler, uint8_t* pRxBuffer, uint32_t len,
+								 uint16_t pSlaveAddress, uint8_t repeatedStart) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	if (state != I2C_BUSY_IN_RX && state != I2C_BUSY_IN_TX) {
+		if (pI2CHandler->pDMARx == NULL || len < 2) {
+			return I2C_MasterReceiveDataIT(pI2CHandler, pRxBuffer, len, pSlaveAddress, repeatedStart);
 		}
-/***************************************RXNE_EVENT_INTERRUPT*******************************************/
-		//Handle for interrupt generated by RXNE event
-		//Handle for interrupt generated by TXE event
-		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE);
-		if ((temp && temp1) && temp2) {
-			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
 
-				//Handle for multiple reception
-				*(pI2CHandler->pRxBuffer) = pI2CHandler->pI2Cx->DR;
-				pI2CHandler->RxLen--;
-				if (pI2CHandler->RxLen > 1) {
-					pI2CHandler->pRxBuffer++;
-				}
+		pI2CHandler->RxLen = len;
+		pI2CHandler->pRxBuffer = pRxBuffer;
+		pI2CHandler->RxSize = len;
+		pI2CHandler->DeviceAddr = pSlaveAddress;
+		pI2CHandler->Addr10Read = RESET;
+		pI2CHandler->RepeatedStart = repeatedStart;
+		pI2CHandler->TxRxState = I2C_BUSY_IN_RX;
+		pI2CHandler->XferStart = DWT_CYCCNT;
+		pI2CHandler->XferDMA = I2C_DMA_RX;
 
-				//Note: To me sometime later when I got the job as firmware engineer.
-				//C is procedural programming, so after decrementing the Rx len, you MUST
-				//remember to check for 0 to close the communication ASAP to avoid going to
-				//another ISR. If you do so, RXNE will be set to 0 and the condition for
-				//this interrupt will never be fulfilled.
-				if (pI2CHandler->RxLen == 0) {
-					//Close the transmission
-					closeMasterRx(pI2CHandler);
+		startRxDMA(pI2CHandler);
+		generateStartCondition(pI2CHandler->pI2Cx);
+
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+		pI2CHandler->pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_MemReadDMA
+ *
+ * @brief				- Non-blocking read from a register (memory location) of the slave,
+ * 						  the data bytes are moved by DMA
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len, up to 65535)
+ *
+ * @return				- I2C current state
+ * @note				- The register address goes out on TXE interrupts (1 or 2 bytes),
+ * 						  the BTF interrupt arms the Rx stream with the repeated start
+ */
+uint8_t I2C_MemReadDMA(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint16_t memAddress,
+					   uint8_t memAddrSize, uint8_t* pRxBuffer, uint32_t len) {
+	uint8_t state;
+	state = pI2CHandler->TxRxState;
+
+	if (state != I2C_BUSY_IN_TX && state != I2C_BUSY_IN_RX) {
+		if (pI2CHandler->pDMARx == NULL || len < 2) {
+			return I2C_MemReadIT(pI2CHandler, slaveAddress, memAddress, memAddrSize, pRxBuffer, len);
+		}
+		pI2CHandler->XferDMA = I2C_DMA_RX;
+		I2C_MemReadIT(pI2CHandler, slaveAddress, memAddress, memAddrSize, pRxBuffer, len);
+	}
+	return state;
+}
+
+/*****************************************************
+ * @fn					- I2C_SlaveRegMapInit
+ *
+ * @brief				- Serve a register file in slave mode from the event interrupt
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- register map structure
+ * @param[in]			- register file
+ * @param[in]			- per-register writable bits (NULL: all writable, 0x00: read-only)
+ * @param[in]			- number of registers (up to 256, 8-bit pointer)
+ *
+ * @return				- none
+ * @note				- The own address and ACKing come from I2C_Init. Enable the
+ * 						  event/error IRQs and I2C_InterruptCtrl() as for the slave callbacks
+ */
+void I2C_SlaveRegMapInit(I2C_Handle_t* pI2CHandler, I2C_RegMap_t* pRegMap, uint8_t* pRegs,
+						 const uint8_t* pWriteMask, uint16_t size) {
+	pRegMap->pRegs = pRegs;
+	pRegMap->pWriteMask = pWriteMask;
+	pRegMap->Size = size;
+	pRegMap->Pointer = 0;
+	pRegMap->ChangeStart = 0;
+	pRegMap->ChangeLen = 0;
+	pRegMap->AddrPhase = RESET;
+	pI2CHandler->pRegMap = pRegMap;
+}
+
+/*****************************************************
+ * @fn					- I2C_QueueInit
+ *
+ * @brief				- Attach the descriptor array of the transaction queue
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- array of descriptor pointers
+ * @param[in]			- number of entries of the array (power of 2, up to 128)
+ *
+ * @return				- none
+ * @note				- Enable the I2Cx event and error IRQs in the NVIC
+ */
+void I2C_QueueInit(I2C_Handle_t* pI2CHandler, I2C_Transaction_t** pSlots, uint8_t size) {
+	pI2CHandler->Queue.pSlots = pSlots;
+	pI2CHandler->Queue.Size = size;
+	pI2CHandler->Queue.Head = 0;
+	pI2CHandler->Queue.Tail = 0;
+	pI2CHandler->Queue.pActive = NULL;
+}
+
+/*****************************************************
+ * @fn					- I2C_QueueSubmit
+ *
+ * @brief				- Append a transaction to the queue, start it if the bus is idle
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- transaction descriptor
+ *
+ * @return				- SET if the transaction is queued, RESET if the queue is full
+ * @note				- Safe to call from the main loop, an ISR or a transaction callback
+ */
+uint8_t I2C_QueueSubmit(I2C_Handle_t* pI2CHandler, I2C_Transaction_t* pXfer) {
+	I2C_Queue_t* pQueue = &pI2CHandler->Queue;
+	uint32_t primask;
+
+	ENTER_CRITICAL(primask);
+	if ((uint8_t) (pQueue->Head - pQueue->Tail) >= pQueue->Size) {
+		EXIT_CRITICAL(primask);
+		return RESET; //full
+	}
+	pXfer->Status = I2C_XFER_PENDING;
+	pXfer->Attempts = 0;
+	pQueue->pSlots[pQueue->Head & (pQueue->Size - 1U)] = pXfer;
+	pQueue->Head++;
+	EXIT_CRITICAL(primask);
+
+	//Kick the bus if nothing is running, otherwise the ISR takes it from here
+	startNextXfer(pI2CHandler);
+
+	return SET;
+}
+
+/*****************************************************
+ * @fn					- I2C_QueueCount
+ *
+ * @brief				- Number of transactions waiting in the queue
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- number of pending transactions (the active one excluded)
+ * @note				- none
+ */
+uint8_t I2C_QueueCount(I2C_Handle_t* pI2CHandler) {
+	return (uint8_t) (pI2CHandler->Queue.Head - pI2CHandler->Queue.Tail);
+}
+
+/*****************************************************
+ * @fn					- I2C_QueueService
+ *
+ * @brief				- Restart the transaction that lost the arbitration after its backoff,
+ * 						  or the one held back by the STOP of the previous transfer
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- The backoff only counts while the bus is free: it starts over
+ * 						  each time another master is seen on the bus. The resolution is
+ * 						  the calling period
+ */
+void I2C_QueueService(I2C_Handle_t* pI2CHandler) {
+	uint32_t primask;
+
+	if (!pI2CHandler->RetryPending) {
+		startNextXfer(pI2CHandler);
+		return;
+	}
+
+	ENTER_CRITICAL(primask);
+	if (pI2CHandler->pI2Cx->SR2 & I2C_FLAG_SR2_BUSY) {
+		pI2CHandler->RetryAt = DWT_CYCCNT;
+	} else if ((DWT_CYCCNT - pI2CHandler->RetryAt) >= pI2CHandler->RetryDelay) {
+		pI2CHandler->RetryPending = RESET;
+		startNextXfer(pI2CHandler);
+	}
+	EXIT_CRITICAL(primask);
+}
+
+/*****************************************************
+ * @fn					- I2C_EV_IRQHandling
+ *
+ * @brief				- This function provides handle implementaions for all I2C event interrupts
+ *
+ * @param[in]			- I2C Handle structure
+ *
+ * @return				- none
+ * @note				- In this function, you need to cover the case for both master AND slave
+ *						  since I2C is half-duplex in STM32
+ */
+void I2C_EV_IRQHandling(I2C_Handle_t* pI2CHandler) {
+	//Interrupt handling for both master and slave mode of a device
+
+		uint32_t temp, temp1, temp2;
+		I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+
+		//Check status of the event interrupt control bit
+		temp1 = (pI2Cx->CR2 & (1 << I2C_CR2_ITBUFEN)) >> I2C_CR2_ITBUFEN;
+		temp2 = (pI2Cx->CR2 & (1 << I2C_CR2_ITEVTEN)) >> I2C_CR2_ITEVTEN;
+
+/****************************************SB_EVENT_INTERRUPT*****************************************/
+		temp  = pI2CHandler->pI2Cx->SR1 & ( 1 << I2C_SR1_SB);
+		//1. Handle For interrupt generated by SB event
+		//	Note : SB flag is only applicable in Master mode
+		//Handle for interrupt generated by SB event
+		//Note: SB flag is only applicable in master mode
+		//temp  = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_SB);
+		if (temp && temp2) {
+			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
+				clearFlagSB(pI2Cx);
+				sendAddressIT(pI2CHandler);
+			} else { //slave mode
+				//implement later
+			}
+		}
+
+/***************************************ADD10_EVENT_INTERRUPT*****************************************/
+		//Handle for interrupt generated by ADD10 event (10-bit header sent, master mode)
+		//Note: ADD10 is cleared by reading SR1 followed by writing the second address byte in DR
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_ADD10);
+		if (temp && temp2) {
+			pI2Cx->DR = (uint8_t) pI2CHandler->DeviceAddr;
+		}
+
+/***************************************ADDR_EVENT_INTERRUPT******************************************/
+		//Handle interrupt generated by ADDR event
+		//Note: When device is in master mode, the Address is sent
+		//		When device is in slave mode, address matched with its own address
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_ADDR);
+		//temp = (pI2Cx->SR1 & ( 1 << I2C_SR1_ADDR)) >> I2C_SR1_ADDR;
+		if (temp && temp2) {
+			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
+				if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX && !pI2CHandler->Addr10Read &&
+					pI2CHandler->I2C_Config.AddressingMode == I2C_ADDR_MODE_10_BIT) {
+					//10-bit reception: the slave is now addressed (in write), a repeated
+					//start follows and the SB event sends the header with the r/w bit high
+					clearFlagADDR(pI2Cx);
+					pI2CHandler->Addr10Read = SET;
+					generateStartCondition(pI2Cx);
+				} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_TX) { //busy in transmission
+
+					//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
+					//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
+					//this case). Clear this by reading SR1 register followed by reading SR2
+					clearFlagADDR(pI2Cx);
+				} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX) {
+
+					//In the even of having 1 byte reception, the Acknowledge bit must be disabled
+					//in the EV6 before clearing the ADDR flag
+					if (pI2CHandler->RxSize == 1) {
+						ctrlBitACK(pI2Cx, DISABLE); //Disable ACK bit before clearing ADDR
+					} else if (pI2CHandler->RxSize == 2 && pI2CHandler->XferDMA != I2C_DMA_RX) {
+						ctrlBitPOS(pI2Cx, ENABLE); //enable POS bit before clearing ADDR (the DMA uses LAST instead)
+					}
+
+					//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
+					//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
+					//this case). Clear this by reading SR1 register followed by reading SR2
+					clearFlagADDR(pI2Cx);
+
+					//Single byte: the STOP must be programmed right after ADDR is cleared (EV6_1),
+					//there is no BTF event to do it later
+					if (pI2CHandler->RxSize == 1 && !pI2CHandler->RepeatedStart) {
+						generateStopCondition(pI2Cx);
+					}
+				}
+			} else { //slave mode: ADDR is already cleared by the SR1/SR2 reads above
+				//Own address matched, GENCALL and DUALF stay valid until STOP or repeated start
+				if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_GENCALL)) {
+					pI2CHandler->SlaveMatch = I2C_MATCH_GENCALL;
+				} else if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_DUALF)) {
+					pI2CHandler->SlaveMatch = I2C_MATCH_DUAL;
+				} else {
+					pI2CHandler->SlaveMatch = I2C_MATCH_OWN;
+				}
+
+				//The register map only answers on the own address, the dual address and
+				//the general call go to the per-byte callbacks (see SlaveMatch)
+				if (pI2CHandler->pRegMap != NULL && pI2CHandler->SlaveMatch == I2C_MATCH_OWN &&
+					!I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_TRA)) {
+					//Write transaction: the first byte is the register pointer
+					pI2CHandler->pRegMap->AddrPhase = SET;
+				}
+			}
+		}
+
+/***************************************BTF_EVENT_INTERRUPT*******************************************/
+		//Handle for interrupt generate by BTF (Byte Transfer Finished) event
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_BTF);
+		if (temp && temp2) {
+			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //master mode
+				if (I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TXE)) { //the end of transmission
+
+					//DMA transmission: over once the stream has written the last byte
+					if (pI2CHandler->XferDMA == I2C_DMA_TX) {
+						pI2CHandler->TxLen = DMA_GetRemaining(pI2CHandler->pDMATx);
+					}
+
+					if (pI2CHandler->TxLen == 0 && pI2CHandler->MemAddrLen == 0) {
+						if (pI2CHandler->MemRxPending) {
+							//I2C_MemReadIT: the register address is out, turn the bus
+							//around with a repeated start. The SB event then sends the
+							//slave address with the r/w bit high
+							pI2CHandler->MemRxPending = RESET;
+							pI2CHandler->TxRxState = I2C_BUSY_IN_RX;
+							pI2CHandler->Addr10Read = SET; //10-bit: the slave is already addressed
+							if (pI2CHandler->XferDMA == I2C_DMA_RX) {
+								//I2C_MemReadDMA: the data bytes go to the Rx stream
+								pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
+								startRxDMA(pI2CHandler);
+							}
+							generateStartCondition(pI2Cx);
+						} else {
+							//Generate the stop condition
+							if (!pI2CHandler->RepeatedStart) {
+								generateStopCondition(pI2Cx);
+							}
+
+							//Close the transmission
+							closeMasterTx(pI2CHandler);
+
+							//Application Call back, then the next queued transaction
+							completeXfer(pI2CHandler, I2C_EVT_TX_CMPLT);
+						}
+					}
+				}
+				else if (I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE)) { //the end of reception
+					if (pI2CHandler->RxLen == 2 && pI2CHandler->XferDMA != I2C_DMA_RX) {
+						ctrlBitACK(pI2Cx, DISABLE);
+						//Generate the stop condition
+						if (!pI2CHandler->RepeatedStart) {
+							generateStopCondition(pI2Cx);
+						}
+
+					}
+				}
+			} else { //Slave mode
+
+			}
+		}
+/***************************************STOPF_EVENT_INTERRUPT*****************************************/
+		//Handle for interrupt generated by STOPF event
+		//Note: Stop detection flag is applicable only in slave receiver mode.
+		//		See datasheet for more details. For master, this flag will never be set
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_STOPF);
+		if (temp && temp2) {
+
+			if (!I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //slave mode
+				clearFlagSTOPF(pI2Cx);
+				//Only the own address is served by the register map
+				if (pI2CHandler->pRegMap == NULL || pI2CHandler->SlaveMatch != I2C_MATCH_OWN) {
+					I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_STOPF_CMPLT);
+				} else if (pI2CHandler->pRegMap->ChangeLen > 0) {
+					//One notification per write transaction, the range stays
+					//readable in the register map until the next one
+					I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_REGMAP_WRITE);
+					pI2CHandler->pRegMap->ChangeLen = 0;
+				}
+			}
+		}
+
+/***************************************TXE_EVENT_INTERRUPT*******************************************/
+		//Handle for interrupt generated by TXE event
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TXE);
+		if ((temp && temp1) && temp2) {
+			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+				//Handle for transmission
+				//The register address of I2C_MemWriteIT/I2C_MemReadIT goes first
+				if (pI2CHandler->MemAddrLen > 0) {
+					pI2CHandler->MemAddrLen--;
+					pI2CHandler->pI2Cx->DR = pI2CHandler->MemAddr[pI2CHandler->MemAddrLen];
+				} else if (pI2CHandler->TxLen > 0) {
+					pI2CHandler->pI2Cx->DR = *(pI2CHandler->pTxBuffer);
+					pI2CHandler->TxLen--;
+					pI2CHandler->pTxBuffer++;
+				}
+			} else { //Slave mode
+				if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_TRA)) { //transmitter mode
+					if (pI2CHandler->pRegMap != NULL && pI2CHandler->SlaveMatch == I2C_MATCH_OWN) {
+						I2C_RegMap_t* pRegMap = pI2CHandler->pRegMap;
+						pI2Cx->DR = pRegMap->pRegs[pRegMap->Pointer];
+						pRegMap->Pointer = (pRegMap->Pointer + 1U) % pRegMap->Size;
+					} else {
+						I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_DATA_REQ);
+					}
+				}
+			}
+		}
+/***************************************RXNE_EVENT_INTERRUPT*******************************************/
+		//Handle for interrupt generated by RXNE event
+		//Handle for interrupt generated by TXE event
+		temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE);
+		if ((temp && temp1) && temp2) {
+			if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+
+				//Handle for multiple reception
+				*(pI2CHandler->pRxBuffer) = pI2CHandler->pI2Cx->DR;
+				pI2CHandler->RxLen--;
+				pI2CHandler->pRxBuffer++;
+
+				//Note: To me sometime later when I got the job as firmware engineer.
+				//C is procedural programming, so after decrementing the Rx len, you MUST
+				//remember to check for 0 to close the communication ASAP to avoid going to
+				//another ISR. If you do so, RXNE will be set to 0 and the condition for
+				//this interrupt will never be fulfilled.
+				if (pI2CHandler->RxLen == 0) {
+					//Close the transmission
+					closeMasterRx(pI2CHandler);
+
+					//Application Call back, then the next queued transaction
+					completeXfer(pI2CHandler, I2C_EVT_RX_CMPLT);
+				}
+			} else { //Slave mode
+				if (!I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_TRA)) { //receiver mode
+					if (pI2CHandler->pRegMap != NULL && pI2CHandler->SlaveMatch == I2C_MATCH_OWN) {
+						regMapWrite(pI2CHandler->pRegMap, (uint8_t) pI2Cx->DR);
+					} else {
+						I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_DATA_RCV);
+					}
+				}
+			}
+		}
+}
+
+/*****************************************************
+ * @fn					- I2C_ER_IRQHandling
+ *
+ * @brief				- This function provide handle implementation for all I2C event interrupts
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- none
+ */
+void I2C_ER_IRQHandling(I2C_Handle_t* pI2CHandler) {
+	uint32_t temp, temp1;
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+
+	//Check the status of the error interrupt control bit
+	//Note: ITBUFEN is off during the DMA transfers, errors are gated by ITERREN only
+	temp1 = pI2Cx->CR2 & (1 << I2C_CR2_ITERREN);
+
+/**************************************BERR_ERROR_INTERRUPT*********************************************/
+	//This error occurs when the I2C interface detects an external Stop
+	//Start condition during an address or a data transfer.
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_BERR);
+	if (temp && temp1) {
+
+		//Clear the BERR flag
+		//Write 0 to clear: writing 1 leaves the other flags untouched, where a
+		//read-modify-write would clear a flag raised in between
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_BERR;
+		countError(pI2CHandler, I2C_ERR_BERR);
+
+		//In master mode: the lines are not released, and the state of the
+		//current transmission is not affected. It is up to software to abort
+		//or not the current transmission. In this implemenetation, I decided
+		//to close the transmission instead.
+		if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+
+			//Close the master transmission
+			generateStopCondition(pI2Cx);
+			abortMasterXfer(pI2CHandler);
+			completeXfer(pI2CHandler, I2C_ERR_BERR);
+		}
+
+		//In slave mode, data are discarded and the lines are released by hardware
+		else {
+			I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_BERR);
+		}
+	}
+
+
+/**************************************AF_ERROR_INTERRUPT*********************************************/
+	//This error occurs when the interface detects a nonacknowledge bit.
+	//Note: A transmitter that receives NACK should reset the transmission
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_AF);
+	if (temp && temp1) {
+
+		//Clear the AF flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_AF;
+
+		//In master mode, a stop or repeated start condition must
+		//be generated by software
+		if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+			countError(pI2CHandler, I2C_ERR_AF);
+
+			//Close the master transmission by
+			//generating the stop condition
+			generateStopCondition(pI2Cx);
+			abortMasterXfer(pI2CHandler);
+			completeXfer(pI2CHandler, I2C_ERR_AF);
+		}
+
+		//In slave mode, data are discarded and the lines are released by hardware
+		//Note: In slave transmitter mode, the AF bit signals the end of slave transmission,
+		//		as master sends NACK which results in AF bit HIGH to close the communication
+		else if (pI2CHandler->pRegMap != NULL && pI2CHandler->SlaveMatch == I2C_MATCH_OWN) {
+			//Normal end of a register read: the last TXE already loaded one
+			//register more than the master took, step the pointer back on it
+			I2C_RegMap_t* pRegMap = pI2CHandler->pRegMap;
+			pRegMap->Pointer = (pRegMap->Pointer + pRegMap->Size - 1U) % pRegMap->Size;
+		} else {
+			I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_AF);
+		}
+
+	}
+
+/**************************************ARLO_ERROR_INTERRUPT*********************************************/
+	//This error occurs when the I2C interface detects an arbitration lost condition
+	//This happens all the more often in the multi-master communication
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_ARLO);
+	if (temp && temp1) {
+
+		//Clear the ARLO flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_ARLO;
+		countError(pI2CHandler, I2C_ERR_ARLO);
+
+		//Note: When this flag is set, the I2C interface goes automatically back to
+		//slave mode (the MSL bit is cleared). Whe the I2C loses the arbitration, it
+		//is not able to acknowledge its slave address in the same transfer
+		//Lines are released by hardware
+		//The master transfer in progress is lost: close it so the bus state does
+		//not stay busy forever. A queued transaction goes back to the head of the
+		//queue while the retry policy allows it
+		if (pI2CHandler->TxRxState != I2C_READY) {
+			abortMasterXfer(pI2CHandler);
+			if (!retryXfer(pI2CHandler)) {
+				completeXfer(pI2CHandler, I2C_ERR_ARLO);
+			}
+		} else {
+			I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_ARLO);
+		}
+	}
+
+/***************************************OVR_ERROR_INTERRUPT********************************************/
+	//An overrun error can occur in slave mode while underrun can occur in
+	//master mode. This is when clock stretching is disabled and the I2C interface
+	//is receiving data. The interface has received a byte (RXNE = 1) and the data in
+	//DR has not been read, before the next byte is received by the interface, which
+	//results in the loss of the newly received byte.
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_OVR);
+	if (temp && temp1) {
+
+		//Clear the OVR flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_OVR;
+		countError(pI2CHandler, I2C_ERR_OVR);
+
+		//Report to the user application
+		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_OVR);
+	}
+
+/***************************************OVR_ERROR_INTERRUPT********************************************/
+	//Handle for PECERR error interrupt. For more details, see STM32F407xx Reference Manual
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_PECERR);
+	if (temp && temp1) {
+
+		//Clear the PECERR flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_PECERR;
+		countError(pI2CHandler, I2C_ERR_PECERR);
+
+		//Report to the user application
+		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_PECERR);
+	}
+
+/***************************************OVR_ERROR_INTERRUPT********************************************/
+	//Handle for TIMEOUT error interrupt. For more details, see STM32F407xx Reference Manual
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TIMEOUT);
+	if (temp && temp1) {
+
+		//Clear the TIMEOUT flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_TIMEOUT;
+
+		//Report to the user application
+		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_TIMEOUT);
+	}
+
+/***************************************SMBALERT_ERROR_INTERRUPT***************************************/
+	//Handle for SMBALERT error interrupt. For more details, see STM32F407xx Reference Manual
+	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_SMBALERT);
+	if (temp && temp1) {
+
+		//Clear the SMBALERT flag
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_SMBALERT;
+
+		//Report to the user application
+		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_SMBALERT);
+	}
+}
+
+/*****************************************************
+ * @fn					- I2C_ER_InterruptCtrl
+ *
+ * @brief				- Enable or disable the interrupt function mode.
+ *
+ * @param[in]			- Base address of specific I2C peripherals
+ * @param[in]			- Enable or Disable macros
+ *
+ * @return				- none
+ * @note				- This function is ostensibly designed for slave mode only
+ */
+void I2C_InterruptCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
+	if (EnOrDi) {
+		pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
+		pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
+		pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
+	} else {
+		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
+		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
+		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITERREN);
+	}
+}
+
+/*****************************************************
+ * @fn					- I2C_ApplicationEventCallBack
+ *
+ * @brief				- Inform the user application of the event status
+ * 						  This API is of essence in slave mode, where the transmission
+ * 						  and reception of data are handled here
+ *
+ * @param[in]			- I2C Handle structure
+ * @param[in]			- event status macros
+ *
+ * @return				- none
+ * @note				- weak implementation for user application to implement
+ */
+__weak void I2C_ApplicationEventCallBack(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
+	//This API is implemented by the user application
+}
+
+/*****************************************************
+ * @fn					- generateStartCondition()
+ *
+ * @brief				- helper function that generates the start condition for master
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- none
+ * @note				- The CR1 control bits are written through their bit-band alias:
+ * 						  a single store that cannot undo a CR1 change made by an ISR
+ */
+static void generateStartCondition(I2C_Reg_t* pI2Cx) {
+	BITBAND_PERIPH(pI2Cx->CR1, I2C_CR1_START) = 1U;
+}
+
+/*****************************************************
+ * @fn					- generateStopCondition()
+ *
+ * @brief				- helper function that generates the stop condition for master
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void generateStopCondition(I2C_Reg_t* pI2Cx) {
+	BITBAND_PERIPH(pI2Cx->CR1, I2C_CR1_STOP) = 1U;
+}
+
+/*****************************************************
+ * @fn					- clearFlagSB()
+ *
+ * @brief				- helper function that clear the SB status flag
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void clearFlagSB(I2C_Reg_t* pI2Cx) {
+	uint32_t temp;
+	temp = pI2Cx->SR1;
+	(void) temp; //resolve unused variable warning
+}
+
+/*****************************************************
+ * @fn					- clearFlagADDR()
+ *
+ * @brief				- helper function that clear the ADDR status flag
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void clearFlagADDR(I2C_Reg_t* pI2Cx) {
+	uint32_t temp;
+	temp = pI2Cx->SR1;
+	temp = pI2Cx->SR2;
+	(void) temp; //resolve unused variable warning
+}
+
+/*****************************************************
+ * @fn					- clearFlagSTOPF
+ *
+ * @brief				- clear the Stop condition
+ *
+ * @param[in]			- base address of the I2C peripheral
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void clearFlagSTOPF(I2C_Reg_t* pI2Cx) {
+	uint16_t temp;
+	temp = pI2Cx->SR1; //reading the SR1 register
+	pI2Cx->CR1 |= 0x0000; //write to CR1 register
+	(void) temp;
+}
+
+/*****************************************************
+ * @fn					- ctrlBitACK
+ *
+ * @brief				- Enable or Disable the ACK bit
+ *
+ * @param[in]			- Base address of a specific I2C peripheral
+ * @param[in]			- ENABLE or DISABLE macro
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void ctrlBitACK(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
+	BITBAND_PERIPH(pI2Cx->CR1, I2C_CR1_ACK) = EnOrDi ? 1U : 0U;
+}
+
+/*****************************************************
+ * @fn					- ctrlBitPOS
+ *
+ * @brief				- Enable or Disable the POS bit
+ *
+ * @param[in]			- Base address of a specific I2C peripheral
+ * @param[in]			- ENABLE or DISABLE macro
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void ctrlBitPOS(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
+	BITBAND_PERIPH(pI2Cx->CR1, I2C_CR1_POS) = EnOrDi ? 1U : 0U;
+}
+
+/*****************************************************
+ * @fn					- sendAddressToSlaveWrite
+ *
+ * @brief				- address transmission to slave with the r/w bit LOW (transmitting)
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- slave address
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void sendAddressToSlaveWrite(I2C_Reg_t* pI2Cx, uint8_t pSlaveAddress) {
+	 //Write the slave address to DR register
+	pI2Cx->DR = (pSlaveAddress << 1);
+}
+
+/*****************************************************
+ * @fn					- sendAddressToSlaveRead
+ *
+ * @brief				- address transmission to slave with the r/w bit HIGH (receiving)
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- slave address
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void sendAddressToSlaveRead(I2C_Reg_t* pI2Cx, uint8_t pSlaveAddress) {
+
+	//Write the slave address to DR register
+	//with the r/w bit high at the end
+	pI2Cx->DR = (pSlaveAddress << 1) | 0x1;
+}
+
+/*****************************************************
+ * @fn					- singleDataRecepHandler
+ *
+ * @brief				- Handle the case with single byte reception
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- repeated start condition set or reset
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- none
+ */
+static uint8_t singleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t repeatedStart) {
+	uint8_t status;
+
+	//In the even of having 1 byte reception, the Acknowledge bit must be disabled
+	//in the EV6 before clearing the ADDR flag
+	ctrlBitACK(pI2Cx, DISABLE);
 
-					//Application Call back
-					I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_RX_CMPLT);
-				}
-			} else { //Slave mode
-				if (!I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_TRA)) { //receiver mode
-					I2C_ApplicationEventCallBack(pI2CHandler, I2C_EVT_DATA_RCV);
-				}
-			}
-		}
+	//clear the ADDR flag
+	clearFlagADDR(pI2Cx);
+
+	//Wait until the RXNE is set (DR is not empty)
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_RXNE);
+	if (status != I2C_OK) {
+		return status;
+	}
+
+	if (!repeatedStart) {
+		//generate stop condition
+		generateStopCondition(pI2Cx);
+	}
+
+	//Finally read the 1 byte data into the buffer
+	*pRxBuffer =  pI2Cx->DR;
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- I2C_ER_IRQHandling
+ * @fn					- multipleDataRecepHandler
  *
- * @brief				- This function provide handle implementation for all I2C event interrupts
+ * @brief				- handle multiple byte reception
  *
- * @param[in]			- I2C handle structure
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- buffer for reception (RxBuffer)
+ * @param[in]			- length of the buffer (len)
+ * @param[in]			- repeatedStart condition set or reset
  *
- * @return				- none
+ * @return				- I2C_OK or I2C_ERR_xxx
  * @note				- none
  */
-void I2C_ER_IRQHandling(I2C_Handle_t* pI2CHandler) {
-	uint32_t temp, temp1;
-	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+static uint8_t multipleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint32_t len, uint8_t repeatedStart) {
+	uint8_t status;
 
-	//Check the status of the error interrupt flag
-	temp1 = pI2Cx->CR2 & (1 << I2C_CR2_ITBUFEN);
-
-/**************************************BERR_ERROR_INTERRUPT*********************************************/
-	//This error occurs when the I2C interface detects an external Stop
-	//Start condition during an address or a data transfer.
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_BERR);
-	if (temp && temp1) {
+	//Set the POS bit if len is 2
+	if (len == 2) {
+		ctrlBitPOS(pI2Cx, ENABLE);
+	}
 
-		//Clear the BERR flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_BERR;
+	//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
+	//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
+	//this case). Clear this by reading SR1 register followed by reading SR2
+	clearFlagADDR(pI2Cx);
 
-		//In master mode: the lines are not released, and the state of the
-		//current transmission is not affected. It is up to software to abort
-		//or not the current transmission. In this implemenetation, I decided
-		//to close the transmission instead.
-		if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+	while (len) {
 
-			//Close the master transmission
-			generateStopCondition(pI2Cx);
-			closeMasterTx(pI2CHandler);
+		//Polling until the Transmit register buffer is empty (RXNE = 1)
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_RXNE);
+		if (status != I2C_OK) {
+			return status;
 		}
 
-		//In slave mode, data are discarded and the lines are released by hardware
-		else {
-			//Implement later
+		//Closing the master reception at the second last byte
+		//by sending the NACK to the slave
+		if (len == 2) {
+			ctrlBitACK(pI2Cx, DISABLE);
+
+			if (!repeatedStart) {
+				//generate stop condition
+				generateStopCondition(pI2Cx);
+			}
 		}
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_BERR);
+
+		//Read the DR register
+		*pRxBuffer = pI2Cx->DR;
+		len--;
+		pRxBuffer++; //increment a byte
 	}
+	return I2C_OK;
+}
 
+/*****************************************************
+ * @fn					- closeMasterTx
+ *
+ * @brief				- close the master transmission
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void closeMasterTx(I2C_Handle_t* pI2CHandler) {
 
-/**************************************AF_ERROR_INTERRUPT*********************************************/
-	//This error occurs when the interface detects a nonacknowledge bit.
-	//Note: A transmitter that receives NACK should reset the transmission
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_AF);
-	if (temp && temp1) {
+	//Reset the interrupt buffer and event
+	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
+	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
 
-		//Clear the AF flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_AF;
+	releaseDMA(pI2CHandler);
 
-		//In master mode, a stop or repeated start condition must
-		//be generated by software
-		if (I2C_CheckStatusFlag(&pI2Cx->SR2, I2C_FLAG_SR2_SML)) { //Master mode
+	//Reset all the global fields
+	pI2CHandler->TxRxState = I2C_READY;
+	pI2CHandler->pTxBuffer = NULL;
+	pI2CHandler->TxLen = 0;
+	pI2CHandler->MemAddrLen = 0;
+	pI2CHandler->MemRxPending = RESET;
+}
 
-			//Close the master transmission by
-			//generating the stop condition
-			generateStopCondition(pI2Cx);
-			closeMasterTx(pI2CHandler);
-		}
+/*****************************************************
+ * @fn					- closeMasterRx
+ *
+ * @brief				- close the master receiver
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void closeMasterRx(I2C_Handle_t* pI2CHandler) {
 
-		//In slave mode, data are discarded and the lines are released by hardware
-		//Note: In slave transmitter mode, the AF bit signals the end of slave transmission,
-		//		as master sends NACK which results in AF bit HIGH to close the communication
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_AF);
+	//Reset the interrupt buffer and event
+	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
+	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
 
-	}
+	releaseDMA(pI2CHandler);
 
-/**************************************ARLO_ERROR_INTERRUPT*********************************************/
-	//This error occurs when the I2C interface detects an arbitration lost condition
-	//This happens all the more often in the multi-master communication
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_ARLO);
-	if (temp && temp1) {
+	//Reset all the global fields
+	pI2CHandler->TxRxState = I2C_READY;
+	pI2CHandler->pRxBuffer = NULL;
+	pI2CHandler->RxSize = 0;
+	pI2CHandler->RxLen = 0;
+	pI2CHandler->MemAddrLen = 0;
+	pI2CHandler->MemRxPending = RESET;
 
-		//Clear the ARLO flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_ARLO;
+	//POS only applies to the 2-byte reception
+	ctrlBitPOS(pI2CHandler->pI2Cx, DISABLE);
 
-		//Note: When this flag is set, the I2C interface goes automatically back to
-		//slave mode (the MSL bit is cleared). Whe the I2C loses the arbitration, it
-		//is not able to acknowledge its slave address in the same transfer
-		//Lines are released by hardware
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_ARLO);
+	//Re-enable the ACKking
+	if (pI2CHandler->I2C_Config.ACKControl == ENABLE) {
+		ctrlBitACK(pI2CHandler->pI2Cx, ENABLE);
 	}
+}
 
-/***************************************OVR_ERROR_INTERRUPT********************************************/
-	//An overrun error can occur in slave mode while underrun can occur in
-	//master mode. This is when clock stretching is disabled and the I2C interface
-	//is receiving data. The interface has received a byte (RXNE = 1) and the data in
-	//DR has not been read, before the next byte is received by the interface, which
-	//results in the loss of the newly received byte.
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_OVR);
-	if (temp && temp1) {
-
-		//Clear the OVR flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_OVR;
+/*****************************************************
+ * @fn					- masterStartWrite
+ *
+ * @brief				- Generate the START and send the slave address with the r/w bit LOW
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- Returns once ADDR is cleared, ready for the first data byte
+ */
+static uint8_t masterStartWrite(I2C_Handle_t* pI2CHandler, uint16_t pSlaveAddress) {
+	uint8_t status;
 
-		//Report to the user application
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_OVR);
+	status = masterStart(pI2CHandler);
+	if (status != I2C_OK) {
+		return status;
 	}
 
-/***************************************OVR_ERROR_INTERRUPT********************************************/
-	//Handle for PECERR error interrupt. For more details, see STM32F407xx Reference Manual
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_PECERR);
-	if (temp && temp1) {
-
-		//Clear the PECERR flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_PECERR;
-
-		//Report to the user application
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_PECERR);
+	status = masterSendAddress(pI2CHandler, pSlaveAddress, RESET);
+	if (status == I2C_OK) {
+		clearFlagADDR(pI2CHandler->pI2Cx);
 	}
+	return status;
+}
 
-/***************************************OVR_ERROR_INTERRUPT********************************************/
-	//Handle for TIMEOUT error interrupt. For more details, see STM32F407xx Reference Manual
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_TIMEOUT);
-	if (temp && temp1) {
-
-		//Clear the TIMEOUT flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_TIMEOUT;
+/*****************************************************
+ * @fn					- sendMemAddress
+ *
+ * @brief				- Send the register address of the slave (MSB first)
+ *
+ * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- Blocking
+ */
+static uint8_t sendMemAddress(I2C_Reg_t* pI2Cx, uint16_t memAddress, uint8_t memAddrSize) {
+	uint8_t status;
 
-		//Report to the user application
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_TIMEOUT);
+	if (memAddrSize == I2C_MEM_ADDR_SIZE_16BIT) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_TXE);
+		if (status != I2C_OK) {
+			return status;
+		}
+		pI2Cx->DR = (uint8_t) (memAddress >> 8);
 	}
-
-/***************************************SMBALERT_ERROR_INTERRUPT***************************************/
-	//Handle for SMBALERT error interrupt. For more details, see STM32F407xx Reference Manual
-	temp = I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_SMBALERT);
-	if (temp && temp1) {
-
-		//Clear the SMBALERT flag
-		pI2Cx->SR1 &= ~I2C_FLAG_SR1_SMBALERT;
-
-		//Report to the user application
-		I2C_ApplicationEventCallBack(pI2CHandler, I2C_ERR_SMBALERT);
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_TXE);
+	if (status == I2C_OK) {
+		pI2Cx->DR = (uint8_t) memAddress;
 	}
+	return status;
 }
 
 /*****************************************************
- * @fn					- I2C_ER_InterruptCtrl
+ * @fn					- setMemAddress
  *
- * @brief				- Enable or disable the interrupt function mode.
+ * @brief				- Load the register address sent by the TXE interrupt
  *
- * @param[in]			- Base address of specific I2C peripherals
- * @param[in]			- Enable or Disable macros
+ * @param[in]			- I2C handle structure
+ * @param[in]			- register address
+ * @param[in]			- register address width @I2C_MEM_ADDR_SIZE
  *
  * @return				- none
- * @note				- This function is ostensibly designed for slave mode only
+ * @note				- MemAddr is sent from the last byte down: MemAddr[1] is the MSB
  */
-void I2C_InterruptCtrl(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
-	if (EnOrDi) {
-		pI2Cx->CR2 |= 1 << I2C_CR2_ITBUFEN;
-		pI2Cx->CR2 |= 1 << I2C_CR2_ITEVTEN;
-		pI2Cx->CR2 |= 1 << I2C_CR2_ITERREN;
-	} else {
-		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
-		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
-		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITERREN);
-	}
+static void setMemAddress(I2C_Handle_t* pI2CHandler, uint16_t memAddress, uint8_t memAddrSize) {
+	pI2CHandler->MemAddr[0] = (uint8_t) memAddress;
+	pI2CHandler->MemAddr[1] = (uint8_t) (memAddress >> 8);
+	pI2CHandler->MemAddrLen = (memAddrSize == I2C_MEM_ADDR_SIZE_16BIT) ? 2U : 1U;
 }
 
 /*****************************************************
- * @fn					- I2C_ApplicationEventCallBack
+ * @fn					- abortMasterXfer
  *
- * @brief				- Inform the user application of the event status
- * 						  This API is of essence in slave mode, where the transmission
- * 						  and reception of data are handled here
+ * @brief				- Close the master transfer in progress after an error
  *
- * @param[in]			- I2C Handle structure
- * @param[in]			- event status macros
+ * @param[in]			- I2C handle structure
  *
  * @return				- none
- * @note				- weak implementation for user application to implement
+ * @note				- none
  */
-__weak void I2C_ApplicationEventCallBack(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
-	//This API is implemented by the user application
+static void abortMasterXfer(I2C_Handle_t* pI2CHandler) {
+	if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX) {
+		closeMasterRx(pI2CHandler);
+	} else {
+		closeMasterTx(pI2CHandler);
+	}
 }
 
 /*****************************************************
- * @fn					- getAPB1ClkFreq();
+ * @fn					- completeXfer
  *
- * @brief				- This helper function returns the current I2C clock frequency APB1
- * 						  bus is supplying to this peripheral
+ * @brief				- Report the end of a master transfer and start the next queued one
  *
- * @param[in]			-
+ * @param[in]			- I2C handle structure
+ * @param[in]			- I2C_EVT_TX_CMPLT, I2C_EVT_RX_CMPLT or I2C_ERR_xxx
  *
  * @return				- none
- * @note				- See the Clock Tree diagram in STM32F4xx Reference Manual for details
+ * @note				- Transactions of the queue report to their own callback,
+ * 						  direct IT transfers to I2C_ApplicationEventCallBack
  */
-static uint32_t getAPB1ClkFreq() {
+static void completeXfer(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
+	I2C_Transaction_t* pXfer = pI2CHandler->Queue.pActive;
+
+	if (pXfer != NULL) {
+		pI2CHandler->Queue.pActive = NULL;
+		pXfer->Status = (appEvt == I2C_EVT_TX_CMPLT || appEvt == I2C_EVT_RX_CMPLT) ? I2C_XFER_DONE : I2C_XFER_ERROR;
+		if (pXfer->Callback != NULL) {
+			pXfer->Callback(pXfer, appEvt);
+		} else {
+			I2C_ApplicationEventCallBack(pI2CHandler, appEvt);
+		}
+	} else {
+		I2C_ApplicationEventCallBack(pI2CHandler, appEvt);
+	}
 
-	uint16_t temp, AHB1Prescalar,  APB1Prescalar;
-	uint16_t AHB1PreSclr[9] = {1, 2, 4, 6, 16, 64, 128, 256, 512};
-	uint16_t APB1PreSclr[5] = {1, 2, 4, 8, 16};
-	uint32_t sysClk;
+	startNextXfer(pI2CHandler);
+}
 
-	//Determine what system clock the MCU is running
-	switch ((RCC->CFGR >> 2U) & 0x3) {
-	case RCC_HSE:	sysClk = HSE_CLK_FREQ; break; //8MHz
-	case RCC_HSI:	sysClk = HSI_CLK_FREQ; break; //16MHz
-	case RCC_PLL:	sysClk = getPLLClkFreq(); break; //See this function implementation for details
+/*****************************************************
+ * @fn					- startNextXfer
+ *
+ * @brief				- Start the next queued transaction if the bus is free
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- Called from I2C_QueueSubmit, I2C_QueueService and from the
+ * 						  completion interrupt. Never waits: while the previous STOP is
+ * 						  still on the bus the transaction stays queued, the next
+ * 						  I2C_QueueSubmit or I2C_QueueService starts it
+ */
+static void startNextXfer(I2C_Handle_t* pI2CHandler) {
+	I2C_Queue_t* pQueue = &pI2CHandler->Queue;
+	I2C_Transaction_t* pXfer;
+	uint32_t primask;
+
+	ENTER_CRITICAL(primask);
+	//The previous STOP must be out before START is requested again, otherwise
+	//the write to CR1 can trigger a second STOP
+	if (pQueue->pSlots == NULL || pQueue->pActive != NULL || pI2CHandler->RetryPending ||
+		pQueue->Head == pQueue->Tail || pI2CHandler->TxRxState != I2C_READY ||
+		(pI2CHandler->pI2Cx->CR1 & (1 << I2C_CR1_STOP))) {
+		EXIT_CRITICAL(primask);
+		return;
 	}
+	pXfer = pQueue->pSlots[pQueue->Tail & (pQueue->Size - 1U)];
+	pQueue->Tail++;
+	pQueue->pActive = pXfer;
+	pXfer->Status = I2C_XFER_ACTIVE;
+
+	switch (pXfer->Type) {
+	//The DMA variants fall back to interrupts when no stream is attached
+	case I2C_XFER_WRITE:
+		I2C_MasterSendDataDMA(pI2CHandler, pXfer->pBuffer, pXfer->Len, pXfer->SlaveAddress, I2C_SR_RESET);
+		break;
+	case I2C_XFER_READ:
+		I2C_MasterReceiveDataDMA(pI2CHandler, pXfer->pBuffer, pXfer->Len, pXfer->SlaveAddress, I2C_SR_RESET);
+		break;
+	case I2C_XFER_MEM_WRITE:
+		I2C_MemWriteIT(pI2CHandler, pXfer->SlaveAddress, pXfer->MemAddress, pXfer->MemAddrSize, pXfer->pBuffer, pXfer->Len);
+		break;
+	case I2C_XFER_MEM_READ:
+	default:
+		I2C_MemReadDMA(pI2CHandler, pXfer->SlaveAddress, pXfer->MemAddress, pXfer->MemAddrSize, pXfer->pBuffer, pXfer->Len);
+		break;
+	}
+	EXIT_CRITICAL(primask);
+}
 
-	//Determine the prescalar factor AHB1 is using
-	temp = (RCC->CFGR >> 4U) & 0xF;
-	AHB1Prescalar = (temp < 8U) ? AHB1PreSclr[0] : AHB1PreSclr[temp % 8 + 1];
-
-	//Determine the prescalar factor APB1 is using
-	temp = (RCC->CFGR >> 10U) & 0x7;
-	APB1Prescalar = (temp < 4U) ? APB1PreSclr[0] : APB1PreSclr[temp % 8 + 1];
+/*****************************************************
+ * @fn					- startRxDMA
+ *
+ * @brief				- Arm the Rx stream and hand RXNE over to the DMA
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- LAST: the hardware NACKs the byte of the DMA end of transfer
+ */
+static void startRxDMA(I2C_Handle_t* pI2CHandler) {
+	DMA_Start(pI2CHandler->pDMARx, (uint32_t) &pI2CHandler->pI2Cx->DR,
+			  (uint32_t) pI2CHandler->pRxBuffer, (uint16_t) pI2CHandler->RxLen);
+	pI2CHandler->pI2Cx->CR2 |= (1 << I2C_CR2_DMAEN) | (1 << I2C_CR2_LAST);
+}
 
-	//Return the APB1 clock freq
-	return (sysClk / AHB1Prescalar) / APB1Prescalar;
+/*****************************************************
+ * @fn					- releaseDMA
+ *
+ * @brief				- Stop the stream of the DMA transfer in progress, if any
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- none
+ * @note				- Called by closeMasterTx/closeMasterRx
+ */
+static void releaseDMA(I2C_Handle_t* pI2CHandler) {
+	if (pI2CHandler->XferDMA == I2C_DMA_NONE) {
+		return;
+	}
+	pI2CHandler->pI2Cx->CR2 &= ~((1 << I2C_CR2_DMAEN) | (1 << I2C_CR2_LAST));
+	DMA_Stop(pI2CHandler->XferDMA == I2C_DMA_TX ? pI2CHandler->pDMATx : pI2CHandler->pDMARx);
+	pI2CHandler->XferDMA = I2C_DMA_NONE;
 }
 
 /*****************************************************
- * @fn					- getPLLClkFreq();
+ * @fn					- dmaEventCallback
  *
- * @brief				- This helper function returns the current I2C clock frequency PLL
- * 						  bus is supplying to this peripheral
+ * @brief				- Stream callback of the I2C DMA transfers
  *
- * @param[in]			-
+ * @param[in]			- DMA handle structure (pContext is the I2C handle)
+ * @param[in]			- DMA event macros
  *
  * @return				- none
- * @note				- See the Clock Tree diagram in STM32F4xx Reference Manual for details
+ * @note				- Only the end of reception is reported here, the end of
+ * 						  transmission waits for BTF in I2C_EV_IRQHandling
  */
-static uint32_t getPLLClkFreq() {
-
-	//Implemented later
-	return 1;
+static void dmaEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt) {
+	I2C_Handle_t* pI2CHandler = (I2C_Handle_t*) pDMAHandler->pContext;
+
+	if (appEvt == DMA_EVT_TRANSFER_CMPLT) {
+		if (pDMAHandler == pI2CHandler->pDMARx && pI2CHandler->XferDMA == I2C_DMA_RX) {
+			//The last byte is already NACKed (LAST), program the STOP now
+			if (!pI2CHandler->RepeatedStart) {
+				generateStopCondition(pI2CHandler->pI2Cx);
+			}
+			closeMasterRx(pI2CHandler);
+			completeXfer(pI2CHandler, I2C_EVT_RX_CMPLT);
+		}
+	} else if (appEvt != DMA_EVT_HALF_CMPLT && pI2CHandler->XferDMA != I2C_DMA_NONE) {
+		generateStopCondition(pI2CHandler->pI2Cx);
+		abortMasterXfer(pI2CHandler);
+		completeXfer(pI2CHandler, I2C_ERR_DMA);
+	}
 }
 
+
 /*****************************************************
- * @fn					- generateStartCondition()
+ * @fn					- regMapWrite
  *
- * @brief				- helper function that generates the start condition for master
+ * @brief				- Handle a byte written by the master into the slave register map
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- register map structure
+ * @param[in]			- received byte
  *
  * @return				- none
- * @note				- none
+ * @note				- The first byte of a write transaction sets the pointer,
+ * 						  out of range pointers wrap around
  */
-static void generateStartCondition(I2C_Reg_t* pI2Cx) {
-	pI2Cx->CR1 |= 1 << I2C_CR1_START;
+static void regMapWrite(I2C_RegMap_t* pRegMap, uint8_t data) {
+	uint16_t pointer = pRegMap->Pointer;
+	uint8_t mask;
+
+	if (pRegMap->AddrPhase) {
+		pRegMap->AddrPhase = RESET;
+		pRegMap->Pointer = data % pRegMap->Size;
+		return;
+	}
+
+	mask = (pRegMap->pWriteMask != NULL) ? pRegMap->pWriteMask[pointer] : 0xFF;
+	if (mask) {
+		pRegMap->pRegs[pointer] = (pRegMap->pRegs[pointer] & ~mask) | (data & mask);
+
+		//Track the written range (read-only registers inside it included)
+		//for the notification after STOP
+		if (pRegMap->ChangeLen == 0) {
+			pRegMap->ChangeStart = pointer;
+		}
+		pRegMap->ChangeLen = ((pointer + pRegMap->Size - pRegMap->ChangeStart) % pRegMap->Size) + 1U;
+	}
+	pRegMap->Pointer = (pointer + 1U) % pRegMap->Size;
 }
 
 /*****************************************************
- * @fn					- generateStopCondition()
+ * @fn					- usToCycles
  *
- * @brief				- helper function that generates the stop condition for master
+ * @brief				- Convert a duration to DWT cycles
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- duration in microseconds
  *
- * @return				- none
+ * @return				- number of HCLK cycles
  * @note				- none
  */
-static void generateStopCondition(I2C_Reg_t* pI2Cx) {
-	pI2Cx->CR1 |= 1 << I2C_CR1_STOP;
+static uint32_t usToCycles(uint32_t us) {
+	return (RCC_GetHCLKFreq() / 1000000U) * us;
 }
 
 /*****************************************************
- * @fn					- clearFlagSB()
+ * @fn					- delayUs
  *
- * @brief				- helper function that clear the SB status flag
+ * @brief				- Busy wait on the DWT cycle counter
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- duration in microseconds
  *
  * @return				- none
  * @note				- none
  */
-static void clearFlagSB(I2C_Reg_t* pI2Cx) {
-	uint32_t temp;
-	temp = pI2Cx->SR1;
-	(void) temp; //resolve unused variable warning
+static void delayUs(uint32_t us) {
+	uint32_t start = DWT_CYCCNT;
+	uint32_t cycles = usToCycles(us);
+
+	while ((DWT_CYCCNT - start) < cycles);
 }
 
 /*****************************************************
- * @fn					- clearFlagADDR()
+ * @fn					- waitFlag
  *
- * @brief				- helper function that clear the ADDR status flag
+ * @brief				- Poll a SR1 flag of the blocking API with a timeout
  *
  * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
+ * @param[in]			- @I2C SR1 Status Flag
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_OK, I2C_ERR_AF/ARLO/BERR or I2C_ERR_TIMEOUT
+ * @note				- A NACK, a lost arbitration or a bus error never sets the
+ * 						  flag awaited, they end the wait at once
  */
-static void clearFlagADDR(I2C_Reg_t* pI2Cx) {
-	uint32_t temp;
-	temp = pI2Cx->SR1;
-	temp = pI2Cx->SR2;
-	(void) temp; //resolve unused variable warning
+static uint8_t waitFlag(I2C_Reg_t* pI2Cx, uint32_t flag) {
+	uint32_t start = DWT_CYCCNT;
+	uint32_t timeout = usToCycles(I2C_STEP_TIMEOUT_US);
+	uint32_t sr1;
+
+	while (!((sr1 = pI2Cx->SR1) & flag)) {
+		if (sr1 & I2C_FLAG_SR1_AF) {
+			return I2C_ERR_AF;
+		}
+		if (sr1 & I2C_FLAG_SR1_ARLO) {
+			return I2C_ERR_ARLO;
+		}
+		if (sr1 & I2C_FLAG_SR1_BERR) {
+			return I2C_ERR_BERR;
+		}
+		if ((DWT_CYCCNT - start) > timeout) {
+			return I2C_ERR_TIMEOUT;
+		}
+	}
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- clearFlagSTOPF
+ * @fn					- masterStart
  *
- * @brief				- clear the Stop condition
+ * @brief				- Generate the START of a blocking transfer and wait for SB
  *
- * @param[in]			- base address of the I2C peripheral
+ * @param[in]			- I2C handle structure
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- A bus still busy after I2C_STEP_TIMEOUT_US is recovered first.
+ * 						  BUSY is expected while the master holds the bus for a repeated start
  */
-static void clearFlagSTOPF(I2C_Reg_t* pI2Cx) {
-	uint16_t temp;
-	temp = pI2Cx->SR1; //reading the SR1 register
-	pI2Cx->CR1 |= 0x0000; //write to CR1 register
-	(void) temp;
+static uint8_t masterStart(I2C_Handle_t* pI2CHandler) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint32_t start = DWT_CYCCNT;
+	uint8_t status;
+
+	if (!(pI2Cx->SR2 & I2C_FLAG_SR2_SML)) {
+		while (pI2Cx->SR2 & I2C_FLAG_SR2_BUSY) {
+			if ((DWT_CYCCNT - start) > usToCycles(I2C_STEP_TIMEOUT_US)) {
+				countError(pI2CHandler, I2C_ERR_TIMEOUT);
+				status = I2C_BusRecovery(pI2CHandler);
+				if (status != I2C_OK) {
+					return status;
+				}
+				break;
+			}
+		}
+	}
+
+	generateStartCondition(pI2Cx);
+	return waitFlag(pI2Cx, I2C_FLAG_SR1_SB);
 }
 
 /*****************************************************
- * @fn					- ctrlBitACK
+ * @fn					- abortBlocking
  *
- * @brief				- Enable or Disable the ACK bit
+ * @brief				- Release the bus after an error of the blocking API
  *
- * @param[in]			- Base address of a specific I2C peripheral
- * @param[in]			- ENABLE or DISABLE macro
+ * @param[in]			- I2C handle structure
+ * @param[in]			- I2C_ERR_xxx returned by the failed step
  *
- * @return				- none
- * @note				- none
+ * @return				- the error, passed through
+ * @note				- AF/BERR: the master still owns the bus and sends STOP.
+ * 						  ARLO: the hardware already switched back to slave.
+ * 						  TIMEOUT: the state is unknown, the bus is recovered
  */
-static void ctrlBitACK(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
-	if (EnOrDi) {
-		pI2Cx->CR1 |= (1 << I2C_CR1_ACK);
-	} else {
-		pI2Cx->CR1 &= ~(1 << I2C_CR1_ACK);
+static uint8_t abortBlocking(I2C_Handle_t* pI2CHandler, uint8_t status) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+
+	countError(pI2CHandler, status);
+
+	switch (status) {
+	case I2C_ERR_AF:
+	case I2C_ERR_BERR:
+		generateStopCondition(pI2Cx);
+		break;
+	case I2C_ERR_TIMEOUT:
+		I2C_BusRecovery(pI2CHandler);
+		break;
+	default:
+		//I2C_ERR_ARLO, I2C_ERR_BUS_STUCK (recovery already done),
+		//I2C_ERR_PECERR/I2C_ERR_BLOCK_SIZE (STOP already sent)
+		break;
+	}
+
+	//Write 0 to clear the error flags (rc_w0)
+	pI2Cx->SR1 = ~(I2C_FLAG_SR1_AF | I2C_FLAG_SR1_ARLO | I2C_FLAG_SR1_BERR);
+
+	ctrlBitPOS(pI2Cx, DISABLE);
+	if (pI2CHandler->I2C_Config.ACKControl == ENABLE) {
+		ctrlBitACK(pI2Cx, ENABLE);
 	}
+	return status;
 }
 
 /*****************************************************
- * @fn					- ctrlBitPOS
+ * @fn					- countError
  *
- * @brief				- Enable or Disable the POS bit
+ * @brief				- Update the error statistics of the bus
  *
- * @param[in]			- Base address of a specific I2C peripheral
- * @param[in]			- ENABLE or DISABLE macro
+ * @param[in]			- I2C handle structure
+ * @param[in]			- I2C_ERR_xxx
  *
  * @return				- none
  * @note				- none
  */
-static void ctrlBitPOS(I2C_Reg_t* pI2Cx, uint8_t EnOrDi) {
-	if (EnOrDi) {
-		pI2Cx->CR1 |= (1 << I2C_CR1_POS);
-	} else {
-		pI2Cx->CR1 &= ~(1 << I2C_CR1_POS);
+static void countError(I2C_Handle_t* pI2CHandler, uint8_t appEvt) {
+	I2C_ErrorStats_t* pStats = &pI2CHandler->Stats;
+
+	switch (appEvt) {
+	case I2C_ERR_BERR:		pStats->BERR++;		break;
+	case I2C_ERR_AF:		pStats->AF++;		break;
+	case I2C_ERR_ARLO:		pStats->ARLO++;		break;
+	case I2C_ERR_OVR:		pStats->OVR++;		break;
+	case I2C_ERR_PECERR:	pStats->PECERR++;	break;
+	case I2C_ERR_TIMEOUT:	pStats->Timeout++;	break;
+	default:									break;
 	}
 }
 
 /*****************************************************
- * @fn					- sendAddressToSlaveWrite
+ * @fn					- setPinMode
  *
- * @brief				- address transmission to slave with the r/w bit LOW (transmitting)
+ * @brief				- Change the mode of one GPIO pin, the other settings are kept
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- slave address
+ * @param[in]			- Base address of the GPIO port
+ * @param[in]			- pin number
+ * @param[in]			- GPIO_OUTPUT_MODE or GPIO_ALT_FUNC_MODE
  *
  * @return				- none
  * @note				- none
  */
-static void sendAddressToSlaveWrite(I2C_Reg_t* pI2Cx, uint8_t pSlaveAddress) {
-	 //Write the slave address to DR register
-	pI2Cx->DR = (pSlaveAddress << 1);
+static void setPinMode(GPIO_Reg_t* pGPIOx, uint8_t pinNumber, uint8_t mode) {
+	pGPIOx->MODER = (pGPIOx->MODER & ~(0x3U << (2 * pinNumber))) | ((uint32_t) mode << (2 * pinNumber));
 }
 
 /*****************************************************
- * @fn					- sendAddressToSlaveRead
+ * @fn					- sendBytes
  *
- * @brief				- address transmission to slave with the r/w bit HIGH (receiving)
+ * @brief				- Send bytes of data on TXE (blocking)
  *
  * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- slave address
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
  *
- * @return				- none
+ * @return				- I2C_OK or I2C_ERR_xxx
  * @note				- none
  */
-static void sendAddressToSlaveRead(I2C_Reg_t* pI2Cx, uint8_t pSlaveAddress) {
+static uint8_t sendBytes(I2C_Reg_t* pI2Cx, uint8_t* pTxBuffer, uint32_t len) {
+	uint8_t status;
 
-	//Write the slave address to DR register
-	//with the r/w bit high at the end
-	pI2Cx->DR = (pSlaveAddress << 1) | 0x1;
+	while (len) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_TXE);
+		if (status != I2C_OK) {
+			return status;
+		}
+		pI2Cx->DR = *pTxBuffer;
+		len--;
+		pTxBuffer++;
+	}
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- singleDataRecepHandler
+ * @fn					- smbusWrite
  *
- * @brief				- Handle the case with single byte reception
+ * @brief				- Write phase of an SMBus protocol
  *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- buffer for reception (RxBuffer)
- * @param[in]			- repeated start condition set or reset
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- command code, byte count or data (pHeader/headerLen)
+ * @param[in]			- data bytes following the header (pTxBuffer/len)
+ * @param[in]			- SET: end with PEC and STOP, RESET: keep the bus for the repeated start
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_OK or I2C_ERR_xxx
+ * @note				- The PEC bit is set once the last byte has left DR (TXE),
+ * 						  the peripheral then sends its PEC register after it
  */
-static void singleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t repeatedStart) {
-
-	//In the even of having 1 byte reception, the Acknowledge bit must be disabled
-	//in the EV6 before clearing the ADDR flag
-	ctrlBitACK(pI2Cx, DISABLE);
+static uint8_t smbusWrite(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pHeader, uint8_t headerLen,
+						  uint8_t* pTxBuffer, uint32_t len, uint8_t stop) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint8_t status;
 
-	//clear the ADDR flag
-	clearFlagADDR(pI2Cx);
+	status = masterStartWrite(pI2CHandler, slaveAddress);
+	if (status == I2C_OK) {
+		status = sendBytes(pI2Cx, pHeader, headerLen);
+	}
+	if (status == I2C_OK) {
+		status = sendBytes(pI2Cx, pTxBuffer, len);
+	}
+	if (status != I2C_OK) {
+		return status;
+	}
 
-	//Wait until the RXNE is set (DR is not empty)
-	while (!I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE));
+	//A repeated start follows: the last byte must be fully shifted out
+	if (!stop) {
+		return waitFlag(pI2Cx, I2C_FLAG_SR1_BTF);
+	}
 
-	if (!repeatedStart) {
-		//generate stop condition
-		generateStopCondition(pI2Cx);
+	//No PEC for the quick command
+	if ((pI2Cx->CR1 & (1 << I2C_CR1_ENPEC)) && (headerLen + len) > 0) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_TXE);
+		if (status != I2C_OK) {
+			return status;
+		}
+		pI2Cx->CR1 |= (1 << I2C_CR1_PEC);
 	}
 
-	//Finally read the 1 byte data into the buffer
-	*pRxBuffer =  pI2Cx->DR;
+	//The quick command only waits for the address phase
+	if ((headerLen + len) > 0) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_BTF);
+		if (status != I2C_OK) {
+			return status;
+		}
+	}
+	generateStopCondition(pI2Cx);
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- multipleDataRecepHandler
+ * @fn					- smbusRead
  *
- * @brief				- handle multiple byte reception
- *
- * @param[in]			- Base address of the specific I2C peripherals (I2C_Reg_t* pI2Cx)
- * @param[in]			- buffer for reception (RxBuffer)
- * @param[in]			- length of the buffer (len)
- * @param[in]			- repeatedStart condition set or reset
+ * @brief				- Read phase of an SMBus protocol, with the PEC checked by the hardware
  *
- * @return				- none
- * @note				- none
+ * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[out]			- buffer for reception (RxBuffer)
+ * @param[in]			- number of data bytes, or size of the buffer of a block read
+ * @param[out]			- block read: byte count sent by the slave, NULL otherwise
+ *
+ * @return				- I2C_OK or I2C_ERR_xxx (I2C_ERR_PECERR on a wrong PEC)
+ * @note				- The PEC byte is the last one: PEC is set with the NACK and the
+ * 						  STOP once the last data byte is in DR, then PECERR tells
+ * 						  whether the received PEC matched the internal one
  */
-static void multipleDataRecepHandler(I2C_Reg_t* pI2Cx, uint8_t *pRxBuffer, uint8_t len, uint8_t repeatedStart) {
-
-	//Set the POS bit if len is 2
-	if (len == 2) {
-		ctrlBitPOS(pI2Cx, ENABLE);
+static uint8_t smbusRead(I2C_Handle_t* pI2CHandler, uint8_t slaveAddress, uint8_t* pRxBuffer, uint8_t len,
+						 uint8_t* pBlockCount) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint8_t pec = (pI2Cx->CR1 & (1 << I2C_CR1_ENPEC)) ? 1U : 0U;
+	uint32_t remaining = (uint32_t) len + pec;
+	uint8_t status;
+	uint8_t data;
+
+	status = masterStart(pI2CHandler);
+	if (status != I2C_OK) {
+		return status;
 	}
+	clearFlagSB(pI2Cx);
+	sendAddressToSlaveRead(pI2Cx, slaveAddress);
 
-	//As soon as the slave address is sent, the ADDR bit is set by HARDWARE
-	//and an interrupt is generated if the ITEVFEN bit is set (which we don't cover in
-	//this case). Clear this by reading SR1 register followed by reading SR2
-	clearFlagADDR(pI2Cx);
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_ADDR);
+	if (status != I2C_OK) {
+		return status;
+	}
 
-	while (len) {
+	if (pBlockCount == NULL && remaining == 1) {
+		//Single byte: NACK it before ADDR is cleared, STOP right after
+		ctrlBitACK(pI2Cx, DISABLE);
+		clearFlagADDR(pI2Cx);
+		generateStopCondition(pI2Cx);
+	} else {
+		ctrlBitACK(pI2Cx, ENABLE);
+		clearFlagADDR(pI2Cx);
+	}
 
-		//Polling until the Transmit register buffer is empty (RXNE = 1)
-		while (!I2C_CheckStatusFlag(&pI2Cx->SR1, I2C_FLAG_SR1_RXNE));
+	if (pBlockCount != NULL) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_RXNE);
+		if (status != I2C_OK) {
+			return status;
+		}
+		data = pI2Cx->DR;
 
-		//Closing the master reception at the second last byte
-		//by sending the NACK to the slave
-		if (len == 2) {
+		//The first data byte is already on its way: a block that does not fit
+		//ends with it, the same for a block of 1 byte without PEC
+		remaining = (uint32_t) data + pec;
+		if (data > len || remaining <= 1) {
 			ctrlBitACK(pI2Cx, DISABLE);
+			if (pec && data <= len) {
+				pI2Cx->CR1 |= (1 << I2C_CR1_PEC);
+			}
+			generateStopCondition(pI2Cx);
+		}
+		if (data > len || remaining == 0) {
+			waitFlag(pI2Cx, I2C_FLAG_SR1_RXNE);
+			(void) pI2Cx->DR;
+			return I2C_ERR_BLOCK_SIZE;
+		}
+		*pBlockCount = data;
+	}
 
-			if (!repeatedStart) {
-				//generate stop condition
-				generateStopCondition(pI2Cx);
+	while (remaining) {
+		status = waitFlag(pI2Cx, I2C_FLAG_SR1_RXNE);
+		if (status != I2C_OK) {
+			return status;
+		}
+
+		//Second last byte in DR: NACK the last one, checked as the PEC
+		if (remaining == 2) {
+			ctrlBitACK(pI2Cx, DISABLE);
+			if (pec) {
+				pI2Cx->CR1 |= (1 << I2C_CR1_PEC);
 			}
+			generateStopCondition(pI2Cx);
 		}
 
-		//Read the DR register
-		*pRxBuffer = pI2Cx->DR;
-		len--;
-		pRxBuffer++; //increment a byte
+		data = pI2Cx->DR;
+		remaining--;
+
+		//The PEC byte is not part of the data
+		if (!(pec && remaining == 0)) {
+			*pRxBuffer = data;
+			pRxBuffer++;
+		}
+	}
+
+	if (pI2CHandler->I2C_Config.ACKControl == ENABLE) {
+		ctrlBitACK(pI2Cx, ENABLE);
 	}
+
+	if (pec && (pI2Cx->SR1 & I2C_FLAG_SR1_PECERR)) {
+		pI2Cx->SR1 = ~I2C_FLAG_SR1_PECERR;
+		return I2C_ERR_PECERR;
+	}
+	return I2C_OK;
 }
 
 /*****************************************************
- * @fn					- closeMasterTx
+ * @fn					- masterSendAddress
  *
- * @brief				- close the master transmission
+ * @brief				- Send the slave address after SB, in 7 or 10-bit addressing mode
  *
  * @param[in]			- I2C handle structure
+ * @param[in]			- slave address
+ * @param[in]			- SET: address for a reception, RESET: for a transmission
  *
- * @return				- none
- * @note				- none
+ * @return				- I2C_OK (ADDR set, not cleared yet) or I2C_ERR_xxx
+ * @note				- 10-bit: header 11110 A9 A8 0 (ADD10), then A7-A0 (ADDR). A reception
+ * 						  then needs a repeated start with the header and the r/w bit high
  */
-static void closeMasterTx(I2C_Handle_t* pI2CHandler) {
+static uint8_t masterSendAddress(I2C_Handle_t* pI2CHandler, uint16_t slaveAddress, uint8_t read) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint8_t header;
+	uint8_t status;
 
-	//Reset the interrupt buffer and event
-	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
-	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
+	//SB is cleared by reading SR1 followed by writing DR with the address
+	clearFlagSB(pI2Cx);
 
-	//Reset all the global fields
-	pI2CHandler->TxRxState = I2C_READY;
-	pI2CHandler->pTxBuffer = NULL;
-	pI2CHandler->TxLen = 0;
+	if (pI2CHandler->I2C_Config.AddressingMode != I2C_ADDR_MODE_10_BIT) {
+		if (read) {
+			sendAddressToSlaveRead(pI2Cx, (uint8_t) slaveAddress);
+		} else {
+			sendAddressToSlaveWrite(pI2Cx, (uint8_t) slaveAddress);
+		}
+		return waitFlag(pI2Cx, I2C_FLAG_SR1_ADDR);
+	}
+
+	header = I2C_10BIT_HEADER(slaveAddress);
+	pI2Cx->DR = header;
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_ADD10);
+	if (status != I2C_OK) {
+		return status;
+	}
+	pI2Cx->DR = (uint8_t) slaveAddress;
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_ADDR);
+	if (status != I2C_OK || !read) {
+		return status;
+	}
+
+	clearFlagADDR(pI2Cx);
+	generateStartCondition(pI2Cx);
+	status = waitFlag(pI2Cx, I2C_FLAG_SR1_SB);
+	if (status != I2C_OK) {
+		return status;
+	}
+	clearFlagSB(pI2Cx);
+	pI2Cx->DR = header | 0x1;
+	return waitFlag(pI2Cx, I2C_FLAG_SR1_ADDR);
 }
 
 /*****************************************************
- * @fn					- closeMasterRx
+ * @fn					- sendAddressIT
  *
- * @brief				- close the master receiver
+ * @brief				- Send the slave address from the SB event
  *
  * @param[in]			- I2C handle structure
  *
  * @return				- none
- * @note				- none
+ * @note				- 10-bit: the header goes with the r/w bit low until the slave is
+ * 						  addressed (ADD10 then sends A7-A0), then with the r/w bit high
+ * 						  after the repeated start of a reception
  */
-static void closeMasterRx(I2C_Handle_t* pI2CHandler) {
+static void sendAddressIT(I2C_Handle_t* pI2CHandler) {
+	I2C_Reg_t* pI2Cx = pI2CHandler->pI2Cx;
+	uint8_t header;
 
-	//Reset the interrupt buffer and event
-	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
-	pI2CHandler->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
+	if (pI2CHandler->I2C_Config.AddressingMode == I2C_ADDR_MODE_10_BIT) {
+		header = I2C_10BIT_HEADER(pI2CHandler->DeviceAddr);
+		if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX && pI2CHandler->Addr10Read) {
+			header |= 0x1;
+		}
+		pI2Cx->DR = header;
+	} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_TX) { //busy in transmission
+		//clear the SB bit by reading the SR1 register
+		//AND writing slave address to the DR with r/w bit low
+		sendAddressToSlaveWrite(pI2Cx, (uint8_t) pI2CHandler->DeviceAddr);
+	} else if (pI2CHandler->TxRxState == I2C_BUSY_IN_RX) { //busy in reception
+		//Write slave address to DR with r/w bit high
+		sendAddressToSlaveRead(pI2Cx, (uint8_t) pI2CHandler->DeviceAddr);
+	}
+}
 
-	//Reset all the global fields
-	pI2CHandler->TxRxState = I2C_READY;
-	pI2CHandler->pRxBuffer = NULL;
-	pI2CHandler->RxSize = 0;
-	pI2CHandler->RxLen = 0;
+/*****************************************************
+ * @fn					- retryXfer
+ *
+ * @brief				- Put the active transaction back at the head of the queue after ARLO
+ *
+ * @param[in]			- I2C handle structure
+ *
+ * @return				- SET: requeued (restarted by I2C_QueueService), RESET: report the error
+ * @note				- Called from the ER interrupt, the slot in front of Tail is the one
+ * 						  the transaction was taken from unless the queue filled up since
+ */
+static uint8_t retryXfer(I2C_Handle_t* pI2CHandler) {
+	I2C_Queue_t* pQueue = &pI2CHandler->Queue;
+	I2C_Transaction_t* pXfer = pQueue->pActive;
+
+	if (pXfer == NULL || pI2CHandler->Retry.MaxRetries == 0) {
+		return RESET;
+	}
+	if (pXfer->Attempts >= pI2CHandler->Retry.MaxRetries ||
+		(uint8_t) (pQueue->Head - pQueue->Tail) >= pQueue->Size) {
+		pI2CHandler->Stats.RetryExhausted++;
+		return RESET;
+	}
 
+	pXfer->Attempts++;
+	pI2CHandler->Stats.Retry++;
 
+	pQueue->Tail--;
+	pQueue->pSlots[pQueue->Tail & (pQueue->Size - 1U)] = pXfer;
+	pQueue->pActive = NULL;
+	pXfer->Status = I2C_XFER_PENDING;
 
-	//Re-enable the ACKking
-	if (pI2CHandler->I2C_Config.ACKControl == ENABLE) {
-		ctrlBitACK(pI2CHandler->pI2Cx, ENABLE);
+	pI2CHandler->RetryDelay = retryBackoff(pI2CHandler, pXfer->Attempts);
+	pI2CHandler->RetryAt = DWT_CYCCNT;
+	pI2CHandler->RetryPending = SET;
+	return SET;
+}
+
+/*****************************************************
+ * @fn					- retryBackoff
+ *
+ * @brief				- Draw the random backoff of a retry
+ *
+ * @param[in]			- I2C handle structure
+ * @param[in]			- retry number (1 for the first retry)
+ *
+ * @return				- backoff in DWT cycles
+ * @note				- Binary exponential backoff: uniform in [0, window], the window
+ * 						  doubles with each retry up to BackoffMaxUs
+ */
+static uint32_t retryBackoff(I2C_Handle_t* pI2CHandler, uint8_t attempt) {
+	I2C_RetryPolicy_t* pPolicy = &pI2CHandler->Retry;
+	uint32_t window = pPolicy->BackoffUs;
+	uint32_t rnd;
+
+	while (attempt > 1 && window < pPolicy->BackoffMaxUs) {
+		window <<= 1;
+		attempt--;
+	}
+	if (window > pPolicy->BackoffMaxUs) {
+		window = pPolicy->BackoffMaxUs;
 	}
+
+	//The cycle count at the ARLO interrupt differs between the masters, mixed with
+	//the own address (xorshift) so identical boards do not draw the same delay
+	rnd = DWT_CYCCNT ^ (pI2CHandler->pI2Cx->OAR1 << 16);
+	rnd ^= rnd << 13;
+	rnd ^= rnd >> 17;
+	rnd ^= rnd << 5;
+
+	return usToCycles(rnd % (window + 1U));
 }
@@ -0,0 +1,219 @@
+/*
+ * STM32F407xx_ITM_Driver.c
+ *
+ *  Created on: Oct 8, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the ITM/SWO trace driver
+ */
+
+#include "../Inc/STM32F407xx_ITM_Driver.h"
+
+/*****************************************************
+ * @fn					- ITM_Init
+ *
+ * @brief				- Configure the TPIU for SWO and enable the ITM stimulus ports
+ *
+ * @param[in]			- ITM configuration structure
+ *
+ * @return				- none
+ * @note				- SWO prescaler = HCLK / SWO baud rate - 1 (TRACECLKIN = HCLK)
+ */
+void ITM_Init(ITM_Config_t* pITMConfig) {
+	uint32_t hclk, prescaler, tempReg;
+
+	//1. Enable the trace units and route TRACESWO to PB3 (asynchronous mode)
+	DEMCR |= (1 << DEMCR_TRCENA);
+	tempReg = DBGMCU_CR;
+	tempReg &= ~(0x3 << DBGMCU_CR_TRACE_MODE);
+	tempReg |= (1 << DBGMCU_CR_TRACE_IOEN);
+	DBGMCU_CR = tempReg;
+
+	//2. SWO clock: round the prescaler to the closest achievable baud rate
+	hclk = RCC_GetHCLKFreq();
+	prescaler = (hclk + (pITMConfig->SWOBaudRate / 2U)) / pITMConfig->SWOBaudRate;
+	if (prescaler) {
+		prescaler--;
+	}
+	TPIU->CSPSR = 1;							//1-bit port
+	TPIU->ACPR = prescaler & 0x1FFF;
+	TPIU->SPPR = pITMConfig->Protocol;
+	TPIU->FFCR = (1 << TPIU_FFCR_TRIGIN);	//Bypass the formatter, SWO carries raw ITM packets
+
+	//3. Unlock the ITM, then configure it while it is disabled
+	ITM->LAR = ITM_LAR_UNLOCK_KEY;
+	ITM->TCR = 0;
+	while (ITM->TCR & (1 << ITM_TCR_BUSY));
+
+	ITM->TPR = 0;								//All ports accessible from unprivileged code
+	ITM->TER = pITMConfig->PortEnable;
+
+	tempReg = (1U << ITM_TCR_TRACEBUSID) | (1 << ITM_TCR_SYNCENA) | (1 << ITM_TCR_TXENA) | (1 << ITM_TCR_ITMENA);
+	if (pITMConfig->Timestamp == ENABLE) {
+		tempReg |= (1 << ITM_TCR_TSENA);
+	}
+	ITM->TCR = tempReg;
+}
+
+/*****************************************************
+ * @fn					- ITM_GetSWOBaudRate
+ *
+ * @brief				- Return the SWO baud rate actually produced by the prescaler
+ *
+ * @param[in]			- none
+ *
+ * @return				- SWO baud rate in bit/s
+ * @note				- The capture tool must use this value
+ */
+uint32_t ITM_GetSWOBaudRate(void) {
+	return RCC_GetHCLKFreq() / ((TPIU->ACPR & 0x1FFF) + 1U);
+}
+
+/*****************************************************
+ * @fn					- ITM_IsPortEnabled
+ *
+ * @brief				- Check if the ITM and the stimulus port are enabled
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ *
+ * @return				- SET or RESET
+ * @note				- none
+ */
+uint8_t ITM_IsPortEnabled(uint8_t port) {
+	if (!(DEMCR & (1 << DEMCR_TRCENA)) || !(ITM->TCR & (1 << ITM_TCR_ITMENA))) {
+		return RESET;
+	}
+	return (ITM->TER & (1U << port)) ? SET : RESET;
+}
+
+/*****************************************************
+ * @fn					- ITM_Send8
+ *
+ * @brief				- Send a 1-byte packet on a stimulus port
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ * @param[in]			- data
+ *
+ * @return				- none
+ * @note				- Reading STIM returns 1 when the FIFO can accept data
+ */
+void ITM_Send8(uint8_t port, uint8_t data) {
+	if (!ITM_IsPortEnabled(port)) {
+		return;
+	}
+	while (!(ITM->STIM[port] & 1U));
+	*((__vo uint8_t*) &ITM->STIM[port]) = data; //the access size sets the packet size
+}
+
+/*****************************************************
+ * @fn					- ITM_Send16
+ *
+ * @brief				- Send a 2-byte packet on a stimulus port
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ * @param[in]			- data
+ *
+ * @return				- none
+ * @note				- none
+ */
+void ITM_Send16(uint8_t port, uint16_t data) {
+	if (!ITM_IsPortEnabled(port)) {
+		return;
+	}
+	while (!(ITM->STIM[port] & 1U));
+	*((__vo uint16_t*) &ITM->STIM[port]) = data;
+}
+
+/*****************************************************
+ * @fn					- ITM_Send32
+ *
+ * @brief				- Send a 4-byte packet on a stimulus port
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ * @param[in]			- data
+ *
+ * @return				- none
+ * @note				- none
+ */
+void ITM_Send32(uint8_t port, uint32_t data) {
+	if (!ITM_IsPortEnabled(port)) {
+		return;
+	}
+	while (!(ITM->STIM[port] & 1U));
+	ITM->STIM[port] = data;
+}
+
+/*****************************************************
+ * @fn					- ITM_Write
+ *
+ * @brief				- Send a buffer on a stimulus port
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ * @param[in]			- data buffer
+ * @param[in]			- length of the buffer
+ *
+ * @return				- none
+ * @note				- The bytes are packed in 32-bit writes: one 5-byte SWO packet
+ * 						  carries 4 bytes instead of one 2-byte packet per byte.
+ * 						  The remaining 1 - 3 bytes use 16/8-bit writes
+ */
+void ITM_Write(uint8_t port, const uint8_t* pData, uint32_t len) {
+	uint32_t word;
+
+	if (!ITM_IsPortEnabled(port)) {
+		return;
+	}
+
+	while (len >= 4U) {
+		word = (uint32_t) pData[0] | ((uint32_t) pData[1] << 8) | ((uint32_t) pData[2] << 16) | ((uint32_t) pData[3] << 24);
+		while (!(ITM->STIM[port] & 1U));
+		ITM->STIM[port] = word;
+		pData += 4;
+		len -= 4U;
+	}
+	if (len >= 2U) {
+		ITM_Send16(port, (uint16_t) (pData[0] | (pData[1] << 8)));
+		pData += 2;
+		len -= 2U;
+	}
+	if (len) {
+		ITM_Send8(port, pData[0]);
+	}
+}
+
+/*****************************************************
+ * @fn					- ITM_TrySend32
+ *
+ * @brief				- Send a 4-byte packet on a stimulus port without waiting
+ *
+ * @param[in]			- stimulus port (0 - 31)
+ * @param[in]			- data
+ *
+ * @return				- SET if the data is sent or discarded (port disabled),
+ * 						  RESET if the stimulus FIFO is full
+ * @note				- none
+ */
+uint8_t ITM_TrySend32(uint8_t port, uint32_t data) {
+	if (!ITM_IsPortEnabled(port)) {
+		return SET;
+	}
+	if (!(ITM->STIM[port] & 1U)) {
+		return RESET;
+	}
+	ITM->STIM[port] = data;
+	return SET;
+}
+
+/*****************************************************
+ * @fn					- ITM_LogSink
+ *
+ * @brief				- Send one word of the tokenized log stream on ITM_PORT_LOG
+ *
+ * @param[in]			- word of the log stream
+ *
+ * @return				- SET if the word is consumed, RESET if the FIFO is full
+ * @note				- Pass it to LOG_Init(). Decode the capture with
+ * 						  tools/swo_parse.py --raw 1 | tools/log_decode.py
+ */
+uint8_t ITM_LogSink(uint32_t word) {
+	return ITM_TrySend32(ITM_PORT_LOG, word);
+}
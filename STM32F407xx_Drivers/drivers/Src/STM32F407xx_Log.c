@@ -0,0 +1,199 @@
+/*
+ * STM32F407xx_Log.c
+ *
+ *  Created on: Oct 6, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the tokenized (deferred binary) logger
+ */
+
+#include "../Inc/STM32F407xx_Log.h"
+
+#if ((LOG_BUFFER_WORDS & (LOG_BUFFER_WORDS - 1U)) != 0U)
+#error "LOG_BUFFER_WORDS must be a power of 2"
+#endif
+
+/*
+ * Helper function prototypes
+ */
+static uint8_t USARTSink(uint32_t word);
+
+/*
+ * Log ring (free-running indices, see ring_buffer.h)
+ * Note: Several producers (main loop and ISRs) write into the ring, so the
+ * 		 producer side is protected by a critical section. The drain is the only consumer
+ */
+static uint32_t LogBuffer[LOG_BUFFER_WORDS];
+static volatile uint32_t LogHead = 0;
+static volatile uint32_t LogTail = 0;
+static uint32_t LogDropPending = 0;		//records lost since the last LOG_ID_DROPPED record
+static volatile uint32_t LogDropCount = 0;
+static LOG_Sink_t LogSink = NULL;
+static USART_Handle_t* pLogUSART = NULL;
+
+/*****************************************************
+ * @fn					- LOG_Init
+ *
+ * @brief				- Empty the log ring and select the sink of LOG_Drain()
+ *
+ * @param[in]			- sink function (e.g. ITM or USART)
+ *
+ * @return				- none
+ * @note				- The timestamps are HCLK cycles (DWT CYCCNT)
+ */
+void LOG_Init(LOG_Sink_t sink) {
+	LogSink = sink;
+	LogHead = 0;
+	LogTail = 0;
+	LogDropPending = 0;
+	LogDropCount = 0;
+
+	//Enabling the counter resets it: the running DWT deadlines of the other drivers would break
+	if (!(DWT_CTRL & (1 << DWT_CTRL_CYCCNTENA))) {
+		DWT_CYCCNT_EN();
+	}
+}
+
+/*****************************************************
+ * @fn					- LOG_AttachUSART
+ *
+ * @brief				- Send the log stream through the Tx ring of a USART
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ *
+ * @return				- none
+ * @note				- The USART must have a Tx ring attached (USART_AttachTxRing)
+ * 						  and must not be shared with text output
+ */
+void LOG_AttachUSART(USART_Handle_t* pUSARTHandler) {
+	pLogUSART = pUSARTHandler;
+	LOG_Init(USARTSink);
+}
+
+/*****************************************************
+ * @fn					- LOG_Record
+ *
+ * @brief				- Store one log record into the ring
+ *
+ * @param[in]			- format string ID (address in .logstr)
+ * @param[in]			- number of arguments (0 - LOG_MAX_ARGS)
+ * @param[in]			- raw arguments (unused ones are ignored)
+ *
+ * @return				- none
+ * @note				- The record is dropped (and counted) when the ring is full or
+ * 						  when nargs is above LOG_MAX_ARGS (direct calls, LOG() checks it
+ * 						  at compile time). The cost is a few word stores: no formatting
+ * 						  is done here
+ */
+void LOG_Record(uint32_t id, uint32_t nargs, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+	uint32_t primask, head, timestamp, len;
+
+	timestamp = DWT_CYCCNT;
+	len = 2U + nargs;
+
+	ENTER_CRITICAL(primask);
+	head = LogHead;
+
+	//A record only carries LOG_MAX_ARGS arguments, a larger count would break the stream
+	if (nargs > LOG_MAX_ARGS) {
+		LogDropPending++;
+		LogDropCount++;
+		EXIT_CRITICAL(primask);
+		return;
+	}
+
+	//Report the lost records first so the host knows where the gap is
+	if (LogDropPending) {
+		if ((LOG_BUFFER_WORDS - (head - LogTail)) < (len + 3U)) {
+			LogDropPending++;
+			LogDropCount++;
+			EXIT_CRITICAL(primask);
+			return;
+		}
+		LogBuffer[head++ & (LOG_BUFFER_WORDS - 1U)] = (LOG_RECORD_SYNC << 28) | (1U << 24) | LOG_ID_DROPPED;
+		LogBuffer[head++ & (LOG_BUFFER_WORDS - 1U)] = timestamp;
+		LogBuffer[head++ & (LOG_BUFFER_WORDS - 1U)] = LogDropPending;
+		LogDropPending = 0;
+	} else if ((LOG_BUFFER_WORDS - (head - LogTail)) < len) {
+		LogDropPending++;
+		LogDropCount++;
+		EXIT_CRITICAL(primask);
+		return;
+	}
+
+	LogBuffer[head++ & (LOG_BUFFER_WORDS - 1U)] = (LOG_RECORD_SYNC << 28) | (nargs << 24) | (id & LOG_ID_MASK);
+	LogBuffer[head++ & (LOG_BUFFER_WORDS - 1U)] = timestamp;
+	switch (nargs) {
+	case 4: LogBuffer[(head + 3U) & (LOG_BUFFER_WORDS - 1U)] = arg3; /* fall through */
+	case 3: LogBuffer[(head + 2U) & (LOG_BUFFER_WORDS - 1U)] = arg2; /* fall through */
+	case 2: LogBuffer[(head + 1U) & (LOG_BUFFER_WORDS - 1U)] = arg1; /* fall through */
+	case 1: LogBuffer[head & (LOG_BUFFER_WORDS - 1U)] = arg0; /* fall through */
+	default: break;
+	}
+
+	//Publish the record only once it is complete
+	LogHead = head + nargs;
+	EXIT_CRITICAL(primask);
+}
+
+/*****************************************************
+ * @fn					- LOG_Drain
+ *
+ * @brief				- Move the pending words of the ring to the sink
+ *
+ * @param[in]			- none
+ *
+ * @return				- none
+ * @note				- Returns as soon as the sink is busy, so it never blocks
+ */
+void LOG_Drain(void) {
+	uint32_t tail = LogTail;
+
+	if (LogSink == NULL) {
+		return;
+	}
+	while (tail != LogHead) {
+		if (!LogSink(LogBuffer[tail & (LOG_BUFFER_WORDS - 1U)])) {
+			break;
+		}
+		tail++;
+		LogTail = tail;
+	}
+}
+
+/*****************************************************
+ * @fn					- LOG_GetDropCount
+ *
+ * @brief				- Return the number of records lost because the ring was full
+ *
+ * @param[in]			- none
+ *
+ * @return				- number of dropped records
+ * @note				- none
+ */
+uint32_t LOG_GetDropCount(void) {
+	return LogDropCount;
+}
+
+/*****************************************************
+ * @fn					- USARTSink
+ *
+ * @brief				- helper function that queues one word into the USART Tx ring
+ *
+ * @param[in]			- word of the log stream
+ *
+ * @return				- SET if the word is queued, RESET if the Tx ring is full
+ * @note				- The whole word is queued or nothing to keep the stream aligned
+ */
+static uint8_t USARTSink(uint32_t word) {
+	uint8_t bytes[4];
+
+	if (RingBuffer_Free(pLogUSART->pTxRing) < sizeof(bytes)) {
+		return RESET;
+	}
+	bytes[0] = (uint8_t) word;
+	bytes[1] = (uint8_t) (word >> 8);
+	bytes[2] = (uint8_t) (word >> 16);
+	bytes[3] = (uint8_t) (word >> 24);
+	USART_WriteRing(pLogUSART, bytes, sizeof(bytes));
+	return SET;
+}
@@ -0,0 +1,513 @@
+/*
+ * STM32F407xx_OneWire_Driver.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the 1-Wire bus master. Each slot starts
+ *      			 with a DWT time stamp taken on the falling edge, every following
+ *      			 edge and sample waits for an absolute deadline from it
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*
+ * CRC-8 by nibble (x^8 + x^5 + x^4 + 1, reflected: 0x8C)
+ * Note: The CRC is linear, the CRC of a byte is the XOR of the CRC of both nibbles
+ */
+static const uint8_t CRC8Low[16] = {
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41
+};
+static const uint8_t CRC8High[16] = {
+	0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+
+/*
+ * Helper functions
+ */
+static void waitUntil(uint32_t start, uint32_t cycles);
+__force_inline void busLow(OW_Handle_t* pOWHandler);
+__force_inline void busRelease(OW_Handle_t* pOWHandler);
+__force_inline uint8_t busRead(OW_Handle_t* pOWHandler);
+
+/*****************************************************
+ * @fn					- OW_Init
+ *
+ * @brief				- Configure the bus pin as open-drain output and release the bus
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- none
+ * @note				- The output data bit is set before the pin becomes an output,
+ * 						  the bus is never pulled low by the initialization.
+ * 						  The DWT cycle counter is started if it is not running
+ */
+void OW_Init(OW_Handle_t* pOWHandler) {
+	GPIO_PinConfig_t* pPinConfig = &pOWHandler->OW_GPIO.GPIOx_PinConfig;
+
+	GPIO_PeriClkCtrl(pOWHandler->OW_GPIO.pGPIOx, ENABLE);
+	busRelease(pOWHandler);
+
+	pPinConfig->GPIO_PinMode = GPIO_OUTPUT_MODE;
+	pPinConfig->GPIO_PinOPType = GPIO_OPEN_DRAIN;
+	pPinConfig->GPIO_PinSpeed = GPIO_MEDIUM_SPEED;
+	GPIO_Init(&pOWHandler->OW_GPIO);
+
+	pOWHandler->UsCycles = RCC_GetHCLKFreq() / 1000000U;
+	if (!(DWT_CTRL & (1 << DWT_CTRL_CYCCNTENA))) {
+		DWT_CYCCNT_EN();
+	}
+
+	memset(&pOWHandler->Stats, 0, sizeof(pOWHandler->Stats));
+	OW_SearchReset(pOWHandler);
+}
+
+/*****************************************************
+ * @fn					- OW_Reset
+ *
+ * @brief				- Send the reset pulse and look for the presence pulse
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- OW_OK, OW_ERR_NO_PRESENCE or OW_ERR_BUS (bus held low)
+ * @note				- No critical section: a longer reset pulse is still a reset,
+ * 						  and the bus is watched over the whole presence window (the
+ * 						  pulse lasts 60 - 240 us) instead of one sample at a fixed
+ * 						  time, an interrupt in between only skips a few reads
+ */
+uint8_t OW_Reset(OW_Handle_t* pOWHandler) {
+	uint32_t us = pOWHandler->UsCycles;
+	uint32_t start;
+	uint8_t presence = 0;
+
+	pOWHandler->Stats.Resets++;
+
+	start = DWT_CYCCNT;
+	busLow(pOWHandler);
+	waitUntil(start, OW_T_RESET_LOW * us);
+	busRelease(pOWHandler);
+
+	//The devices wait 15 - 60 us before the presence pulse, the bus has
+	//time to rise through the pull-up
+	start = DWT_CYCCNT;
+	waitUntil(start, OW_T_PRESENCE_START * us);
+	while ((DWT_CYCCNT - start) < OW_T_PRESENCE_WAIT * us) {
+		if (!busRead(pOWHandler)) {
+			presence = 1;
+		}
+	}
+	waitUntil(start, OW_T_RESET_REST * us);
+
+	//Still low after every presence pulse has ended: short to ground
+	if (!busRead(pOWHandler)) {
+		return OW_ERR_BUS;
+	}
+	if (!presence) {
+		pOWHandler->Stats.NoPresence++;
+		return OW_ERR_NO_PRESENCE;
+	}
+	return OW_OK;
+}
+
+/*****************************************************
+ * @fn					- OW_WriteBit
+ *
+ * @brief				- Write one bit slot
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- bit value (0 or not 0)
+ *
+ * @return				- none
+ * @note				- Only the low pulse of a 1 (6 us, read as 0 above 15 us) runs
+ * 						  with the interrupts masked. The low pulse of a 0 may last
+ * 						  60 - 120 us and the recovery has no upper bound, an interrupt
+ * 						  there only makes the slot longer
+ */
+void OW_WriteBit(OW_Handle_t* pOWHandler, uint8_t bit) {
+	uint32_t us = pOWHandler->UsCycles;
+	uint32_t primask;
+	uint32_t start;
+
+	if (bit) {
+		ENTER_CRITICAL(primask);
+		start = DWT_CYCCNT;
+		busLow(pOWHandler);
+		waitUntil(start, OW_T_WRITE1_LOW * us);
+		busRelease(pOWHandler);
+		EXIT_CRITICAL(primask);
+		waitUntil(start, (OW_T_WRITE1_LOW + OW_T_WRITE1_REST) * us);
+	} else {
+		start = DWT_CYCCNT;
+		busLow(pOWHandler);
+		waitUntil(start, OW_T_WRITE0_LOW * us);
+		busRelease(pOWHandler);
+		waitUntil(start, (OW_T_WRITE0_LOW + OW_T_WRITE0_REST) * us);
+	}
+}
+
+/*****************************************************
+ * @fn					- OW_ReadBit
+ *
+ * @brief				- Read one bit slot
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- bit read (0 or 1)
+ * @note				- The interrupts are masked from the falling edge to the sample
+ * 						  (15 us, the slave holds a 0 at least that long)
+ */
+uint8_t OW_ReadBit(OW_Handle_t* pOWHandler) {
+	uint32_t us = pOWHandler->UsCycles;
+	uint32_t primask;
+	uint32_t start;
+	uint8_t bit;
+
+	ENTER_CRITICAL(primask);
+	start = DWT_CYCCNT;
+	busLow(pOWHandler);
+	waitUntil(start, OW_T_READ_LOW * us);
+	busRelease(pOWHandler);
+	waitUntil(start, (OW_T_READ_LOW + OW_T_READ_SAMPLE) * us);
+	bit = busRead(pOWHandler);
+	EXIT_CRITICAL(primask);
+
+	waitUntil(start, (OW_T_READ_LOW + OW_T_READ_SAMPLE + OW_T_READ_REST) * us);
+	return bit;
+}
+
+/*****************************************************
+ * @fn					- OW_WriteByte
+ *
+ * @brief				- Write one byte, LSB first
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- byte to write
+ *
+ * @return				- none
+ * @note				- none
+ */
+void OW_WriteByte(OW_Handle_t* pOWHandler, uint8_t data) {
+	for (uint8_t i = 0; i < 8; i++) {
+		OW_WriteBit(pOWHandler, data & 0x01U);
+		data >>= 1;
+	}
+}
+
+/*****************************************************
+ * @fn					- OW_ReadByte
+ *
+ * @brief				- Read one byte, LSB first
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- byte read
+ * @note				- none
+ */
+uint8_t OW_ReadByte(OW_Handle_t* pOWHandler) {
+	uint8_t data = 0;
+
+	for (uint8_t i = 0; i < 8; i++) {
+		data >>= 1;
+		if (OW_ReadBit(pOWHandler)) {
+			data |= 0x80U;
+		}
+	}
+	return data;
+}
+
+/*****************************************************
+ * @fn					- OW_Write
+ *
+ * @brief				- Write len bytes
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- Buffer pointer to the data
+ * @param[in]			- number of bytes
+ *
+ * @return				- none
+ * @note				- none
+ */
+void OW_Write(OW_Handle_t* pOWHandler, const uint8_t* pTxBuffer, uint32_t len) {
+	while (len--) {
+		OW_WriteByte(pOWHandler, *pTxBuffer++);
+	}
+}
+
+/*****************************************************
+ * @fn					- OW_Read
+ *
+ * @brief				- Read len bytes
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- pointer to the Rx Buffer
+ * @param[in]			- number of bytes
+ *
+ * @return				- none
+ * @note				- none
+ */
+void OW_Read(OW_Handle_t* pOWHandler, uint8_t* pRxBuffer, uint32_t len) {
+	while (len--) {
+		*pRxBuffer++ = OW_ReadByte(pOWHandler);
+	}
+}
+
+/*****************************************************
+ * @fn					- OW_Select
+ *
+ * @brief				- Reset the bus and address one device or all of them
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- ROM code of the device, NULL: all the devices (SKIP ROM)
+ *
+ * @return				- OW_OK, OW_ERR_NO_PRESENCE or OW_ERR_BUS
+ * @note				- The function command follows with OW_WriteByte()
+ */
+uint8_t OW_Select(OW_Handle_t* pOWHandler, const uint8_t* pRom) {
+	uint8_t status = OW_Reset(pOWHandler);
+
+	if (status != OW_OK) {
+		return status;
+	}
+
+	if (pRom == NULL) {
+		OW_WriteByte(pOWHandler, OW_CMD_SKIP_ROM);
+	} else {
+		OW_WriteByte(pOWHandler, OW_CMD_MATCH_ROM);
+		OW_Write(pOWHandler, pRom, OW_ROM_SIZE);
+	}
+	return OW_OK;
+}
+
+/*****************************************************
+ * @fn					- OW_SearchReset
+ *
+ * @brief				- Restart the ROM search from the first device
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- none
+ * @note				- none
+ */
+void OW_SearchReset(OW_Handle_t* pOWHandler) {
+	pOWHandler->LastDiscrepancy = 0;
+	pOWHandler->LastDevice = RESET;
+	memset(pOWHandler->Rom, 0, sizeof(pOWHandler->Rom));
+}
+
+/*****************************************************
+ * @fn					- OW_Search
+ *
+ * @brief				- Find the next device of the bus (SEARCH ROM)
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[out]			- ROM code found (OW_ROM_SIZE bytes)
+ *
+ * @return				- OW_OK, OW_ERR_SEARCH_END or OW_ERR_xxx
+ * @note				- Binary tree walk of Maxim application note 187: on each bit the
+ * 						  devices send the bit and its complement, both 0 is a conflict.
+ * 						  The 1 branch is taken at the last conflict of the previous
+ * 						  pass, the path of the previous pass before it, 0 after it.
+ * 						  The search restarts after any error
+ */
+uint8_t OW_Search(OW_Handle_t* pOWHandler, uint8_t* pRom) {
+	uint8_t lastZero = 0;
+	uint8_t status;
+	uint8_t idBit, cmpBit, direction;
+	uint8_t byteIndex, mask;
+
+	if (pOWHandler->LastDevice) {
+		OW_SearchReset(pOWHandler);
+		return OW_ERR_SEARCH_END;
+	}
+
+	status = OW_Reset(pOWHandler);
+	if (status != OW_OK) {
+		OW_SearchReset(pOWHandler);
+		return status;
+	}
+	OW_WriteByte(pOWHandler, OW_CMD_SEARCH_ROM);
+
+	for (uint8_t bitNo = 1; bitNo <= OW_ROM_SIZE * 8; bitNo++) {
+		byteIndex = (bitNo - 1) >> 3;
+		mask = 1U << ((bitNo - 1) & 0x07U);
+
+		idBit = OW_ReadBit(pOWHandler);
+		cmpBit = OW_ReadBit(pOWHandler);
+
+		if (idBit && cmpBit) {
+			OW_SearchReset(pOWHandler);
+			return OW_ERR_BUS;
+		}
+
+		if (idBit != cmpBit) {
+			//All the remaining devices have the same bit
+			direction = idBit;
+		} else {
+			if (bitNo < pOWHandler->LastDiscrepancy) {
+				direction = (pOWHandler->Rom[byteIndex] & mask) ? 1U : 0U;
+			} else {
+				direction = (bitNo == pOWHandler->LastDiscrepancy) ? 1U : 0U;
+			}
+			if (!direction) {
+				lastZero = bitNo;
+			}
+		}
+
+		if (direction) {
+			pOWHandler->Rom[byteIndex] |= mask;
+		} else {
+			pOWHandler->Rom[byteIndex] &= ~mask;
+		}
+
+		//The devices with the other bit leave the search
+		OW_WriteBit(pOWHandler, direction);
+	}
+
+	if (OW_CRC8(pOWHandler->Rom, OW_ROM_SIZE) != 0) {
+		pOWHandler->Stats.CRCErrors++;
+		OW_SearchReset(pOWHandler);
+		return OW_ERR_CRC;
+	}
+
+	pOWHandler->LastDiscrepancy = lastZero;
+	if (lastZero == 0) {
+		pOWHandler->LastDevice = SET;
+	}
+	memcpy(pRom, pOWHandler->Rom, OW_ROM_SIZE);
+	return OW_OK;
+}
+
+/*****************************************************
+ * @fn					- OW_SearchAll
+ *
+ * @brief				- Find all the devices of the bus
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[out]			- table of ROM codes
+ * @param[in]			- number of entries of the table
+ *
+ * @return				- number of ROM codes stored
+ * @note				- Stops on the first error, the ROM codes found before are kept
+ */
+uint8_t OW_SearchAll(OW_Handle_t* pOWHandler, uint8_t (*pRoms)[OW_ROM_SIZE], uint8_t maxDevices) {
+	uint8_t count = 0;
+
+	OW_SearchReset(pOWHandler);
+	while (count < maxDevices && OW_Search(pOWHandler, pRoms[count]) == OW_OK) {
+		count++;
+	}
+	return count;
+}
+
+/*****************************************************
+ * @fn					- OW_CRC8
+ *
+ * @brief				- Dallas/Maxim CRC-8 of a block
+ *
+ * @param[in]			- pointer to the data
+ * @param[in]			- number of bytes
+ *
+ * @return				- CRC-8 (0 when the block ends with its own CRC)
+ * @note				- Two 16-byte tables, one nibble per lookup
+ */
+uint8_t OW_CRC8(const uint8_t* pData, uint32_t len) {
+	uint8_t crc = 0;
+
+	while (len--) {
+		crc ^= *pData++;
+		crc = CRC8Low[crc & 0x0FU] ^ CRC8High[crc >> 4];
+	}
+	return crc;
+}
+
+/*****************************************************
+ * @fn					- DS18B20_StartConversion
+ *
+ * @brief				- Start a temperature conversion
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- ROM code of the sensor, NULL: all the sensors at once
+ *
+ * @return				- OW_OK, OW_ERR_NO_PRESENCE or OW_ERR_BUS
+ * @note				- With parasite power, the bus must be held high by a strong
+ * 						  pull-up during the conversion: not supported, use VDD
+ */
+uint8_t DS18B20_StartConversion(OW_Handle_t* pOWHandler, const uint8_t* pRom) {
+	uint8_t status = OW_Select(pOWHandler, pRom);
+
+	if (status != OW_OK) {
+		return status;
+	}
+	OW_WriteByte(pOWHandler, DS18B20_CMD_CONVERT_T);
+	return OW_OK;
+}
+
+/*****************************************************
+ * @fn					- DS18B20_IsConversionDone
+ *
+ * @brief				- Check the end of the conversion
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ *
+ * @return				- SET when every converting sensor is done
+ * @note				- The sensors answer 0 to read slots while they convert, the
+ * 						  bus is a wired-AND: 1 only when all of them are done
+ */
+uint8_t DS18B20_IsConversionDone(OW_Handle_t* pOWHandler) {
+	return OW_ReadBit(pOWHandler) ? SET : RESET;
+}
+
+/*****************************************************
+ * @fn					- DS18B20_ReadTemperature
+ *
+ * @brief				- Read the temperature of one sensor
+ *
+ * @param[in]			- Handle structure of the 1-Wire bus
+ * @param[in]			- ROM code of the sensor, NULL: the only sensor of the bus
+ * @param[out]			- temperature in 1/16 degree Celsius
+ *
+ * @return				- OW_OK, OW_ERR_CRC or the error of OW_Select()
+ * @note				- The whole scratchpad is read to check its CRC-8. The 9, 10 and
+ * 						  11-bit resolutions leave the low bits undefined, the value is
+ * 						  in 1/16 degree for all of them
+ */
+uint8_t DS18B20_ReadTemperature(OW_Handle_t* pOWHandler, const uint8_t* pRom, int16_t* pTemperature) {
+	uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+	uint8_t status = OW_Select(pOWHandler, pRom);
+
+	if (status != OW_OK) {
+		return status;
+	}
+	OW_WriteByte(pOWHandler, DS18B20_CMD_READ_SCRATCH);
+	OW_Read(pOWHandler, scratchpad, DS18B20_SCRATCHPAD_SIZE);
+
+	//A bus without answer reads all 1: the CRC of 8 x 0xFF is not 0xFF
+	if (OW_CRC8(scratchpad, DS18B20_SCRATCHPAD_SIZE) != 0) {
+		pOWHandler->Stats.CRCErrors++;
+		return OW_ERR_CRC;
+	}
+
+	*pTemperature = (int16_t) ((uint16_t) scratchpad[1] << 8 | scratchpad[0]);
+	return OW_OK;
+}
+
+/*
+ * Some helper functions implementation
+ */
+
+//Busy wait until cycles have elapsed since start (wraps cleanly on the 32-bit counter)
+static void waitUntil(uint32_t start, uint32_t cycles) {
+	while ((DWT_CYCCNT - start) < cycles);
+}
+
+__force_inline void busLow(OW_Handle_t* pOWHandler) {
+	GPIO_ClearPins(pOWHandler->OW_GPIO.pGPIOx, pOWHandler->OW_GPIO.GPIOx_PinConfig.GPIO_PinNumber);
+}
+
+//Open-drain: the pull-up takes the bus high
+__force_inline void busRelease(OW_Handle_t* pOWHandler) {
+	GPIO_SetPins(pOWHandler->OW_GPIO.pGPIOx, pOWHandler->OW_GPIO.GPIOx_PinConfig.GPIO_PinNumber);
+}
+
+__force_inline uint8_t busRead(OW_Handle_t* pOWHandler) {
+	return GPIO_ReadPins(pOWHandler->OW_GPIO.pGPIOx, pOWHandler->OW_GPIO.GPIOx_PinConfig.GPIO_PinNumber) ? 1U : 0U;
+}
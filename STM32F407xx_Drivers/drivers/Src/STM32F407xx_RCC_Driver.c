@@ -0,0 +1,169 @@
+/*
+ * STM32F407xx_RCC_Driver.c
+ *
+ *  Created on: Oct 2, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the clock tree helpers of the RCC
+ */
+
+#include "../Inc/STM32F407xx_RCC_Driver.h"
+
+/*
+ * Prescaler tables of the clock tree
+ * Note: HPRE = 0xxx means not divided, 1000 - 1111 map to the table below
+ * 		 PPREx = 0xx means not divided, 100 - 111 map to the table below
+ */
+static const uint16_t AHBPreSclr[8] = {2, 4, 8, 16, 64, 128, 256, 512};
+static const uint8_t  APBPreSclr[4] = {2, 4, 8, 16};
+
+/*
+ * Peripheral descriptors, indexed by RCC_PERIPH_INDEX(base address)
+ * Note: Add a line here to give a new peripheral clock, reset and IRQ lookup
+ */
+#define PERIPH_DESC(__BASE__, __BUS__, __BIT__, __IRQ__, __IRQER__) \
+	[RCC_PERIPH_INDEX(__BASE__)] = { (__BASE__), (__BUS__), (__BIT__), (__IRQ__), (__IRQER__) }
+
+const RCC_PeriphDesc_t RCC_PeriphTable[RCC_PERIPH_TABLE_SIZE] = {
+	PERIPH_DESC(GPIOA_BASEADDR,  RCC_BUS_AHB1, 0,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOB_BASEADDR,  RCC_BUS_AHB1, 1,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOC_BASEADDR,  RCC_BUS_AHB1, 2,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOD_BASEADDR,  RCC_BUS_AHB1, 3,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOE_BASEADDR,  RCC_BUS_AHB1, 4,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOF_BASEADDR,  RCC_BUS_AHB1, 5,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOG_BASEADDR,  RCC_BUS_AHB1, 6,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOH_BASEADDR,  RCC_BUS_AHB1, 7,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOI_BASEADDR,  RCC_BUS_AHB1, 8,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOJ_BASEADDR,  RCC_BUS_AHB1, 9,  RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(GPIOK_BASEADDR,  RCC_BUS_AHB1, 10, RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(DMA1_BASEADDR,   RCC_BUS_AHB1, 21, RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(DMA2_BASEADDR,   RCC_BUS_AHB1, 22, RCC_IRQ_NONE,   RCC_IRQ_NONE),
+	PERIPH_DESC(TIM2_BASEADDR,   RCC_BUS_APB1, 0,  TIM2_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(TIM3_BASEADDR,   RCC_BUS_APB1, 1,  TIM3_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(TIM4_BASEADDR,   RCC_BUS_APB1, 2,  TIM4_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(TIM5_BASEADDR,   RCC_BUS_APB1, 3,  TIM5_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(SPI2_BASEADDR,   RCC_BUS_APB1, 14, SPI2_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(SPI3_BASEADDR,   RCC_BUS_APB1, 15, SPI3_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(USART2_BASEADDR, RCC_BUS_APB1, 17, USART2_IRQ_NO,  RCC_IRQ_NONE),
+	PERIPH_DESC(USART3_BASEADDR, RCC_BUS_APB1, 18, USART3_IRQ_NO,  RCC_IRQ_NONE),
+	PERIPH_DESC(UART4_BASEADDR,  RCC_BUS_APB1, 19, UART4_IRQ_NO,   RCC_IRQ_NONE),
+	PERIPH_DESC(UART5_BASEADDR,  RCC_BUS_APB1, 20, UART5_IRQ_NO,   RCC_IRQ_NONE),
+	PERIPH_DESC(I2C1_BASEADDR,   RCC_BUS_APB1, 21, I2C1_EV_IRQ_NO, I2C1_ER_IRQ_NO),
+	PERIPH_DESC(I2C2_BASEADDR,   RCC_BUS_APB1, 22, I2C2_EV_IRQ_NO, I2C2_ER_IRQ_NO),
+	PERIPH_DESC(I2C3_BASEADDR,   RCC_BUS_APB1, 23, I2C3_EV_IRQ_NO, I2C3_ER_IRQ_NO),
+	PERIPH_DESC(TIM1_BASEADDR,   RCC_BUS_APB2, 0,  TIM1_UP_IRQ_NO, RCC_IRQ_NONE),
+	PERIPH_DESC(TIM8_BASEADDR,   RCC_BUS_APB2, 1,  TIM8_UP_IRQ_NO, RCC_IRQ_NONE),
+	PERIPH_DESC(USART1_BASEADDR, RCC_BUS_APB2, 4,  USART1_IRQ_NO,  RCC_IRQ_NONE),
+	PERIPH_DESC(USART6_BASEADDR, RCC_BUS_APB2, 5,  USART6_IRQ_NO,  RCC_IRQ_NONE),
+	PERIPH_DESC(SPI1_BASEADDR,   RCC_BUS_APB2, 12, SPI1_IRQ_NO,    RCC_IRQ_NONE),
+	PERIPH_DESC(SYSCFG_BASEADDR, RCC_BUS_APB2, 14, RCC_IRQ_NONE,   RCC_IRQ_NONE),
+};
+
+/*****************************************************
+ * @fn					- RCC_GetPLLClkFreq
+ *
+ * @brief				- Return the main PLL output clock (PLLCLK) frequency
+ *
+ * @param[in]			- none
+ *
+ * @return				- PLLCLK frequency in Hz
+ * @note				- f(VCO) = f(PLL input) * (PLLN / PLLM)
+ * 						  f(PLLCLK) = f(VCO) / PLLP
+ */
+uint32_t RCC_GetPLLClkFreq(void) {
+	uint32_t pllInput, pllM, pllN, pllP;
+
+	//Determine which oscillator feeds the PLL
+	pllInput = ((RCC->PLLCFGR >> RCC_PLLCFGR_PLLSRC) & 0x1) == RCC_PLL_SRC_HSE ? HSE_CLK_FREQ : HSI_CLK_FREQ;
+
+	pllM = (RCC->PLLCFGR >> RCC_PLLCFGR_PLLM) & 0x3F;
+	pllN = (RCC->PLLCFGR >> RCC_PLLCFGR_PLLN) & 0x1FF;
+	pllP = (((RCC->PLLCFGR >> RCC_PLLCFGR_PLLP) & 0x3) + 1U) * 2U; //00: 2, 01: 4, 10: 6, 11: 8
+
+	//PLLM = 0 or 1 is a wrong configuration
+	if (pllM < 2U) {
+		return 0;
+	}
+
+	//Divide first: the VCO input (1-2MHz) times PLLN always fits in 32 bits
+	return ((pllInput / pllM) * pllN) / pllP;
+}
+
+/*****************************************************
+ * @fn					- RCC_GetSysClkFreq
+ *
+ * @brief				- Return the system clock (SYSCLK) frequency
+ *
+ * @param[in]			- none
+ *
+ * @return				- SYSCLK frequency in Hz
+ * @note				- The switch status (SWS) is used instead of SW since it
+ * 						  reflects the clock actually in use
+ */
+uint32_t RCC_GetSysClkFreq(void) {
+	uint32_t sysClk;
+
+	switch ((RCC->CFGR >> RCC_CFGR_SWS) & 0x3) {
+	case RCC_HSE:	sysClk = HSE_CLK_FREQ; break; //8MHz
+	case RCC_PLL:	sysClk = RCC_GetPLLClkFreq(); break;
+	case RCC_HSI:
+	default:		sysClk = HSI_CLK_FREQ; break; //16MHz
+	}
+	return sysClk;
+}
+
+/*****************************************************
+ * @fn					- RCC_GetHCLKFreq
+ *
+ * @brief				- Return the AHB clock (HCLK) frequency
+ *
+ * @param[in]			- none
+ *
+ * @return				- HCLK frequency in Hz
+ * @note				- HCLK also clocks the Cortex-M4 core, DWT and ITM
+ */
+uint32_t RCC_GetHCLKFreq(void) {
+	uint32_t temp = (RCC->CFGR >> RCC_CFGR_HPRE) & 0xF;
+
+	if (temp < 8U) {
+		return RCC_GetSysClkFreq();
+	}
+	return RCC_GetSysClkFreq() / AHBPreSclr[temp - 8U];
+}
+
+/*****************************************************
+ * @fn					- RCC_GetPCLK1Freq
+ *
+ * @brief				- Return the APB1 peripheral clock (PCLK1) frequency
+ *
+ * @param[in]			- none
+ *
+ * @return				- PCLK1 frequency in Hz
+ * @note				- I2Cx, SPI2/3, USART2/3 and UART4/5 hang on APB1
+ */
+uint32_t RCC_GetPCLK1Freq(void) {
+	uint32_t temp = (RCC->CFGR >> RCC_CFGR_PPRE1) & 0x7;
+
+	if (temp < 4U) {
+		return RCC_GetHCLKFreq();
+	}
+	return RCC_GetHCLKFreq() / APBPreSclr[temp - 4U];
+}
+
+/*****************************************************
+ * @fn					- RCC_GetPCLK2Freq
+ *
+ * @brief				- Return the APB2 peripheral clock (PCLK2) frequency
+ *
+ * @param[in]			- none
+ *
+ * @return				- PCLK2 frequency in Hz
+ * @note				- SPI1, USART1 and USART6 hang on APB2
+ */
+uint32_t RCC_GetPCLK2Freq(void) {
+	uint32_t temp = (RCC->CFGR >> RCC_CFGR_PPRE2) & 0x7;
+
+	if (temp < 4U) {
+		return RCC_GetHCLKFreq();
+	}
+	return RCC_GetHCLKFreq() / APBPreSclr[temp - 4U];
+}
@@ -140,13 +140,7 @@ void SPI_PeripheralEnable(SPI_Reg_t* pSPIx, uint8_t EnOrDi) {
  * @note				- The implementation so far only covers only 3 SPI ports
  */
 void SPI_DeInit(SPI_Reg_t* pSPIx) {
-	if (pSPIx == SPI1) {
-		SPI1_PCLK_RST();
-	} else if (pSPIx == SPI2) {
-		SPI2_PCLK_RST();
-	} else {
-		SPI3_PCLK_RST();
-	}
+	RCC_PeriphReset(pSPIx);
 }
 
 /*
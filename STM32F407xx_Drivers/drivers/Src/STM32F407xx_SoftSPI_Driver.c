@@ -0,0 +1,314 @@
+/*
+ * STM32F407xx_SoftSPI_Driver.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the software (bit-banged) SPI master.
+ *      			 Every edge is a single BSRR store, the 8 and 16-bit frames of both
+ *      			 clock phases have their own unrolled loop (no branch per bit) and
+ *      			 the paced frames time each half period on the DWT cycle counter
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*
+ * Helper functions
+ */
+static uint16_t exchangeFrame(SoftSPI_Handle_t* pSoftSPIHandler, uint16_t frame);
+__force_inline uint16_t shiftFrame(GPIO_Reg_t* pSCKx, uint32_t lead, uint32_t trail,
+								   GPIO_Reg_t* pMOSIx, uint32_t mosiPin,
+								   GPIO_Reg_t* pMISOx, uint32_t misoPin,
+								   uint32_t frame, const uint8_t bits, const uint8_t cpha);
+static uint16_t shiftFramePaced(SoftSPI_Handle_t* pSoftSPIHandler, GPIO_Reg_t* pMOSIx, uint32_t mosiPin,
+								GPIO_Reg_t* pMISOx, uint32_t misoPin, uint32_t frame, uint8_t bits);
+static uint16_t reverseBits(uint16_t frame, uint8_t bits);
+
+/*****************************************************
+ * @fn					- SoftSPI_Init
+ *
+ * @brief				- Configure the SCK, MOSI and MISO pins and prepare the edges
+ *
+ * @param[in]			- Handle structure of the software SPI
+ *
+ * @return				- none
+ * @note				- SCK is driven to its idle level (CPOL) before it becomes an
+ * 						  output, the slave does not see a false edge. The DWT cycle
+ * 						  counter is started for the paced speeds if it is not running
+ */
+void SoftSPI_Init(SoftSPI_Handle_t* pSoftSPIHandler) {
+	SoftSPI_Config_t* pConfig = &pSoftSPIHandler->SoftSPI_Config;
+	uint32_t sckHigh = pSoftSPIHandler->SCKPin;
+	uint32_t sckLow = (uint32_t) pSoftSPIHandler->SCKPin << GPIO_PIN_NUMBER;
+	GPIO_Handle_t GPIO_Pin;
+
+	//BSRR words of both edges, the idle level is the trailing edge
+	if (pConfig->CPOLConfig == SPI_CPOL_HIGH) {
+		pSoftSPIHandler->SCKLead = sckLow;
+		pSoftSPIHandler->SCKTrail = sckHigh;
+	} else {
+		pSoftSPIHandler->SCKLead = sckHigh;
+		pSoftSPIHandler->SCKTrail = sckLow;
+	}
+
+	//SCK
+	GPIO_PeriClkCtrl(pSoftSPIHandler->pSCKPort, ENABLE);
+	pSoftSPIHandler->pSCKPort->BSRR = pSoftSPIHandler->SCKTrail;
+
+	memset(&GPIO_Pin, 0, sizeof(GPIO_Pin));
+	GPIO_Pin.pGPIOx = pSoftSPIHandler->pSCKPort;
+	GPIO_Pin.GPIOx_PinConfig.GPIO_PinNumber = pSoftSPIHandler->SCKPin;
+	GPIO_Pin.GPIOx_PinConfig.GPIO_PinMode = GPIO_OUTPUT_MODE;
+	GPIO_Pin.GPIOx_PinConfig.GPIO_PinSpeed = GPIO_VERY_HIGH_SPEED;
+	GPIO_Pin.GPIOx_PinConfig.GPIO_PinOPType = GPIO_PUSH_PULL;
+	GPIO_Pin.GPIOx_PinConfig.GPIO_PinPuPdCtrl = GPIO_NO_PU_PD;
+	GPIO_Init(&GPIO_Pin);
+
+	//MOSI
+	if (pSoftSPIHandler->pMOSIPort != NULL) {
+		GPIO_PeriClkCtrl(pSoftSPIHandler->pMOSIPort, ENABLE);
+		GPIO_Pin.pGPIOx = pSoftSPIHandler->pMOSIPort;
+		GPIO_Pin.GPIOx_PinConfig.GPIO_PinNumber = pSoftSPIHandler->MOSIPin;
+		GPIO_Init(&GPIO_Pin);
+	}
+
+	//MISO
+	if (pSoftSPIHandler->pMISOPort != NULL) {
+		GPIO_PeriClkCtrl(pSoftSPIHandler->pMISOPort, ENABLE);
+		GPIO_Pin.pGPIOx = pSoftSPIHandler->pMISOPort;
+		GPIO_Pin.GPIOx_PinConfig.GPIO_PinNumber = pSoftSPIHandler->MISOPin;
+		GPIO_Pin.GPIOx_PinConfig.GPIO_PinMode = GPIO_INPUT_MODE;
+		GPIO_Init(&GPIO_Pin);
+	}
+
+	//Half period in cycles of the core clock
+	pSoftSPIHandler->HalfPeriod = 0;
+	if (pConfig->SclkSpeed != SOFTSPI_SCLK_MAX) {
+		pSoftSPIHandler->HalfPeriod = RCC_GetHCLKFreq() / (2U * pConfig->SclkSpeed);
+		if (pSoftSPIHandler->HalfPeriod == 0) {
+			pSoftSPIHandler->HalfPeriod = 1;
+		}
+		if (!(DWT_CTRL & (1 << DWT_CTRL_CYCCNTENA))) {
+			DWT_CYCCNT_EN();
+		}
+	}
+}
+
+/*****************************************************
+ * @fn					- SoftSPI_SendData
+ *
+ * @brief				- Send the buffer on MOSI, the MISO bits are discarded
+ *
+ * @param[in]			- Handle structure of the software SPI
+ * @param[in]			- Buffer pointer to the data
+ * @param[in]			- The number of bytes transmitted are indicated by len
+ *
+ * @return				- none
+ * @note				- This is a blocking API, same as SPI_SendData()
+ */
+void SoftSPI_SendData(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pTxBuffer, uint32_t len) {
+	SoftSPI_TransmitReceive(pSoftSPIHandler, pTxBuffer, NULL, len);
+}
+
+/*****************************************************
+ * @fn					- SoftSPI_ReceiveData
+ *
+ * @brief				- Receive len bytes from MISO, MOSI stays high (dummy 0xFF)
+ *
+ * @param[in]			- Handle structure of the software SPI
+ * @param[in]			- pointer to the Rx Buffer
+ * @param[in]			- the number of bytes of the buffer
+ *
+ * @return				- none
+ * @note				- This is a blocking API, same as SPI_ReceiveData()
+ */
+void SoftSPI_ReceiveData(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pRxBuffer, uint32_t len) {
+	SoftSPI_TransmitReceive(pSoftSPIHandler, NULL, pRxBuffer, len);
+}
+
+/*****************************************************
+ * @fn					- SoftSPI_TransmitReceive
+ *
+ * @brief				- Full duplex exchange of len bytes
+ *
+ * @param[in]			- Handle structure of the software SPI
+ * @param[in]			- Tx buffer, NULL: send 0xFF
+ * @param[in]			- Rx buffer, NULL: discard the received bits
+ * @param[in]			- the number of bytes of the buffers
+ *
+ * @return				- none
+ * @note				- With 16-bit frames, len is rounded down to an even number
+ */
+void SoftSPI_TransmitReceive(SoftSPI_Handle_t* pSoftSPIHandler, uint8_t* pTxBuffer, uint8_t* pRxBuffer,
+							 uint32_t len) {
+	uint16_t frame;
+
+	if (pSoftSPIHandler->SoftSPI_Config.DFF == SPI_DFF_16_BIT) {
+		for (; len >= 2; len -= 2) {
+			frame = (pTxBuffer != NULL) ? *((uint16_t*) pTxBuffer) : 0xFFFFU;
+			frame = exchangeFrame(pSoftSPIHandler, frame);
+			if (pTxBuffer != NULL) {
+				pTxBuffer += 2;
+			}
+			if (pRxBuffer != NULL) {
+				*((uint16_t*) pRxBuffer) = frame;
+				pRxBuffer += 2;
+			}
+		}
+	} else {
+		for (; len; len--) {
+			frame = (pTxBuffer != NULL) ? *pTxBuffer++ : 0xFFU;
+			frame = exchangeFrame(pSoftSPIHandler, frame);
+			if (pRxBuffer != NULL) {
+				*pRxBuffer++ = (uint8_t) frame;
+			}
+		}
+	}
+}
+
+/*****************************************************
+ * @fn					- SoftSPI_Transfer
+ *
+ * @brief				- Exchange one frame
+ *
+ * @param[in]			- Handle structure of the software SPI
+ * @param[in]			- frame to send (the low 8 bits with 8-bit frames)
+ *
+ * @return				- frame received
+ * @note				- none
+ */
+uint16_t SoftSPI_Transfer(SoftSPI_Handle_t* pSoftSPIHandler, uint16_t frame) {
+	return exchangeFrame(pSoftSPIHandler, frame);
+}
+
+/*
+ * Some helper functions implementation
+ */
+
+//One frame MSB first on the bus, the received bits are shifted in from the right.
+//bits and cpha are constants at every call site: the loop is fully unrolled and
+//the phase test disappears, each bit is 3 BSRR stores and one IDR load.
+//CPHA = 0: MOSI is set before the leading edge, MISO is sampled after it
+//CPHA = 1: MOSI is set after the leading edge, MISO is sampled after the trailing edge
+//(the slave changes MISO on the other edge, the value read is stable)
+__force_inline uint16_t shiftFrame(GPIO_Reg_t* pSCKx, uint32_t lead, uint32_t trail,
+								   GPIO_Reg_t* pMOSIx, uint32_t mosiPin,
+								   GPIO_Reg_t* pMISOx, uint32_t misoPin,
+								   uint32_t frame, const uint8_t bits, const uint8_t cpha) {
+	uint32_t rx = 0;
+	uint32_t mosi;
+
+#pragma GCC unroll 16
+	for (int8_t n = bits - 1; n >= 0; n--) {
+		//Reset half of BSRR for a 0, set half for a 1 (no branch)
+		mosi = (mosiPin << GPIO_PIN_NUMBER) >> (((frame >> n) & 1U) << 4);
+		if (cpha == 0) {
+			pMOSIx->BSRR = mosi;
+			pSCKx->BSRR = lead;
+			rx = (rx << 1) | ((pMISOx->IDR & misoPin) != 0);
+			pSCKx->BSRR = trail;
+		} else {
+			pSCKx->BSRR = lead;
+			pMOSIx->BSRR = mosi;
+			pSCKx->BSRR = trail;
+			rx = (rx << 1) | ((pMISOx->IDR & misoPin) != 0);
+		}
+	}
+	return (uint16_t) rx;
+}
+
+static uint16_t exchangeFrame(SoftSPI_Handle_t* pSoftSPIHandler, uint16_t frame) {
+	SoftSPI_Config_t* pConfig = &pSoftSPIHandler->SoftSPI_Config;
+	GPIO_Reg_t* pSCKx = pSoftSPIHandler->pSCKPort;
+	GPIO_Reg_t* pMOSIx = pSoftSPIHandler->pMOSIPort;
+	GPIO_Reg_t* pMISOx = pSoftSPIHandler->pMISOPort;
+	uint32_t mosiPin = pSoftSPIHandler->MOSIPin;
+	uint32_t misoPin = pSoftSPIHandler->MISOPin;
+	uint8_t bits = (pConfig->DFF == SPI_DFF_16_BIT) ? 16U : 8U;
+	uint16_t rx;
+
+	//A missing line goes to the SCK port with an empty mask: the BSRR store of 0
+	//does nothing and the IDR load reads 0, the loop keeps no test for it
+	if (pMOSIx == NULL) {
+		pMOSIx = pSCKx;
+		mosiPin = 0;
+	}
+	if (pMISOx == NULL) {
+		pMISOx = pSCKx;
+		misoPin = 0;
+	}
+
+	if (pConfig->FirstBit == SOFTSPI_LSB_FIRST) {
+		frame = reverseBits(frame, bits);
+	}
+
+	if (pSoftSPIHandler->HalfPeriod) {
+		rx = shiftFramePaced(pSoftSPIHandler, pMOSIx, mosiPin, pMISOx, misoPin, frame, bits);
+	} else if (bits == 16U) {
+		if (pConfig->CPHAConfig == SPI_CPHA_HIGH) {
+			rx = shiftFrame(pSCKx, pSoftSPIHandler->SCKLead, pSoftSPIHandler->SCKTrail,
+							pMOSIx, mosiPin, pMISOx, misoPin, frame, 16, 1);
+		} else {
+			rx = shiftFrame(pSCKx, pSoftSPIHandler->SCKLead, pSoftSPIHandler->SCKTrail,
+							pMOSIx, mosiPin, pMISOx, misoPin, frame, 16, 0);
+		}
+	} else {
+		if (pConfig->CPHAConfig == SPI_CPHA_HIGH) {
+			rx = shiftFrame(pSCKx, pSoftSPIHandler->SCKLead, pSoftSPIHandler->SCKTrail,
+							pMOSIx, mosiPin, pMISOx, misoPin, frame, 8, 1);
+		} else {
+			rx = shiftFrame(pSCKx, pSoftSPIHandler->SCKLead, pSoftSPIHandler->SCKTrail,
+							pMOSIx, mosiPin, pMISOx, misoPin, frame, 8, 0);
+		}
+	}
+
+	if (pConfig->FirstBit == SOFTSPI_LSB_FIRST) {
+		rx = reverseBits(rx, bits);
+	}
+	return rx;
+}
+
+//Same bus sequence as shiftFrame() with a wait of HalfPeriod cycles before each
+//edge. The deadlines are kept on an absolute time base, so the time spent in the
+//loop itself does not add up and SCLK stays at the configured frequency
+static uint16_t shiftFramePaced(SoftSPI_Handle_t* pSoftSPIHandler, GPIO_Reg_t* pMOSIx, uint32_t mosiPin,
+								GPIO_Reg_t* pMISOx, uint32_t misoPin, uint32_t frame, uint8_t bits) {
+	GPIO_Reg_t* pSCKx = pSoftSPIHandler->pSCKPort;
+	uint32_t half = pSoftSPIHandler->HalfPeriod;
+	uint8_t cpha = (pSoftSPIHandler->SoftSPI_Config.CPHAConfig == SPI_CPHA_HIGH);
+	uint32_t deadline = DWT_CYCCNT;
+	uint32_t rx = 0;
+	uint32_t mosi;
+
+	for (int8_t n = bits - 1; n >= 0; n--) {
+		mosi = (mosiPin << GPIO_PIN_NUMBER) >> (((frame >> n) & 1U) << 4);
+		if (!cpha) {
+			pMOSIx->BSRR = mosi;
+		}
+		deadline += half;
+		while ((int32_t) (DWT_CYCCNT - deadline) < 0);
+		pSCKx->BSRR = pSoftSPIHandler->SCKLead;
+		if (cpha) {
+			pMOSIx->BSRR = mosi;
+		} else {
+			rx = (rx << 1) | ((pMISOx->IDR & misoPin) != 0);
+		}
+		deadline += half;
+		while ((int32_t) (DWT_CYCCNT - deadline) < 0);
+		pSCKx->BSRR = pSoftSPIHandler->SCKTrail;
+		if (cpha) {
+			rx = (rx << 1) | ((pMISOx->IDR & misoPin) != 0);
+		}
+	}
+	return (uint16_t) rx;
+}
+
+//Mirror the low bits of frame (swap the bits, the pairs, the nibbles, the bytes)
+static uint16_t reverseBits(uint16_t frame, uint8_t bits) {
+	uint32_t v = frame;
+
+	v = ((v >> 1) & 0x5555U) | ((v & 0x5555U) << 1);
+	v = ((v >> 2) & 0x3333U) | ((v & 0x3333U) << 2);
+	v = ((v >> 4) & 0x0F0FU) | ((v & 0x0F0FU) << 4);
+	v = ((v >> 8) & 0x00FFU) | ((v & 0x00FFU) << 8);
+	return (uint16_t) (v >> (16U - bits));
+}
@@ -0,0 +1,137 @@
+/*
+ * STM32F407xx_USART_Retarget.c
+ *
+ *  Created on: Oct 4, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the printf/scanf retarget layer
+ *      			 (newlib _write/_read) on top of a buffered USART
+ */
+
+#include "../Inc/STM32F407xx_USART_Retarget.h"
+
+/*
+ * Retarget context
+ */
+static USART_Handle_t* pRetargetUSART = NULL;
+static uint8_t RetargetPolicy = USART_RETARGET_DROP;
+static volatile uint32_t RetargetDropCount = 0;
+
+/*****************************************************
+ * @fn					- USART_Retarget_Init
+ *
+ * @brief				- Route stdout/stderr (and optionally stdin) to the USART
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral (already initialized)
+ * @param[in]			- Tx ring buffer (initialized with RingBuffer_Init)
+ * @param[in]			- Rx ring buffer (initialized with RingBuffer_Init), or NULL
+ * @param[in]			- policy when the Tx ring is full @USART_RETARGET_POLICY
+ *
+ * @return				- none
+ * @note				- printf() then only costs a copy into the Tx ring buffer,
+ * 						  the TXE interrupt sends the bytes in the background
+ */
+void USART_Retarget_Init(USART_Handle_t* pUSARTHandler, RingBuffer_t* pTxRing, RingBuffer_t* pRxRing, uint8_t policy) {
+	pRetargetUSART = pUSARTHandler;
+	RetargetPolicy = policy;
+	RetargetDropCount = 0;
+
+	USART_AttachTxRing(pUSARTHandler, pTxRing);
+	if (pRxRing != NULL) {
+		USART_ReceiveRingIT(pUSARTHandler, pRxRing);
+	}
+}
+
+/*****************************************************
+ * @fn					- USART_Retarget_Flush
+ *
+ * @brief				- Block until the Tx ring is drained and the last frame is sent
+ *
+ * @param[in]			- none
+ *
+ * @return				- none
+ * @note				- Call before entering a low power mode or resetting the MCU
+ */
+void USART_Retarget_Flush(void) {
+	if (pRetargetUSART == NULL) {
+		return;
+	}
+	while (pRetargetUSART->TxState == USART_BUSY_IN_TX_RING);
+	while (!USART_CheckStatusFlag(&pRetargetUSART->pUSARTx->SR, USART_FLAG_SR_TC));
+}
+
+/*****************************************************
+ * @fn					- USART_Retarget_GetDropCount
+ *
+ * @brief				- Return the number of bytes discarded because the Tx ring was full
+ *
+ * @param[in]			- none
+ *
+ * @return				- number of dropped bytes
+ * @note				- Only counts with the USART_RETARGET_DROP policy
+ */
+uint32_t USART_Retarget_GetDropCount(void) {
+	return RetargetDropCount;
+}
+
+/*****************************************************
+ * @fn					- _write
+ *
+ * @brief				- Newlib hook behind printf/puts/fwrite
+ *
+ * @param[in]			- file descriptor
+ * @param[in]			- data to write
+ * @param[in]			- length of the data
+ *
+ * @return				- number of bytes consumed, -1 on a wrong descriptor
+ * @note				- With the USART_RETARGET_BLOCK policy, do not print from an ISR
+ * 						  with a priority higher than or equal to the USART IRQ: the
+ * 						  ring would never drain
+ */
+int _write(int file, char* ptr, int len) {
+	uint32_t sent;
+
+	if ((file != USART_RETARGET_STDOUT && file != USART_RETARGET_STDERR) || pRetargetUSART == NULL) {
+		return -1;
+	}
+
+	sent = USART_WriteRing(pRetargetUSART, (uint8_t*) ptr, (uint32_t) len);
+	if (RetargetPolicy == USART_RETARGET_BLOCK) {
+		while (sent < (uint32_t) len) {
+			sent += USART_WriteRing(pRetargetUSART, (uint8_t*) ptr + sent, (uint32_t) len - sent);
+		}
+	} else {
+		RetargetDropCount += (uint32_t) len - sent;
+	}
+
+	//Report everything as written: newlib would otherwise retry the dropped bytes
+	return len;
+}
+
+/*****************************************************
+ * @fn					- _read
+ *
+ * @brief				- Newlib hook behind scanf/getchar/fread
+ *
+ * @param[in]			- file descriptor
+ * @param[out]			- buffer to fill
+ * @param[in]			- maximum length to read
+ *
+ * @return				- number of bytes read (at least 1), 0 when no Rx ring is attached
+ * @note				- Blocks until at least one byte is received
+ */
+int _read(int file, char* ptr, int len) {
+	uint32_t count;
+
+	if (file != USART_RETARGET_STDIN || pRetargetUSART == NULL) {
+		return -1;
+	}
+	if (pRetargetUSART->pRxRing == NULL) {
+		return 0; //EOF
+	}
+
+	do {
+		count = USART_ReadRing(pRetargetUSART, (uint8_t*) ptr, (uint32_t) len);
+	} while (count == 0);
+
+	return (int) count;
+}
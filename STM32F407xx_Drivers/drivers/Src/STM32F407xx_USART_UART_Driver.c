@@ -11,10 +11,14 @@
  * Helper functions that are private to user applications
  */
 static uint32_t getAPBxClkFreq(USART_Reg_t* pUSARTx);
-static uint32_t getPLLClkFreq();
 static uint32_t getUSARTDiv(USART_Handle_t* pUSARTHandler);
 static void TXEInterruptHandler(USART_Handle_t* pUSARTHandler);
 static void RXNEInterruptHandler(USART_Handle_t* pUSARTHandler);
+static void RXNERingInterruptHandler(USART_Handle_t* pUSARTHandler);
+static void TXERingInterruptHandler(USART_Handle_t* pUSARTHandler);
+static void closeTransmission(USART_Handle_t* pUSARTHandler);
+static void closeReception(USART_Handle_t* pUSARTHandler);
+static void driverEnable(USART_Handle_t* pUSARTHandler, uint8_t EnOrDi);
 
 /*****************************************************
  * @fn					- USART_PeriClkCtrl
@@ -48,7 +52,7 @@ void USART_PeriClkCtrl(USART_Reg_t* pUSARTx, uint8_t EnOrDi) {
  */
 void USART_Init(USART_Handle_t* pUSARTHandler) {
 	uint32_t USARTDiv;
-	uint16_t mantissa, temp;
+	uint16_t mantissa, temp, fractionScale;
 	uint8_t fraction;
 	//Enable the peripheral clock
 	USART_PeriClkCtrl(pUSARTHandler->pUSARTx, ENABLE);
@@ -89,21 +93,36 @@ void USART_Init(USART_Handle_t* pUSARTHandler) {
 	//Configure the number of stop bits
 	pUSARTHandler->pUSARTx->CR2 |= pUSARTHandler->USART_Config.NoOfStopBits << USART_CR2_STOP;
 
+	//Configure the wake-up method of the mute mode and the node address
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_WAKE);
+	pUSARTHandler->pUSARTx->CR2 &= ~(USART_NODE_ADDRESS_MASK << USART_CR2_ADD);
+	if (pUSARTHandler->USART_Config.WakeUpMethod == USART_WAKEUP_ADDRESS_MARK) {
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_WAKE;
+		pUSARTHandler->pUSARTx->CR2 |= (pUSARTHandler->USART_Config.NodeAddress & USART_NODE_ADDRESS_MASK) << USART_CR2_ADD;
+	}
+
+	//Release the RS-485 bus: the transceiver listens until this node transmits
+	driverEnable(pUSARTHandler, DISABLE);
+
 	//Configure the HW flow control
+	//Note: CTSE and RTSE are single bits, so only 1 must be shifted in. Shifting the
+	//		@USART_HW_FLOW_CTRL value itself would spill into the neighbouring bits
+	//		(e.g. CTS_RTS = 3 shifted to CTSE also sets CTSIE)
+	pUSARTHandler->pUSARTx->CR3 &= ~((1 << USART_CR3_CTSE) | (1 << USART_CR3_RTSE) | (1 << USART_CR3_CTSIE));
 	if (pUSARTHandler->USART_Config.HWFlowControl != USART_HW_FLOW_CTRL_NONE) {
 
-		//Enable CTS bit
+		//Enable CTS bit: the transmitter holds the next frame while nCTS is high
 		if (pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_CTS) {
-			pUSARTHandler->pUSARTx->CR3 |= pUSARTHandler->USART_Config.HWFlowControl << USART_CR3_CTSE;
+			pUSARTHandler->pUSARTx->CR3 |= 1 << USART_CR3_CTSE;
 		}
-		//Enable RTS bit
+		//Enable RTS bit: hardware deasserts nRTS as long as the receive register is full
 		else if (pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_RTS) {
-			pUSARTHandler->pUSARTx->CR3 |= pUSARTHandler->USART_Config.HWFlowControl << USART_CR3_RTSE;
+			pUSARTHandler->pUSARTx->CR3 |= 1 << USART_CR3_RTSE;
 		}
 		//Enable both RTS and CTS
 		else {
-			pUSARTHandler->pUSARTx->CR3 |= pUSARTHandler->USART_Config.HWFlowControl << USART_CR3_CTSE;
-			pUSARTHandler->pUSARTx->CR3 |= pUSARTHandler->USART_Config.HWFlowControl << USART_CR3_RTSE;
+			pUSARTHandler->pUSARTx->CR3 |= 1 << USART_CR3_CTSE;
+			pUSARTHandler->pUSARTx->CR3 |= 1 << USART_CR3_RTSE;
 		}
 	}
 
@@ -134,18 +153,21 @@ void USART_Init(USART_Handle_t* pUSARTHandler) {
 	fraction = (uint8_t) temp2;*/
 
 	//SECOND APPROACH
+	//Note: With OVER8 = 1, the fraction is only 3 bits wide (DIV_Fraction[3] must be
+	//		kept cleared), so it is scaled by 8 instead of 16
+	fractionScale = (pUSARTHandler->USART_Config.Oversampling == USART_OVERSAMPLING_BY_8) ? 8U : 16U;
 	mantissa = USARTDiv / 100U;
 	temp = USARTDiv - (mantissa * 100U);
-	temp *= (pUSARTHandler->USART_Config.Oversampling == USART_OVERSAMPLING_BY_8) ? 8U : 16U;
-	temp = (temp + 50U) / 100U; //always round up
-	if (temp > 15U) {
-		mantissa += temp - 15U;
-		fraction = 15U;
+	temp *= fractionScale;
+	temp = (temp + 50U) / 100U; //round to the nearest
+	if (temp >= fractionScale) {
+		//The fraction rounded up to a whole unit: carry it into the mantissa
+		mantissa++;
+		fraction = 0;
 	} else {
 		fraction = temp;
 	}
-	pUSARTHandler->pUSARTx->BRR |= mantissa << USART_BRR_DIV_MANTISSA;
-	pUSARTHandler->pUSARTx->BRR |= fraction << USART_BRR_DIV_FRACTION;
+	pUSARTHandler->pUSARTx->BRR = (mantissa << USART_BRR_DIV_MANTISSA) | (fraction << USART_BRR_DIV_FRACTION);
 }
 
 /*****************************************************
@@ -159,19 +181,7 @@ void USART_Init(USART_Handle_t* pUSARTHandler) {
  * @note				- The implementation so far only covers only 6 USART/USART ports
  */
 void USART_DeInit(USART_Reg_t* pUSARTx) {
-	if (pUSARTx == USART1) {
-		USART1_PCLK_RST();
-	} else if (pUSARTx == USART2) {
-		USART2_PCLK_RST();
-	} else if (pUSARTx == USART3) {
-		USART3_PCLK_RST();
-	} else if (pUSARTx == UART4) {
-		UART4_PCLK_RST();
-	} else if (pUSARTx == UART5) {
-		UART5_PCLK_RST();
-	} else {
-		USART6_PCLK_RST();
-	}
+	RCC_PeriphReset(pUSARTx);
 }
 
 /*****************************************************
@@ -208,6 +218,8 @@ void USART_PeripheralEnable(USART_Reg_t* pUSARTx, uint8_t EnOrDi) {
  */
 void USART_SendData(USART_Handle_t* pUSARTHandler, uint8_t* pTxBuffer, uint32_t len) {
 
+	driverEnable(pUSARTHandler, ENABLE);
+
 	while (len) {
 		//Poll until TXE is set
 		while (!USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_TXE));
@@ -239,6 +251,8 @@ void USART_SendData(USART_Handle_t* pUSARTHandler, uint8_t* pTxBuffer, uint32_t
 	//Wait until the transmission is complete
 	while (!USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_TC));
 
+	//The last stop bit is out: hand the RS-485 bus back
+	driverEnable(pUSARTHandler, DISABLE);
 }
 
 /*****************************************************
@@ -307,18 +321,24 @@ void USART_ReceiveData(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32
 uint8_t USART_SendDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pTxBuffer, uint32_t len) {
 	uint8_t currState;
 	currState = pUSARTHandler->TxState;
-	if (currState != USART_BUSY_IN_TX) {
+	if (currState != USART_BUSY_IN_TX && currState != USART_BUSY_IN_TX_RING) {
 
 		//Load Txbuffer and len as global
 		pUSARTHandler->pTxBuffer = pTxBuffer;
 		pUSARTHandler->TxLen = len;
 		pUSARTHandler->TxState = USART_BUSY_IN_TX;
 
+		//Take the RS-485 bus, it is released by the TC interrupt
+		driverEnable(pUSARTHandler, ENABLE);
+
 		//Enable the TXEIE and TCIE interrupt
 		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TXEIE;
 		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TCIE;
 
-		if (pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_CTS) {
+		//Get notified whenever nCTS toggles. While nCTS is high, the hardware
+		//holds the frame in TDR so TXE stays low and no TXE interrupt is taken
+		if (pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_CTS ||
+			pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_CTS_RTS) {
 			pUSARTHandler->pUSARTx->CR3 |= 1 << USART_CR3_CTSIE;
 		}
 	}
@@ -341,11 +361,11 @@ uint8_t USART_SendDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pTxBuffer, uint
 uint8_t USART_ReceiveDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32_t len) {
 	uint8_t currState;
 	currState = pUSARTHandler->RxState;
-	if (currState != USART_BUSY_IN_RX) {
+	if (currState != USART_BUSY_IN_RX && currState != USART_BUSY_IN_RX_RING) {
 
 		//Load Rxbuffer and len as global
-		pUSARTHandler->pTxBuffer = pRxBuffer;
-		pUSARTHandler->TxLen = len;
+		pUSARTHandler->pRxBuffer = pRxBuffer;
+		pUSARTHandler->RxLen = len;
 		pUSARTHandler->RxState = USART_BUSY_IN_RX;
 
 		//Enable the RXNEIE and PE interrupt (PE as Parity Error)
@@ -356,6 +376,197 @@ uint8_t USART_ReceiveDataIT(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, u
 	return currState;
 }
 
+/*****************************************************
+ * @fn					- USART_ReceiveRingIT
+ *
+ * @brief				- Start the continuous reception into a ring buffer
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ * @param[in]			- Rx ring buffer (initialized with RingBuffer_Init)
+ *
+ * @return				- USART Rx state before the call
+ * @note				- When RTS flow control is enabled, the ISR stops draining DR as
+ * 						  soon as the ring reaches RxHighWater. The byte left in DR keeps
+ * 						  RXNE set, so the hardware deasserts nRTS and the remote
+ * 						  transmitter pauses instead of overrunning (ORE).
+ * 						  If RxHighWater/RxLowWater are 0, defaults from
+ * 						  @USART_RX_RING_HIGH_WATER_PCT are used.
+ * 						  Only 8-bit data (or 9-bit with parity) fits in the ring.
+ */
+uint8_t USART_ReceiveRingIT(USART_Handle_t* pUSARTHandler, RingBuffer_t* pRxRing) {
+	uint8_t currState;
+	currState = pUSARTHandler->RxState;
+	if (currState != USART_BUSY_IN_RX && currState != USART_BUSY_IN_RX_RING) {
+
+		pUSARTHandler->pRxRing = pRxRing;
+		pUSARTHandler->RxThrottled = RESET;
+
+		//Apply the default watermarks unless the application set them
+		if (pUSARTHandler->RxHighWater == 0 || pUSARTHandler->RxHighWater > pRxRing->Size) {
+			pUSARTHandler->RxHighWater = (pRxRing->Size * USART_RX_RING_HIGH_WATER_PCT) / 100U;
+		}
+		if (pUSARTHandler->RxLowWater == 0 || pUSARTHandler->RxLowWater >= pUSARTHandler->RxHighWater) {
+			pUSARTHandler->RxLowWater = (pRxRing->Size * USART_RX_RING_LOW_WATER_PCT) / 100U;
+		}
+		pUSARTHandler->RxState = USART_BUSY_IN_RX_RING;
+
+		//Enable the RXNEIE (also enables the ORE interrupt) and PE interrupt
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_RXNEIE;
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_PEIE;
+	}
+	return currState;
+}
+
+/*****************************************************
+ * @fn					- USART_ReadRing
+ *
+ * @brief				- Read the bytes received so far from the Rx ring buffer
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ * @param[out]			- buffer for reception (RxBuffer)
+ * @param[in]			- maximum number of bytes to read (len)
+ *
+ * @return				- number of bytes read
+ * @note				- Once the fill level drops to RxLowWater, the reception is resumed
+ * 						  and the hardware asserts nRTS again
+ */
+uint32_t USART_ReadRing(USART_Handle_t* pUSARTHandler, uint8_t* pRxBuffer, uint32_t len) {
+	uint32_t count, primask;
+
+	count = RingBuffer_Read(pUSARTHandler->pRxRing, pRxBuffer, len);
+
+	if (pUSARTHandler->RxThrottled && RingBuffer_Count(pUSARTHandler->pRxRing) <= pUSARTHandler->RxLowWater) {
+		pUSARTHandler->RxThrottled = RESET;
+
+		//The ISR also modifies CR1, so the read-modify-write must not be interrupted.
+		//Re-enabling RXNEIE fires the interrupt straight away for the byte held in DR.
+		//Reading DR empties the receive register and the hardware asserts nRTS again
+		ENTER_CRITICAL(primask);
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_RXNEIE;
+		EXIT_CRITICAL(primask);
+
+		USART_ApplicationEventCallback(pUSARTHandler, USART_EVT_RX_RESUMED);
+	}
+	return count;
+}
+
+/*****************************************************
+ * @fn					- USART_StopReceiveRing
+ *
+ * @brief				- Stop the continuous reception into the Rx ring buffer
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ *
+ * @return				- none
+ * @note				- The data still in the ring can be read with USART_ReadRing()
+ */
+void USART_StopReceiveRing(USART_Handle_t* pUSARTHandler) {
+	uint32_t primask;
+
+	ENTER_CRITICAL(primask);
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_RXNEIE);
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_PEIE);
+	EXIT_CRITICAL(primask);
+
+	pUSARTHandler->RxThrottled = RESET;
+	pUSARTHandler->RxState = USART_READY;
+}
+
+/*****************************************************
+ * @fn					- USART_AttachTxRing
+ *
+ * @brief				- Attach the Tx ring buffer used by USART_WriteRing()
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ * @param[in]			- Tx ring buffer (initialized with RingBuffer_Init)
+ *
+ * @return				- none
+ * @note				- none
+ */
+void USART_AttachTxRing(USART_Handle_t* pUSARTHandler, RingBuffer_t* pTxRing) {
+	pUSARTHandler->pTxRing = pTxRing;
+}
+
+/*****************************************************
+ * @fn					- USART_WriteRing
+ *
+ * @brief				- Queue data into the Tx ring buffer and start the transmission
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ * @param[in]			- buffer for transmission (TxBuffer)
+ * @param[in]			- length of the buffer (len)
+ *
+ * @return				- number of bytes queued (less than len when the ring is full)
+ * @note				- This is a non-blocking API. It only costs a copy into RAM,
+ * 						  the TXE interrupt sends the bytes in the background.
+ * 						  Only 8-bit data frames are supported in this mode
+ */
+uint32_t USART_WriteRing(USART_Handle_t* pUSARTHandler, const uint8_t* pTxBuffer, uint32_t len) {
+	uint32_t count, primask;
+
+	count = RingBuffer_Write(pUSARTHandler->pTxRing, pTxBuffer, len);
+
+	//Arm the TXE interrupt unless an interrupt transfer owns the transmitter
+	//(its TC handler then starts the ring when it closes).
+	//The ISR disarms TXEIE once the ring is empty, so the state and the
+	//enable bit are updated together
+	ENTER_CRITICAL(primask);
+	if (count && pUSARTHandler->TxState != USART_BUSY_IN_TX) {
+		pUSARTHandler->TxState = USART_BUSY_IN_TX_RING;
+		driverEnable(pUSARTHandler, ENABLE);
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TXEIE;
+	}
+	EXIT_CRITICAL(primask);
+
+	return count;
+}
+
+/*****************************************************
+ * @fn					- USART_EnterMuteMode
+ *
+ * @brief				- Put the receiver in mute mode
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ *
+ * @return				- none
+ * @note				- Idle line: the receiver wakes up on the next idle line, call it
+ * 						  once a message is known to be for another node. The USART must
+ * 						  have received at least one byte before the first call.
+ * 						  Address mark: the hardware mutes itself on every address byte
+ * 						  that does not match, so it is only needed to mute the node
+ * 						  before the first address byte or in the middle of a message
+ */
+void USART_EnterMuteMode(USART_Handle_t* pUSARTHandler) {
+	if (pUSARTHandler->USART_Config.WakeUpMethod != USART_WAKEUP_NONE) {
+		pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_RWU;
+	}
+}
+
+/*****************************************************
+ * @fn					- USART_SendAddress
+ *
+ * @brief				- Send an address byte to wake up a node in address mark mode
+ *
+ * @param[in]			- Handle structure of the specific USART peripheral
+ * @param[in]			- address of the destination node (0 - 15)
+ *
+ * @return				- none
+ * @note				- Blocking. The address mark is the MSB of the frame, so the
+ * 						  data bytes of a 8-bit frame must keep their bit 7 cleared
+ */
+void USART_SendAddress(USART_Handle_t* pUSARTHandler, uint8_t address) {
+	uint16_t frame;
+
+	frame = address & USART_NODE_ADDRESS_MASK;
+	frame |= (pUSARTHandler->USART_Config.WordLength == USART_WORDLEN_9BITS) ? USART_ADDRESS_MARK_9BITS : USART_ADDRESS_MARK_8BITS;
+
+	driverEnable(pUSARTHandler, ENABLE);
+	while (!USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_TXE));
+	pUSARTHandler->pUSARTx->DR = frame;
+	while (!USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_TC));
+	driverEnable(pUSARTHandler, DISABLE);
+}
+
 /*****************************************************
  * @fn					- USART_IRQITConfig
  *
@@ -422,7 +633,11 @@ void USART_IRQHandling(USART_Handle_t* pUSARTHandler) {
 	temp1 = USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_TXE);
 	temp2 = pUSARTHandler->pUSARTx->CR1 & (1 << USART_CR1_TXEIE);
 	if (temp1 && temp2) {
-		TXEInterruptHandler(pUSARTHandler);
+		if (pUSARTHandler->TxState == USART_BUSY_IN_TX_RING) {
+			TXERingInterruptHandler(pUSARTHandler);
+		} else {
+			TXEInterruptHandler(pUSARTHandler);
+		}
 	}
 
 /**********************************TC_INTERRUPT_HANDLER********************************/
@@ -433,8 +648,24 @@ void USART_IRQHandling(USART_Handle_t* pUSARTHandler) {
 		//When TCE is set, this signals the end of USART/UART transmission
 		//Note: TCE is set by hardware and cleared by software by software
 		//		sequence,
-
-
+		//Only close once every byte has left the shift register
+		if (pUSARTHandler->TxState == USART_BUSY_IN_TX && pUSARTHandler->TxLen == 0) {
+			//Clear the TC flag (rc_w0: writing 1 to the other bits has no effect)
+			pUSARTHandler->pUSARTx->SR = ~USART_FLAG_SR_TC;
+			closeTransmission(pUSARTHandler);
+
+			//Bytes queued by USART_WriteRing() during the transfer: the ring takes over
+			if (pUSARTHandler->pTxRing != NULL && RingBuffer_Count(pUSARTHandler->pTxRing)) {
+				pUSARTHandler->TxState = USART_BUSY_IN_TX_RING;
+				driverEnable(pUSARTHandler, ENABLE);
+				pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TXEIE;
+			}
+			USART_ApplicationEventCallback(pUSARTHandler, USART_EVT_TX_CMPLT);
+		} else if (pUSARTHandler->TxState == USART_READY) {
+			//The Tx ring is drained and its last frame is out: release the RS-485 bus
+			pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_TCIE);
+			driverEnable(pUSARTHandler, DISABLE);
+		}
 	}
 
 /**********************************CTS_INTERRUPT_HANDLER*******************************/
@@ -442,22 +673,51 @@ void USART_IRQHandling(USART_Handle_t* pUSARTHandler) {
 	temp2 = pUSARTHandler->pUSARTx->CR3 & (1 << USART_CR3_CTSIE);
 	if (temp1 && temp2) {
 
+		//Clear the CTS flag (rc_w0) without touching the other status bits
+		pUSARTHandler->pUSARTx->SR = ~USART_FLAG_SR_CTS;
+
+		//While nCTS was deasserted, the hardware held the frame in TDR (TXE low),
+		//which pauses the transmission with no interrupt load. When nCTS toggles,
+		//make sure the TXE interrupt is armed so the transmission resumes as soon
+		//as the shift register takes the pending frame
+		if (pUSARTHandler->TxState == USART_BUSY_IN_TX && pUSARTHandler->TxLen > 0) {
+			pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TXEIE;
+		}
+		USART_ApplicationEventCallback(pUSARTHandler, USART_EVT_CTS);
+	}
+
+/**********************************ORE_INTERRUPT_HANDLER**********************************/
+	//Note: The ORE interrupt is enabled by RXNEIE. The byte in DR is still valid,
+	//		it is read (and ORE cleared) by the RXNE handler below
+	temp1 = USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_ORE);
+	temp2 = pUSARTHandler->pUSARTx->CR1 & (1 << USART_CR1_RXNEIE);
+	if (temp1 && temp2) {
+		pUSARTHandler->OverrunCount++;
 
+		//ORE without RXNE: clear it by reading DR (SR was just read)
+		if (!USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_RXNE)) {
+			temp1 = (uint8_t) pUSARTHandler->pUSARTx->DR;
+		}
+		USART_ApplicationEventCallback(pUSARTHandler, USART_ERR_ORE);
 	}
 
 /*********************************RXNE_INTERRUPT_HANDLER*********************************/
 	temp1 = USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_RXNE);
 	temp2 = pUSARTHandler->pUSARTx->CR1 & (1 << USART_CR1_RXNEIE);
 	if (temp1 && temp2) {
-		RXNEInterruptHandler(pUSARTHandler);
-
+		if (pUSARTHandler->RxState == USART_BUSY_IN_RX_RING) {
+			RXNERingInterruptHandler(pUSARTHandler);
+		} else {
+			RXNEInterruptHandler(pUSARTHandler);
+		}
 	}
 
 /**********************************PE_INTERRUPT_HANDLER***********************************/
 	temp1 = USART_CheckStatusFlag(&pUSARTHandler->pUSARTx->SR, USART_FLAG_SR_PE);
 	temp2 = pUSARTHandler->pUSARTx->CR1 & (1 << USART_CR1_PEIE);
 	if (temp1 && temp2) {
-
+		//PE is cleared by the SR read followed by the DR read of the RXNE handler
+		USART_ApplicationEventCallback(pUSARTHandler, USART_ERR_PE);
 	}
 }
 
@@ -479,64 +739,26 @@ uint8_t USART_CheckStatusFlag(__vo uint32_t* statusReg, uint16_t flag) {
 	return FLAG_RESET;
 }
 
-/*****************************************************
- * @fn					- getPLLClkFreq();
- *
- * @brief				- This helper function returns the current I2C clock frequency PLL
- * 						  bus is supplying to this peripheral
- *
- * @param[in]			-
- *
- * @return				- none
- * @note				- See the Clock Tree diagram in STM32F4xx Reference Manual for details
- */
-static uint32_t getPLLClkFreq() {
-
-	//Implemented later
-	return 1;
-}
-
 /*****************************************************
  * @fn					- getAPBxClkFreq();
  *
- * @brief				- This helper function returns the current USART clock frequency APB1
+ * @brief				- This helper function returns the current USART clock frequency APBx
  * 						  bus is supplying to this peripheral
  *
- * @param[in]			-
+ * @param[in]			- Base address of the specific USART peripherals (USART_Reg_t* pUSARTx)
  *
- * @return				- none
+ * @return				- APBx clock frequency in Hz
  * @note				- See the Clock Tree diagram in STM32F4xx Reference Manual for details
  */
 static uint32_t getAPBxClkFreq(USART_Reg_t* pUSARTx) {
 
-	uint16_t temp, AHB1Prescalar,  APBxPrescalar;
-	uint16_t AHB1PreSclr[9] = {1, 2, 4, 6, 16, 64, 128, 256, 512};
-	uint16_t APBxPreSclr[5] = {1, 2, 4, 8, 16};
-	uint32_t sysClk;
-
-	//Determine what system clock the MCU is running
-	switch ((RCC->CFGR >> 2U) & 0x3) {
-	case RCC_HSE:	sysClk = HSE_CLK_FREQ; break; //8MHz
-	case RCC_HSI:	sysClk = HSI_CLK_FREQ; break; //16MHz
-	case RCC_PLL:	sysClk = getPLLClkFreq(); break; //See this function implementation for details
-	}
-
-	//Determine the prescalar factor AHB1 is using
-	temp = (RCC->CFGR >> 4U) & 0xF;
-	AHB1Prescalar = (temp < 8U) ? AHB1PreSclr[0] : AHB1PreSclr[temp % 8 + 1];
-
-	//Determine the prescalar factor APB1 is using
-	if (pUSARTx == USART2 || pUSARTx == USART3 || pUSARTx == UART4 || pUSARTx == UART5) {
-		//USART2, USART3, UART4, UART5 hang on APB1
-		temp = (RCC->CFGR >> 10U) & 0x7;
-	} else {
-		//USART1 and USART6 hang on APB2
-		temp = (RCC->CFGR >> 13U) & 0x7;
+	//USART1 and USART6 hang on APB2
+	if (pUSARTx == USART1 || pUSARTx == USART6) {
+		return RCC_GetPCLK2Freq();
 	}
-	APBxPrescalar = (temp < 4U) ? APBxPreSclr[0] : APBxPreSclr[temp % 8 + 1];
 
-	//Return the APB1 clock freq
-	return (sysClk / AHB1Prescalar) / APBxPrescalar;
+	//USART2, USART3, UART4, UART5 hang on APB1
+	return RCC_GetPCLK1Freq();
 }
 
 /*****************************************************
@@ -590,6 +812,11 @@ static void TXEInterruptHandler(USART_Handle_t* pUSARTHandler) {
 		pUSARTHandler->pTxBuffer++;
 	}
 	pUSARTHandler->TxLen--;
+
+	//The last byte is loaded: stop the TXE interrupt and let TC close the transmission
+	if (pUSARTHandler->TxLen == 0) {
+		pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_TXEIE);
+	}
 }
 
 /*****************************************************
@@ -631,7 +858,144 @@ static void RXNEInterruptHandler(USART_Handle_t* pUSARTHandler) {
 		pUSARTHandler->pRxBuffer++;
 	}
 	pUSARTHandler->RxLen--;
+
+	if (pUSARTHandler->RxLen == 0) {
+		closeReception(pUSARTHandler);
+		USART_ApplicationEventCallback(pUSARTHandler, USART_EVT_RX_CMPLT);
+	}
+}
+
+/*****************************************************
+ * @fn					- RXNERingInterruptHandler
+ *
+ * @brief				- helper function that handles the RXNE interrupt in ring buffer mode
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ *
+ * @return				- none
+ * @note				- Throttles the reception at the high watermark when RTS flow
+ * 						  control is enabled
+ */
+static void RXNERingInterruptHandler(USART_Handle_t* pUSARTHandler) {
+	uint8_t data, rtsEnabled;
+
+	//if parity bit is enabled in 8-bit data frame, only 7 bit are user data
+	if (pUSARTHandler->USART_Config.WordLength == USART_WORDLEN_8BITS &&
+		pUSARTHandler->USART_Config.ParityControl != USART_PARITY_DI) {
+		data = pUSARTHandler->pUSARTx->DR & ((uint8_t) 0x7F);
+	} else {
+		data = pUSARTHandler->pUSARTx->DR & ((uint8_t) 0xFF);
+	}
+
+	if (!RingBuffer_Put(pUSARTHandler->pRxRing, data)) {
+		USART_ApplicationEventCallback(pUSARTHandler, USART_ERR_RX_RING_FULL);
+	}
+
+	rtsEnabled = (pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_RTS ||
+				  pUSARTHandler->USART_Config.HWFlowControl == USART_HW_FLOW_CTRL_CTS_RTS);
+
+	if (rtsEnabled && RingBuffer_Count(pUSARTHandler->pRxRing) >= pUSARTHandler->RxHighWater) {
+		//Stop draining DR. The next byte stays in the receive register (RXNE = 1),
+		//so the hardware deasserts nRTS before the end of that frame and the
+		//remote transmitter pauses. See USART_ReadRing() for the resume path
+		pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_RXNEIE);
+		pUSARTHandler->RxThrottled = SET;
+		USART_ApplicationEventCallback(pUSARTHandler, USART_EVT_RX_THROTTLED);
+	}
+}
+
+/*****************************************************
+ * @fn					- TXERingInterruptHandler
+ *
+ * @brief				- helper function that handles the TXE interrupt in ring buffer mode
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void TXERingInterruptHandler(USART_Handle_t* pUSARTHandler) {
+	uint8_t data;
+
+	if (RingBuffer_Get(pUSARTHandler->pTxRing, &data)) {
+		pUSARTHandler->pUSARTx->DR = data;
+	} else {
+		//Nothing left to send: stop the TXE interrupt until new data is queued
+		pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_TXEIE);
+		pUSARTHandler->TxState = USART_READY;
+
+		//The last frame is still shifting out: the DE pin is released at TC
+		if (pUSARTHandler->pDEPort != NULL) {
+			pUSARTHandler->pUSARTx->CR1 |= 1 << USART_CR1_TCIE;
+		}
+	}
+}
+
+/*****************************************************
+ * @fn					- closeTransmission
+ *
+ * @brief				- helper function that closes the interrupt transmission
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void closeTransmission(USART_Handle_t* pUSARTHandler) {
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_TXEIE);
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_TCIE);
+	pUSARTHandler->pTxBuffer = NULL;
+	pUSARTHandler->TxLen = 0;
+	pUSARTHandler->TxState = USART_READY;
+	driverEnable(pUSARTHandler, DISABLE);
+}
+
+/*****************************************************
+ * @fn					- driverEnable
+ *
+ * @brief				- helper function that drives the RS-485 driver enable (DE) pin
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ * @param[in]			- ENABLE (transmit) or DISABLE (receive)
+ *
+ * @return				- none
+ * @note				- Does nothing when no DE pin is configured (pDEPort is NULL)
+ */
+static void driverEnable(USART_Handle_t* pUSARTHandler, uint8_t EnOrDi) {
+	if (pUSARTHandler->pDEPort != NULL) {
+		GPIO_WriteToOutputPin(pUSARTHandler->pDEPort, pUSARTHandler->DEPin, EnOrDi);
+	}
 }
 
-//This API is up to the user application to implement
-__weak void USART_ApplicationEventCallback(USART_Handle_t* pUSARTHandler, uint8_t appEvnt);
+/*****************************************************
+ * @fn					- closeReception
+ *
+ * @brief				- helper function that closes the interrupt reception
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ *
+ * @return				- none
+ * @note				- none
+ */
+static void closeReception(USART_Handle_t* pUSARTHandler) {
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_RXNEIE);
+	pUSARTHandler->pUSARTx->CR1 &= ~(1 << USART_CR1_PEIE);
+	pUSARTHandler->pRxBuffer = NULL;
+	pUSARTHandler->RxLen = 0;
+	pUSARTHandler->RxState = USART_READY;
+}
+
+/*****************************************************
+ * @fn					- USART_ApplicationEventCallback
+ *
+ * @brief				- Inform the user application of the event status
+ *
+ * @param[in]			- handle structure of specific UART peripheral
+ * @param[in]			- event status, see @USART_APPLICATION_EVENTS
+ *
+ * @return				- none
+ * @note				- weak implementation for user application to implement
+ */
+__weak void USART_ApplicationEventCallback(USART_Handle_t* pUSARTHandler, uint8_t appEvnt) {
+	//This API is up to the user application to implement
+}
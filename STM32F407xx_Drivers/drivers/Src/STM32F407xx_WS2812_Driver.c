@@ -0,0 +1,265 @@
+/*
+ * STM32F407xx_WS2812_Driver.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: This source file contains the WS2812 LED strip driver. The frame is
+ *      			 cut in halves of WS2812_LEDS_PER_HALF LEDs: while the DMA sends one
+ *      			 half of the circular buffer, the other one is encoded with the next
+ *      			 LEDs, then with zeros for the reset (latch) time
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*
+ * Helper functions
+ */
+static uint32_t timerClock(TIM_Reg_t* pTIMx);
+static void stopRefresh(WS2812_Handle_t* pWS2812Handler);
+static void dmaEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt);
+
+/*****************************************************
+ * @fn					- WS2812_Init
+ *
+ * @brief				- Configure the timer channel and the DMA stream of the strip
+ *
+ * @param[in]			- WS2812 handle structure
+ *
+ * @return				- none
+ * @note				- The timer runs without prescaler: ARR + 1 timer clocks per bit
+ * 						  (105 at 84 MHz). CCRx is preloaded, the value moved by the DMA
+ * 						  on an update is the duty cycle of the following period. The
+ * 						  output stays low (CCRx = 0) until WS2812_Refresh()
+ */
+void WS2812_Init(WS2812_Handle_t* pWS2812Handler) {
+	TIM_Reg_t* pTIMx = pWS2812Handler->pTIMx;
+	DMA_Handle_t* pDMAHandler = pWS2812Handler->pDMAHandler;
+	uint8_t ch = pWS2812Handler->Channel - 1;
+	__vo uint32_t* pCCMR = (ch < 2) ? &pTIMx->CCMR1 : &pTIMx->CCMR2;
+	uint8_t ccmrShift = (ch & 1U) * 8U;
+	uint32_t period = timerClock(pTIMx) / WS2812_BIT_FREQ;
+
+	pWS2812Handler->Bit0 = (period * WS2812_T0H_PCT) / 100U;
+	pWS2812Handler->Bit1 = (period * WS2812_T1H_PCT) / 100U;
+	pWS2812Handler->State = WS2812_READY;
+
+	//Timer: PWM mode 1 on the channel, preloaded ARR and CCRx
+	RCC_PeriphClockControl(pTIMx, ENABLE);
+	pTIMx->CR1 = (1 << TIM_CR1_ARPE);
+	pTIMx->PSC = 0;
+	pTIMx->ARR = period - 1U;
+	pTIMx->CCR[ch] = 0;
+	*pCCMR = (*pCCMR & ~(0xFFU << ccmrShift)) |
+			 (((TIM_OCM_PWM1 << TIM_CCMR_OCxM) | (1 << TIM_CCMR_OCxPE)) << ccmrShift);
+	pTIMx->CCER |= (1 << TIM_CCER_CCxE) << (4U * ch);
+	if (pTIMx == TIM1 || pTIMx == TIM8) {
+		pTIMx->BDTR |= (1 << TIM_BDTR_MOE);
+	}
+
+	//Load the preloaded registers, UDE is still off: no DMA request
+	pTIMx->EGR = (1 << TIM_EGR_UG);
+	pTIMx->SR = 0;
+
+	//DMA: one word per bit slot to CCRx (32-bit CCRx of TIM2/TIM5 included)
+	pDMAHandler->DMA_Config.Direction = DMA_DIR_MEM_TO_PERIPH;
+	pDMAHandler->DMA_Config.DataSize = DMA_DATA_SIZE_WORD;
+	pDMAHandler->DMA_Config.MemInc = ENABLE;
+	pDMAHandler->DMA_Config.Circular = ENABLE;
+	pDMAHandler->DMA_Config.HalfTransferIT = ENABLE;
+	pDMAHandler->Callback = dmaEventCallback;
+	pDMAHandler->pContext = pWS2812Handler;
+	DMA_Init(pDMAHandler);
+}
+
+/*****************************************************
+ * @fn					- WS2812_SetPixel
+ *
+ * @brief				- Write the color of one LED in the framebuffer
+ *
+ * @param[in]			- WS2812 handle structure
+ * @param[in]			- LED index (0: first LED of the strip)
+ * @param[in]			- red, green and blue levels
+ *
+ * @return				- none
+ * @note				- Out of range indexes are ignored
+ */
+void WS2812_SetPixel(WS2812_Handle_t* pWS2812Handler, uint16_t index, uint8_t red, uint8_t green, uint8_t blue) {
+	uint8_t* pPixel;
+
+	if (index >= pWS2812Handler->NumLeds) {
+		return;
+	}
+
+	//The strip takes green first
+	pPixel = &pWS2812Handler->pPixels[index * 3U];
+	pPixel[0] = green;
+	pPixel[1] = red;
+	pPixel[2] = blue;
+}
+
+/*****************************************************
+ * @fn					- WS2812_Fill
+ *
+ * @brief				- Write the same color to every LED of the framebuffer
+ *
+ * @param[in]			- WS2812 handle structure
+ * @param[in]			- red, green and blue levels
+ *
+ * @return				- none
+ * @note				- none
+ */
+void WS2812_Fill(WS2812_Handle_t* pWS2812Handler, uint8_t red, uint8_t green, uint8_t blue) {
+	for (uint16_t i = 0; i < pWS2812Handler->NumLeds; i++) {
+		WS2812_SetPixel(pWS2812Handler, i, red, green, blue);
+	}
+}
+
+/*****************************************************
+ * @fn					- WS2812_Refresh
+ *
+ * @brief				- Start sending the framebuffer to the strip
+ *
+ * @param[in]			- WS2812 handle structure
+ *
+ * @return				- WS2812_OK or WS2812_ERR_BUSY
+ * @note				- Non-blocking: WS2812_EVT_REFRESH_CMPLT is reported once the
+ * 						  reset time has been sent. The DMA stream IRQ must call
+ * 						  DMA_IRQHandling() with the stream handle
+ */
+uint8_t WS2812_Refresh(WS2812_Handle_t* pWS2812Handler) {
+	TIM_Reg_t* pTIMx = pWS2812Handler->pTIMx;
+
+	if (pWS2812Handler->State == WS2812_BUSY) {
+		return WS2812_ERR_BUSY;
+	}
+	pWS2812Handler->State = WS2812_BUSY;
+
+	pWS2812Handler->DataHalves = (pWS2812Handler->NumLeds + WS2812_LEDS_PER_HALF - 1U) / WS2812_LEDS_PER_HALF;
+	pWS2812Handler->TotalHalves = pWS2812Handler->DataHalves +
+								  (WS2812_RESET_SLOTS + WS2812_SLOTS_PER_HALF - 1U) / WS2812_SLOTS_PER_HALF;
+	pWS2812Handler->HalvesSent = 0;
+
+	WS2812_EncodeHalf(pWS2812Handler, 0, &pWS2812Handler->DMABuffer[0]);
+	WS2812_EncodeHalf(pWS2812Handler, 1, &pWS2812Handler->DMABuffer[WS2812_SLOTS_PER_HALF]);
+
+	DMA_Start(pWS2812Handler->pDMAHandler, (uint32_t) &pTIMx->CCR[pWS2812Handler->Channel - 1],
+			  (uint32_t) pWS2812Handler->DMABuffer, WS2812_DMA_BUFFER_LEN);
+
+	//The first update loads slot 0, it is output from the second period
+	pTIMx->CNT = 0;
+	pTIMx->DIER |= (1 << TIM_DIER_UDE);
+	pTIMx->CR1 |= (1 << TIM_CR1_CEN);
+
+	return WS2812_OK;
+}
+
+/*****************************************************
+ * @fn					- WS2812_EncodeHalf
+ *
+ * @brief				- Encode the bit slots of one half of the stream
+ *
+ * @param[in]			- WS2812 handle structure
+ * @param[in]			- half number in the frame
+ * @param[out]			- WS2812_SLOTS_PER_HALF words
+ *
+ * @return				- none
+ * @note				- MSB first, one CCRx value per bit: Bit0 or Bit1. The slots
+ * 						  past the last LED are 0 (no pulse, low level)
+ */
+void WS2812_EncodeHalf(WS2812_Handle_t* pWS2812Handler, uint16_t half, uint32_t* pSlots) {
+	uint32_t first = (uint32_t) half * WS2812_LEDS_PER_HALF;
+	uint32_t bytes = 0;
+	uint32_t bit0 = pWS2812Handler->Bit0;
+	uint32_t delta = pWS2812Handler->Bit1 - pWS2812Handler->Bit0;
+	const uint8_t* pPixel;
+	uint32_t data;
+
+	if (first < pWS2812Handler->NumLeds) {
+		bytes = pWS2812Handler->NumLeds - first;
+		if (bytes > WS2812_LEDS_PER_HALF) {
+			bytes = WS2812_LEDS_PER_HALF;
+		}
+		bytes *= 3U;
+	}
+
+	pPixel = &pWS2812Handler->pPixels[first * 3U];
+	for (uint32_t i = 0; i < bytes; i++) {
+		data = *pPixel++;
+#pragma GCC unroll 8
+		for (int8_t n = 7; n >= 0; n--) {
+			*pSlots++ = bit0 + ((data >> n) & 1U) * delta;
+		}
+	}
+
+	memset(pSlots, 0, (WS2812_SLOTS_PER_HALF - bytes * 8U) * sizeof(uint32_t));
+}
+
+/*****************************************************
+ * @fn					- WS2812_ApplicationEventCallback
+ *
+ * @brief				- Application event callback
+ *
+ * @param[in]			- WS2812 handle structure
+ * @param[in]			- WS2812_EVT_REFRESH_CMPLT or WS2812_ERR_DMA
+ *
+ * @return				- none
+ * @note				- Weak implementation, the application may override this function
+ */
+__weak void WS2812_ApplicationEventCallback(WS2812_Handle_t* pWS2812Handler, uint8_t appEvt) {
+
+}
+
+/*
+ * Some helper functions implementation
+ */
+
+//The APB timers run at 2 x PCLK when the APB prescaler is not 1
+static uint32_t timerClock(TIM_Reg_t* pTIMx) {
+	uint32_t hclk = RCC_GetHCLKFreq();
+	uint32_t pclk = ((uint32_t) pTIMx >= APB2_BASEADDR) ? RCC_GetPCLK2Freq() : RCC_GetPCLK1Freq();
+
+	return (pclk == hclk) ? pclk : 2U * pclk;
+}
+
+//The last slot moved is a 0: the line stays low once the timer is stopped
+static void stopRefresh(WS2812_Handle_t* pWS2812Handler) {
+	TIM_Reg_t* pTIMx = pWS2812Handler->pTIMx;
+
+	pTIMx->DIER &= ~(1 << TIM_DIER_UDE);
+	DMA_Stop(pWS2812Handler->pDMAHandler);
+	pTIMx->CR1 &= ~(1 << TIM_CR1_CEN);
+	pTIMx->CCR[pWS2812Handler->Channel - 1] = 0;
+	pWS2812Handler->State = WS2812_READY;
+}
+
+//Half transfer: the first half has been moved to CCRx, the DMA is on the second one.
+//Transfer complete: the other way around. The half just moved is refilled with
+//the half of the frame that follows the one being sent
+static void dmaEventCallback(DMA_Handle_t* pDMAHandler, uint8_t appEvt) {
+	WS2812_Handle_t* pWS2812Handler = (WS2812_Handle_t*) pDMAHandler->pContext;
+	uint32_t* pHalf;
+	uint16_t next;
+
+	if (appEvt == DMA_EVT_HALF_CMPLT) {
+		pHalf = &pWS2812Handler->DMABuffer[0];
+	} else if (appEvt == DMA_EVT_TRANSFER_CMPLT) {
+		pHalf = &pWS2812Handler->DMABuffer[WS2812_SLOTS_PER_HALF];
+	} else {
+		stopRefresh(pWS2812Handler);
+		WS2812_ApplicationEventCallback(pWS2812Handler, WS2812_ERR_DMA);
+		return;
+	}
+
+	pWS2812Handler->HalvesSent++;
+	if (pWS2812Handler->HalvesSent >= pWS2812Handler->TotalHalves) {
+		stopRefresh(pWS2812Handler);
+		WS2812_ApplicationEventCallback(pWS2812Handler, WS2812_EVT_REFRESH_CMPLT);
+		return;
+	}
+
+	//Encoded two halves ago: a reset half is already all 0
+	next = pWS2812Handler->HalvesSent + 1U;
+	if (next < pWS2812Handler->DataHalves + 2U) {
+		WS2812_EncodeHalf(pWS2812Handler, next, pHalf);
+	}
+}
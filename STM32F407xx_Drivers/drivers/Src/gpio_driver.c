@@ -8,6 +8,12 @@
  */
 #include "../Inc/gpio_driver.h"
 
+/*
+ * Helper functions
+ */
+static uint32_t pinMask2(uint16_t pins);
+static uint32_t pinMask4(uint8_t pins);
+
 /*****************************************************
  * @fn					- GPIO_PeriClkCtrl
  *
@@ -23,7 +29,6 @@ void GPIO_PeriClkCtrl(GPIO_Reg_t* pGPIOx, uint8_t EnOrDi) {
 
 	//Enable or disable the GPIO clock peripherals
 	if (EnOrDi) {
-		//Special note: switch cannot be used for pointer, only integer
 		GPIO_PCLK_EN(pGPIOx);
 	} else {
 		GPIO_PCLK_DI(pGPIOx);
@@ -40,80 +45,131 @@ void GPIO_PeriClkCtrl(GPIO_Reg_t* pGPIOx, uint8_t EnOrDi) {
  * @param[in]			-
  *
  * @return				- none
- * @note				- none
+ * @note				- Same as GPIO_InitPort() with a single configuration: the
+ * 						  previous fields of the pins are replaced, so the pins can be
+ * 						  initialized again with another mode
  */
 void GPIO_Init(GPIO_Handle_t* pGPIOHandler) {
+	GPIO_InitPort(pGPIOHandler->pGPIOx, &pGPIOHandler->GPIOx_PinConfig, 1);
+}
 
-	//uint32_t temp;
-	GPIO_Reg_t* GPIOx = pGPIOHandler->pGPIOx;
-	GPIO_PinConfig_t GPIOx_PinConf = pGPIOHandler->GPIOx_PinConfig;
+/*****************************************************
+ * @fn					- GPIO_InitPort
+ *
+ * @brief				- Initialize several pins of a GPIO port at once
+ *
+ * @param[in]			- Base address of the GPIO port
+ * @param[in]			- table of pin configurations
+ * @param[in]			- number of entries in the table
+ *
+ * @return				- none
+ * @note				- The register images (value and mask) are built in locals first,
+ * 						  then every register is written once: (reg & ~mask) | value.
+ * 						  The pins leave the interrupt mode cleanly: their EXTI line is
+ * 						  masked if it still selects this port
+ */
+void GPIO_InitPort(GPIO_Reg_t* pGPIOx, const GPIO_PinConfig_t* pPinConfigs, uint8_t count) {
+	uint32_t moder = 0, otyper = 0, ospeedr = 0, pupdr = 0;
+	uint32_t mask2 = 0, mask1 = 0;
+	uint32_t afr[2] = { 0, 0 }, afrMask[2] = { 0, 0 };
+	uint32_t exticr[4] = { 0, 0, 0, 0 }, exticrMask[4] = { 0, 0, 0, 0 };
+	uint32_t ftsr = 0, rtsr = 0, itPins = 0, otherPins = 0, lines;
+	uint32_t portIndex = GPIO_PORT_INDEX(pGPIOx);
+	uint32_t mode;
+
+	for (uint8_t n = 0; n < count; n++) {
+		const GPIO_PinConfig_t* pConf = &pPinConfigs[n];
+
+		for (uint16_t i = 0U; i < GPIO_PIN_NUMBER; i++) {
+
+			//Check if the ith bit is set
+			if (!(pConf->GPIO_PinNumber & (1U << i))) {
+				continue;
+			}
 
-	//Enable the GPIO Clock
-	GPIO_PeriClkCtrl(GPIOx, ENABLE);
-
-	/*Note: before setting the bits: make sure those registers are clear */
-	//Clearing the registers
-	//Setting the bits register
-	for (uint16_t i = 0U; i < GPIO_PIN_NUMBER; i++) {
-
-		//Check if the ith bit is set
-		if (GPIOx_PinConf.GPIO_PinNumber & (1 << i)) {
-
-			//Handle the GPIO pin alternate function mode and GPIO output mode
-			if (GPIOx_PinConf.GPIO_PinMode == GPIO_ALT_FUNC_MODE || GPIOx_PinConf.GPIO_PinMode == GPIO_OUTPUT_MODE) {
-				if (i < (GPIO_PIN_NUMBER / 2)) {
-					GPIOx->AFR[0] |= (GPIOx_PinConf.GPIO_PinAltFuncMode << i * 4U);
-				} else {
-					GPIOx->AFR[1] |= (GPIOx_PinConf.GPIO_PinAltFuncMode << (i % (GPIO_PIN_NUMBER / 2)) * 4U);
+			//The interrupt modes are inputs for the MODER register
+			mode = pConf->GPIO_PinMode;
+			if (mode == GPIO_IT_FT_MODE || mode == GPIO_IT_RT_MODE || mode == GPIO_IT_RFT_MODE) {
+				itPins |= (1U << i);
+				if (mode != GPIO_IT_RT_MODE) {
+					ftsr |= (1U << i);
+				}
+				if (mode != GPIO_IT_FT_MODE) {
+					rtsr |= (1U << i);
 				}
 
-				//Configure the OTYPER register
-				GPIOx->OTYPER |= (GPIOx_PinConf.GPIO_PinOPType << i);
-
-				//Configure the OSPEED register
-				GPIOx->OSPEEDR |= (GPIOx_PinConf.GPIO_PinSpeed << i * 2U);
+				//Port selection of the EXTI line in SYSCFG_EXTICR (4 lines per register)
+				exticr[i >> 2U] |= portIndex << ((i & 0x03U) * 4U);
+				exticrMask[i >> 2U] |= 0x0FU << ((i & 0x03U) * 4U);
+				mode = GPIO_INPUT_MODE;
+			} else {
+				otherPins |= (1U << i);
 			}
 
-			//Handle the GPIO pin interrupt mode
-			if ((GPIOx_PinConf.GPIO_PinMode == GPIO_IT_FT_MODE) || (GPIOx_PinConf.GPIO_PinMode == GPIO_IT_RT_MODE)
-				|| (GPIOx_PinConf.GPIO_PinMode == GPIO_IT_RFT_MODE)) {
-
-				//Enable the clock for SYSCFG registers
-				SYSCFG_PCLK_EN();
-
-				//Handling the falling edge cases
-				if (GPIOx_PinConf.GPIO_PinMode == GPIO_IT_FT_MODE) {
-					//Configure the FTSR
-					EXTI->FTSR |= (1 << i);
-					EXTI->RTSR &= ~(1 << i); //Clear the corresponding RTSR bit
-				} else if (GPIOx_PinConf.GPIO_PinMode == GPIO_IT_RT_MODE) {
-					//Configure the RTSR
-					EXTI->RTSR |= (1 << i);
-					EXTI->FTSR &= ~(1 << i); //Clear the corresponding FTSR bit
-				}  else {
-					//Configure both the FTSR and RTSR
-					EXTI->FTSR |= (1 << i);
-					EXTI->RTSR |= (1 << i);
-				}
-
-				//Configure the GPIO port selection in SYSCFG_EXTICR
-				//Rule: int quotient = n >> z
-				//		int remainder = n & (~(~(int) 0) << z)
-				//In this case, since we always want z = 2, as we divide by 4,
-				//the term ~(~(int) 0) << z) = 0x03U
-				SYSCFG->EXTICR[i >> 2U] |= GPIO_PORT_INDEX(GPIOx) << ((i & 0x03U) * 4U);
+			//2-bit fields: MODER, OSPEEDR, PUPDR
+			//Note: the values are cut to the field width so they never spill into
+			//		the field of a pin that is not selected
+			mask2 |= (0x03U << i * 2U);
+			moder |= ((mode & 0x03U) << i * 2U);
+			ospeedr |= ((pConf->GPIO_PinSpeed & 0x03U) << i * 2U);
+			pupdr |= ((pConf->GPIO_PinPuPdCtrl & 0x03U) << i * 2U);
+
+			//1-bit field: OTYPER
+			mask1 |= (1U << i);
+			otyper |= ((pConf->GPIO_PinOPType & 0x01U) << i);
+
+			//4-bit field: AFR[0] for the pins 0 to 7, AFR[1] for the pins 8 to 15
+			afr[i >> 3U] |= ((pConf->GPIO_PinAltFuncMode & 0x0FU) << (i & 0x07U) * 4U);
+			afrMask[i >> 3U] |= (0x0FU << (i & 0x07U) * 4U);
+		}
+	}
 
-				//Enable the EXTI interrupt delivery using IMR
-				EXTI->IMR |= (1 << i);
+	//Enable the GPIO Clock
+	GPIO_PeriClkCtrl(pGPIOx, ENABLE);
+
+	//MODER last so the pins switch with their final type, speed, pull and function
+	pGPIOx->OTYPER = (pGPIOx->OTYPER & ~mask1) | otyper;
+	pGPIOx->OSPEEDR = (pGPIOx->OSPEEDR & ~mask2) | ospeedr;
+	pGPIOx->PUPDR = (pGPIOx->PUPDR & ~mask2) | pupdr;
+	if (afrMask[0]) {
+		pGPIOx->AFR[0] = (pGPIOx->AFR[0] & ~afrMask[0]) | afr[0];
+	}
+	if (afrMask[1]) {
+		pGPIOx->AFR[1] = (pGPIOx->AFR[1] & ~afrMask[1]) | afr[1];
+	}
+	pGPIOx->MODER = (pGPIOx->MODER & ~mask2) | moder;
+
+	//Release the EXTI lines of the pins leaving the interrupt mode. SYSCFG_EXTICR
+	//only tells the owner of a line while the SYSCFG clock is enabled
+	if (otherPins && (RCC->APB2ENR & (1U << 14U))) {
+		for (uint16_t i = 0U; i < GPIO_PIN_NUMBER; i++) {
+			if ((otherPins & (1U << i)) &&
+				((SYSCFG->EXTICR[i >> 2U] >> ((i & 0x03U) * 4U)) & 0x0FU) != portIndex) {
+				otherPins &= ~(1U << i);
 			}
+		}
+	} else {
+		otherPins = 0;
+	}
 
-			//Handle the MODER register
-			GPIOx->MODER |= (GPIOx_PinConf.GPIO_PinMode << i * 2U);
+	if (itPins) {
+		//Enable the clock for SYSCFG registers
+		SYSCFG_PCLK_EN();
 
-			//Handle the PuPdCtrl Register
-			GPIOx->PUPDR |= (GPIOx_PinConf.GPIO_PinPuPdCtrl << i * 2U);
+		for (uint8_t k = 0; k < 4U; k++) {
+			if (exticrMask[k]) {
+				SYSCFG->EXTICR[k] = (SYSCFG->EXTICR[k] & ~exticrMask[k]) | exticr[k];
+			}
 		}
 	}
+
+	//Edges first, then the interrupt delivery using IMR
+	lines = itPins | otherPins;
+	if (lines) {
+		EXTI->FTSR = (EXTI->FTSR & ~lines) | ftsr;
+		EXTI->RTSR = (EXTI->RTSR & ~lines) | rtsr;
+		EXTI->IMR = (EXTI->IMR & ~lines) | itPins;
+	}
 }
 
 /*****************************************************
@@ -131,29 +187,110 @@ void GPIO_Init(GPIO_Handle_t* pGPIOHandler) {
 void GPIO_DeInit(GPIO_Reg_t *pGPIOx) {
 
 	//Reset all the registers of the respective GPIO peripherals
-	if (pGPIOx == GPIOA) {
-		GPIOA_PCLK_RST();
-	} else if (pGPIOx == GPIOB) {
-		GPIOB_PCLK_RST();
-	} else if (pGPIOx == GPIOC) {
-		GPIOC_PCLK_RST();
-	} else if (pGPIOx == GPIOD) {
-		GPIOD_PCLK_RST();
-	} else if (pGPIOx == GPIOE) {
-		GPIOE_PCLK_RST();
-	} else if (pGPIOx == GPIOF) {
-		GPIOF_PCLK_RST();
-	} else if (pGPIOx == GPIOG) {
-		GPIOG_PCLK_RST();
-	} else if (pGPIOx == GPIOH) {
-		GPIOH_PCLK_RST();
-	} else if (pGPIOx == GPIOI) {
-		GPIOI_PCLK_RST();
-	} else if (pGPIOx == GPIOJ) {
-		GPIOJ_PCLK_RST();
-	} else if (pGPIOx == GPIOK) {
-		GPIOK_PCLK_RST();
+	RCC_PeriphReset(pGPIOx);
+}
+
+/*****************************************************
+ * @fn					- GPIO_SaveState
+ *
+ * @brief				- Copy the configuration registers of a GPIO port
+ *
+ * @param[in]			- Base address of the GPIO port
+ * @param[out]			- port state
+ *
+ * @return				- none
+ * @note				- none
+ */
+void GPIO_SaveState(GPIO_Reg_t* pGPIOx, GPIO_PortState_t* pState) {
+	pState->MODER = pGPIOx->MODER;
+	pState->OTYPER = pGPIOx->OTYPER;
+	pState->OSPEEDR = pGPIOx->OSPEEDR;
+	pState->PUPDR = pGPIOx->PUPDR;
+	pState->AFR[0] = pGPIOx->AFR[0];
+	pState->AFR[1] = pGPIOx->AFR[1];
+}
+
+/*****************************************************
+ * @fn					- GPIO_RestoreState
+ *
+ * @brief				- Put back the saved configuration of some pins of a GPIO port
+ *
+ * @param[in]			- Base address of the GPIO port
+ * @param[in]			- port state from GPIO_SaveState()
+ * @param[in]			- mask of @GPIO_PIN_NO (GPIO_PIN_ALL: whole port)
+ *
+ * @return				- none
+ * @note				- Each register is written once: (reg & ~mask) | (saved & mask).
+ * 						  MODER is written last, the pins switch mode with their type,
+ * 						  pull and alternate function already in place (no glitch on a
+ * 						  pin going back to its peripheral). Locked pins keep their
+ * 						  configuration
+ */
+void GPIO_RestoreState(GPIO_Reg_t* pGPIOx, const GPIO_PortState_t* pState, uint16_t pins) {
+	uint32_t mask2 = pinMask2(pins);
+	uint32_t mask4;
+
+	pGPIOx->OTYPER = (pGPIOx->OTYPER & ~(uint32_t) pins) | (pState->OTYPER & pins);
+	pGPIOx->OSPEEDR = (pGPIOx->OSPEEDR & ~mask2) | (pState->OSPEEDR & mask2);
+	pGPIOx->PUPDR = (pGPIOx->PUPDR & ~mask2) | (pState->PUPDR & mask2);
+
+	//AFR[0] for the pins 0 to 7, AFR[1] for the pins 8 to 15
+	if (pins & 0x00FFU) {
+		mask4 = pinMask4((uint8_t) pins);
+		pGPIOx->AFR[0] = (pGPIOx->AFR[0] & ~mask4) | (pState->AFR[0] & mask4);
+	}
+	if (pins & 0xFF00U) {
+		mask4 = pinMask4((uint8_t) (pins >> 8));
+		pGPIOx->AFR[1] = (pGPIOx->AFR[1] & ~mask4) | (pState->AFR[1] & mask4);
 	}
+
+	pGPIOx->MODER = (pGPIOx->MODER & ~mask2) | (pState->MODER & mask2);
+}
+
+/*****************************************************
+ * @fn					- GPIO_LockPins
+ *
+ * @brief				- Freeze the configuration of some pins of a GPIO port
+ *
+ * @param[in]			- Base address of the GPIO port
+ * @param[in]			- mask of @GPIO_PIN_NO
+ *
+ * @return				- SET if the port is locked, RESET otherwise
+ * @note				- Key sequence of the RM: write LCKK = 1, LCKK = 0, LCKK = 1 with
+ * 						  the same LCK[15:0], then read LCKR twice. MODER, OTYPER,
+ * 						  OSPEEDR, PUPDR and AFR of the locked pins can no longer be
+ * 						  written until the next reset (ODR/BSRR still work). Fails on
+ * 						  a port that is already locked
+ */
+uint8_t GPIO_LockPins(GPIO_Reg_t* pGPIOx, uint16_t pins) {
+	uint32_t key = (1U << GPIO_LCKR_LCKK) | pins;
+	uint32_t primask;
+	__vo uint32_t dummyRead;
+
+	//An LCKR write from an ISR in the middle would abort the sequence
+	ENTER_CRITICAL(primask);
+	pGPIOx->LCKR = key;
+	pGPIOx->LCKR = pins;
+	pGPIOx->LCKR = key;
+	dummyRead = pGPIOx->LCKR;
+	(void) dummyRead;
+	EXIT_CRITICAL(primask);
+
+	return GPIO_IsLocked(pGPIOx);
+}
+
+/*****************************************************
+ * @fn					- GPIO_IsLocked
+ *
+ * @brief				- Read the lock key bit of a GPIO port
+ *
+ * @param[in]			- Base address of the GPIO port
+ *
+ * @return				- SET if the port is locked, RESET otherwise
+ * @note				- none
+ */
+uint8_t GPIO_IsLocked(GPIO_Reg_t* pGPIOx) {
+	return (pGPIOx->LCKR & (1U << GPIO_LCKR_LCKK)) ? SET : RESET;
 }
 
 /*****************************************************
@@ -217,12 +354,50 @@ void GPIO_WriteToOutputPin(GPIO_Reg_t* pGPIOx, uint16_t pinNumber, uint8_t value
  *
  *
  * @return				- none
- * @note				- none
+ * @note				- Overwrites the whole ODR: an ISR writing other pins of the port in
+ * 						  between can be undone, see GPIO_WriteMasked() for a pin subset
  */
 void GPIO_WriteToOutputPort(GPIO_Reg_t* pGPIOx, uint16_t value) {
 	pGPIOx->ODR = value;
 }
 
+/*****************************************************
+ * @fn					- GPIO_WriteMaskedBulk
+ *
+ * @brief				- Write a stream of values to a group of pins of the port
+ *
+ * @param[in]			- GPIO base address
+ * @param[in]			- pins driven by the values
+ * @param[in]			- values (only the bits of the mask are used)
+ * @param[in]			- number of values
+ * @param[in]			- strobe pins pulsed low with each value, 0 if not used
+ *
+ * @return				- none
+ * @note				- One BSRR store per value (two with a strobe): every pin of the
+ * 						  group switches on the same clock edge, so the bus never shows
+ * 						  an intermediate value, and the other pins of the port are safe
+ * 						  from the read-modify-write of an ISR
+ */
+void GPIO_WriteMaskedBulk(GPIO_Reg_t* pGPIOx, uint16_t mask, const uint16_t* pValues, uint32_t len,
+						  uint16_t strobe) {
+	uint32_t strobeLow = (uint32_t) strobe << GPIO_PIN_NUMBER;
+	uint16_t value;
+
+	mask &= ~strobe;
+	while (len) {
+		value = *pValues;
+
+		//Data and strobe low in the same store, then the rising edge of the strobe
+		pGPIOx->BSRR = ((uint32_t) (~value & mask) << GPIO_PIN_NUMBER) | (value & mask) | strobeLow;
+		if (strobe) {
+			pGPIOx->BSRR = strobe;
+		}
+
+		pValues++;
+		len--;
+	}
+}
+
 /*****************************************************
  * @fn					- GPIO_ToggleOutputPin
  *
@@ -322,3 +497,27 @@ void GPIO_IRQHandling(uint8_t pinNumber) {
 	}
 }
 
+/*
+ * Some helper functions implementation
+ */
+
+//Each pin bit spread to a 2-bit field (MODER, OSPEEDR, PUPDR), set to 0b11
+static uint32_t pinMask2(uint16_t pins) {
+	uint32_t x = pins;
+
+	x = (x | (x << 8)) & 0x00FF00FFU;
+	x = (x | (x << 4)) & 0x0F0F0F0FU;
+	x = (x | (x << 2)) & 0x33333333U;
+	x = (x | (x << 1)) & 0x55555555U;
+	return x * 0x3U;
+}
+
+//Each pin bit of a byte spread to a 4-bit field (AFRL or AFRH), set to 0xF
+static uint32_t pinMask4(uint8_t pins) {
+	uint32_t x = pins;
+
+	x = (x | (x << 12)) & 0x000F000FU;
+	x = (x | (x << 6)) & 0x03030303U;
+	x = (x | (x << 3)) & 0x11111111U;
+	return x * 0xFU;
+}
@@ -0,0 +1,179 @@
+/*
+ * ring_buffer.c
+ *
+ *  Created on: Oct 2, 2020
+ *      Author: Donavan Tran
+ *      Description: This is the source code of the generic byte ring buffer
+ */
+
+#include "../Inc/stm32f407xx.h"
+
+/*****************************************************
+ * @fn					- RingBuffer_Init
+ *
+ * @brief				- Attach the user storage to the ring buffer and empty it
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ * @param[in]			- storage buffer
+ * @param[in]			- size of the storage buffer (power of 2)
+ *
+ * @return				- none
+ * @note				- If size is not a power of 2, it is rounded down to one
+ */
+void RingBuffer_Init(RingBuffer_t* pRing, uint8_t* pBuffer, uint32_t size) {
+
+	//Round the size down to the closest power of 2 so that
+	//the index can be computed with a mask instead of a modulo
+	while (!RING_BUFFER_SIZE_VALID(size) && size) {
+		size &= size - 1U; //clear the lowest set bit
+	}
+
+	pRing->pBuffer = pBuffer;
+	pRing->Size = size;
+	pRing->Head = 0;
+	pRing->Tail = 0;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Flush
+ *
+ * @brief				- Discard all the data in the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ *
+ * @return				- none
+ * @note				- Only the consumer side should call this function
+ */
+void RingBuffer_Flush(RingBuffer_t* pRing) {
+	pRing->Tail = pRing->Head;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Put
+ *
+ * @brief				- Push one byte into the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ * @param[in]			- data byte
+ *
+ * @return				- SET if the byte is stored, RESET if the buffer is full
+ * @note				- Producer side
+ */
+uint8_t RingBuffer_Put(RingBuffer_t* pRing, uint8_t data) {
+	uint32_t head = pRing->Head;
+
+	if ((head - pRing->Tail) >= pRing->Size) {
+		return RESET; //full
+	}
+	pRing->pBuffer[head & (pRing->Size - 1U)] = data;
+
+	//Publish the byte only after it is written into the storage
+	pRing->Head = head + 1U;
+	return SET;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Get
+ *
+ * @brief				- Pop one byte from the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ * @param[out]			- data byte
+ *
+ * @return				- SET if a byte is read, RESET if the buffer is empty
+ * @note				- Consumer side
+ */
+uint8_t RingBuffer_Get(RingBuffer_t* pRing, uint8_t* pData) {
+	uint32_t tail = pRing->Tail;
+
+	if (tail == pRing->Head) {
+		return RESET; //empty
+	}
+	*pData = pRing->pBuffer[tail & (pRing->Size - 1U)];
+
+	//Release the slot only after the byte is read out
+	pRing->Tail = tail + 1U;
+	return SET;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Write
+ *
+ * @brief				- Push a block of bytes into the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ * @param[in]			- data buffer
+ * @param[in]			- length of the data buffer
+ *
+ * @return				- number of bytes stored
+ * @note				- Producer side. Stops when the buffer is full
+ */
+uint32_t RingBuffer_Write(RingBuffer_t* pRing, const uint8_t* pData, uint32_t len) {
+	uint32_t head = pRing->Head;
+	uint32_t space = pRing->Size - (head - pRing->Tail);
+	uint32_t i;
+
+	if (len > space) {
+		len = space;
+	}
+	for (i = 0; i < len; i++) {
+		pRing->pBuffer[(head + i) & (pRing->Size - 1U)] = pData[i];
+	}
+	pRing->Head = head + len;
+	return len;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Read
+ *
+ * @brief				- Pop a block of bytes from the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ * @param[out]			- data buffer
+ * @param[in]			- maximum number of bytes to read
+ *
+ * @return				- number of bytes read
+ * @note				- Consumer side. Stops when the buffer is empty
+ */
+uint32_t RingBuffer_Read(RingBuffer_t* pRing, uint8_t* pData, uint32_t len) {
+	uint32_t tail = pRing->Tail;
+	uint32_t count = pRing->Head - tail;
+	uint32_t i;
+
+	if (len > count) {
+		len = count;
+	}
+	for (i = 0; i < len; i++) {
+		pData[i] = pRing->pBuffer[(tail + i) & (pRing->Size - 1U)];
+	}
+	pRing->Tail = tail + len;
+	return len;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Count
+ *
+ * @brief				- Number of bytes currently stored in the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ *
+ * @return				- number of bytes stored
+ * @note				- none
+ */
+uint32_t RingBuffer_Count(RingBuffer_t* pRing) {
+	return pRing->Head - pRing->Tail;
+}
+
+/*****************************************************
+ * @fn					- RingBuffer_Free
+ *
+ * @brief				- Number of bytes that can still be stored in the ring buffer
+ *
+ * @param[in]			- pointer to the ring buffer structure
+ *
+ * @return				- number of free bytes
+ * @note				- none
+ */
+uint32_t RingBuffer_Free(RingBuffer_t* pRing) {
+	return pRing->Size - (pRing->Head - pRing->Tail);
+}
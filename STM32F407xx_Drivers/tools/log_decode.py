@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+log_decode.py
+
+ Created on: Oct 6, 2020
+     Author: Donavan Tran
+     Description: Host decoder of the tokenized logger (drivers/Src/STM32F407xx_Log.c).
+                  The format strings are read from the .logstr section of the
+                  firmware ELF, the binary records are read from a capture file,
+                  a serial port or stdin, and the text is rebuilt on the host.
+
+ Usage:
+     stty -F /dev/ttyUSB0 115200 raw -echo
+     python3 tools/log_decode.py Debug/STM32F407xx_Drivers.elf /dev/ttyUSB0
+     python3 tools/log_decode.py --clock 168000000 firmware.elf capture.bin
+
+ Only the Python standard library is used.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Must match STM32F407xx_Log.h
+LOG_RECORD_SYNC = 0xA
+LOG_MAX_ARGS = 4
+LOG_ID_MASK = 0x00FFFFFF
+LOG_ID_DROPPED = LOG_ID_MASK
+
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|j|z|t)?([diouxXcp%])")
+
+
+def load_logstr(elf_path):
+    """Return (section address, section bytes) of .logstr in an ELF32 little-endian file."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise SystemExit("%s: not an ELF32 little-endian file" % elf_path)
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        # sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size
+        return struct.unpack_from("<IIIIII", elf, e_shoff + index * e_shentsize)
+
+    names = section(e_shstrndx)
+    for i in range(e_shnum):
+        sh_name, _, _, sh_addr, sh_offset, sh_size = section(i)
+        end = elf.index(b"\0", names[4] + sh_name)
+        if elf[names[4] + sh_name:end] == b".logstr":
+            return sh_addr, elf[sh_offset:sh_offset + sh_size]
+
+    raise SystemExit("%s: no .logstr section (is the logger linked in?)" % elf_path)
+
+
+def format_record(fmt, args):
+    """Apply the printf format string to the raw 32-bit arguments."""
+    values = iter(args)
+
+    def convert(match):
+        flags, width, precision, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "c":
+            value = chr(value & 0xFF)
+        elif conv == "p":
+            flags, width, conv = "#0", "10", "x"
+        spec = "%" + flags + width + ("." + precision if precision else "") + conv
+        return spec % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def records(stream):
+    """Yield (id, timestamp, args) records, resynchronizing on corrupted bytes."""
+    data = b""
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            return
+        data += chunk
+        while len(data) >= 8:
+            header, = struct.unpack_from("<I", data, 0)
+            nargs = (header >> 24) & 0xF
+            if (header >> 28) != LOG_RECORD_SYNC or nargs > LOG_MAX_ARGS:
+                data = data[1:]  # lost alignment: slide one byte
+                continue
+            size = 4 * (2 + nargs)
+            if len(data) < size:
+                break
+            words = struct.unpack_from("<%dI" % (2 + nargs), data, 0)
+            data = data[size:]
+            yield header & LOG_ID_MASK, words[1], words[2:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the tokenized log stream of the STM32F407xx drivers")
+    parser.add_argument("elf", help="firmware ELF file containing the .logstr section")
+    parser.add_argument("input", nargs="?", help="capture file or serial device (default: stdin)")
+    parser.add_argument("--clock", type=int, default=16000000, help="HCLK frequency in Hz (default: 16000000)")
+    options = parser.parse_args()
+
+    base, strings = load_logstr(options.elf)
+    stream = open(options.input, "rb", buffering=0) if options.input else sys.stdin.buffer
+
+    elapsed = 0
+    previous = None
+    for ident, timestamp, args in records(stream):
+        # CYCCNT is 32-bit: accumulate the deltas to survive the wrap around
+        if previous is not None:
+            elapsed += (timestamp - previous) & 0xFFFFFFFF
+        previous = timestamp
+        stamp = "[%12.6f]" % (elapsed / options.clock)
+
+        if ident == LOG_ID_DROPPED:
+            print("%s <%d record(s) dropped>" % (stamp, args[0]))
+            continue
+
+        offset = ident - base
+        if offset < 0 or offset >= len(strings):
+            print("%s <unknown log id 0x%06x>" % (stamp, ident))
+            continue
+        fmt = strings[offset:strings.index(b"\0", offset)].decode("utf-8", "replace")
+        print("%s %s" % (stamp, format_record(fmt, args).rstrip("\r\n")))
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+swo_parse.py
+
+ Created on: Oct 8, 2020
+     Author: Donavan Tran
+     Description: Host parser of captured SWO byte streams (ITM packet protocol).
+                  The stimulus packets are split per port: the text port is
+                  printed as is, the other ports are dumped in hex, or the raw
+                  payload of one port is forwarded to another tool.
+
+ Usage:
+     python3 tools/swo_parse.py capture.swo
+     python3 tools/swo_parse.py --port 0 --port 2 capture.swo
+     python3 tools/swo_parse.py --raw 1 capture.swo | python3 tools/log_decode.py firmware.elf
+
+ Only the Python standard library is used.
+"""
+
+import argparse
+import sys
+
+# Must match STM32F407xx_ITM_Driver.h
+ITM_PORT_PRINTF = 0
+
+PAYLOAD_SIZE = {1: 1, 2: 2, 3: 4}
+
+
+def packets(data):
+    """Yield (kind, port, payload) tuples from a raw SWO byte stream.
+
+    kind is one of "sync", "overflow", "stimulus", "hardware", "timestamp", "extension".
+    """
+    i = 0
+    size = len(data)
+    while i < size:
+        header = data[i]
+        i += 1
+
+        if header == 0x00:
+            # Synchronization: at least 47 zero bits followed by a 1 bit (0x80)
+            while i < size and data[i] == 0x00:
+                i += 1
+            if i < size and data[i] == 0x80:
+                i += 1
+            yield "sync", None, b""
+
+        elif header == 0x70:
+            yield "overflow", None, b""
+
+        elif header & 0x03:
+            # Source packet: [7:3] port, [2] hardware (DWT) source, [1:0] payload size
+            length = PAYLOAD_SIZE[header & 0x03]
+            payload = data[i:i + length]
+            i += length
+            if len(payload) < length:
+                return
+            yield ("hardware" if header & 0x04 else "stimulus"), header >> 3, payload
+
+        elif (header & 0x0F) == 0x00:
+            # Local timestamp: short form in [6:4], long form in continuation bytes
+            value = (header >> 4) & 0x07
+            if header & 0x80:
+                value, shift = 0, 0
+                while i < size:
+                    byte = data[i]
+                    i += 1
+                    value |= (byte & 0x7F) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+            yield "timestamp", None, value
+
+        else:
+            # Extension and global timestamp packets: skip the continuation bytes
+            if header & 0x80:
+                while i < size:
+                    byte = data[i]
+                    i += 1
+                    if not byte & 0x80:
+                        break
+            yield "extension", None, b""
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Parse a captured SWO (ITM) byte stream")
+    parser.add_argument("input", nargs="?", help="capture file (default: stdin)")
+    parser.add_argument("--port", type=int, action="append", help="only show these stimulus ports (repeatable)")
+    parser.add_argument("--raw", type=int, metavar="PORT", help="write the raw payload of one port to stdout")
+    parser.add_argument("--timestamps", action="store_true", help="show the local timestamp packets")
+    options = parser.parse_args()
+
+    data = open(options.input, "rb").read() if options.input else sys.stdin.buffer.read()
+
+    if options.raw is not None:
+        out = sys.stdout.buffer
+        for kind, port, payload in packets(data):
+            if kind == "stimulus" and port == options.raw:
+                out.write(payload)
+        out.flush()
+        return
+
+    text = ""
+    for kind, port, payload in packets(data):
+        if kind == "overflow":
+            print("<overflow: packets lost>")
+        elif kind == "timestamp" and options.timestamps:
+            print("<timestamp +%d>" % payload)
+        elif kind == "stimulus" and (options.port is None or port in options.port):
+            if port == ITM_PORT_PRINTF:
+                text += payload.decode("latin-1")
+                while "\n" in text:
+                    line, text = text.split("\n", 1)
+                    print(line.rstrip("\r"))
+            else:
+                print("[port %2d] %s" % (port, payload[::-1].hex()))
+    if text:
+        print(text)
+
+
+if __name__ == "__main__":
+    main()
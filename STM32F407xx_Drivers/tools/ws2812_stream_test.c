@@ -0,0 +1,198 @@
+/*
+ * ws2812_stream_test.c
+ *
+ *  Created on: Oct 16, 2020
+ *      Author: Donavan Tran
+ *      Description: Host test of the WS2812 pulse stream (drivers/Src/STM32F407xx_WS2812_Driver.c).
+ *      			 The timer and the DMA stream are replaced by a model: each update
+ *      			 moves the next word of the circular buffer to CCRx, the half
+ *      			 transfer and transfer complete events call the driver callback
+ *      			 in the same order as DMA_IRQHandling(). The slots sent are checked
+ *      			 against the framebuffer: Bit0/Bit1 duty cycles, G R B order, MSB
+ *      			 first, then at least WS2812_RESET_SLOTS low slots.
+ *
+ *  Usage:
+ *      gcc -std=gnu11 -w -Idrivers/Inc tools/ws2812_stream_test.c \
+ *          drivers/Src/STM32F407xx_WS2812_Driver.c -o ws2812_stream_test
+ *      ./ws2812_stream_test
+ *
+ *  Exit code 0 when every case passes.
+ */
+
+#include "stm32f407xx.h"
+#include <stdio.h>
+
+#define MAX_LEDS			64U
+#define MAX_SLOTS			((MAX_LEDS + 4U * WS2812_LEDS_PER_HALF) * WS2812_BITS_PER_LED + 4U * WS2812_RESET_SLOTS)
+
+//84 MHz timer clock (APB1 at 42 MHz, x2): 105 clocks per bit
+#define TIMER_PERIOD		105U
+#define EXPECTED_BIT0		((TIMER_PERIOD * WS2812_T0H_PCT) / 100U)
+#define EXPECTED_BIT1		((TIMER_PERIOD * WS2812_T1H_PCT) / 100U)
+
+/*
+ * Stubs of the target drivers used by the WS2812 driver
+ */
+const RCC_PeriphDesc_t RCC_PeriphTable[RCC_PERIPH_TABLE_SIZE];
+
+uint32_t RCC_GetHCLKFreq(void) {
+	return 168000000U;
+}
+
+uint32_t RCC_GetPCLK1Freq(void) {
+	return 42000000U;
+}
+
+uint32_t RCC_GetPCLK2Freq(void) {
+	return 42000000U;
+}
+
+static uint8_t StreamEnabled;
+
+void DMA_Init(DMA_Handle_t* pDMAHandler) {
+	(void) pDMAHandler;
+}
+
+void DMA_Start(DMA_Handle_t* pDMAHandler, uint32_t periphAddr, uint32_t memAddr, uint16_t len) {
+	(void) pDMAHandler;
+	(void) periphAddr;
+	(void) memAddr;
+	(void) len;
+	StreamEnabled = 1;
+}
+
+void DMA_Stop(DMA_Handle_t* pDMAHandler) {
+	(void) pDMAHandler;
+	StreamEnabled = 0;
+}
+
+/*
+ * Application callback of the driver
+ */
+static uint32_t RefreshDone;
+static uint32_t DMAErrors;
+
+void WS2812_ApplicationEventCallback(WS2812_Handle_t* pWS2812Handler, uint8_t appEvt) {
+	(void) pWS2812Handler;
+	if (appEvt == WS2812_EVT_REFRESH_CMPLT) {
+		RefreshDone++;
+	} else {
+		DMAErrors++;
+	}
+}
+
+static TIM_Reg_t Timer;
+static DMA_Handle_t DMAHandler;
+static WS2812_Handle_t Strip;
+static uint8_t Pixels[MAX_LEDS * 3U];
+static uint32_t Slots[MAX_SLOTS];
+
+static uint32_t Failures;
+
+#define CHECK(__COND__, ...)	do { if (!(__COND__)) { printf(__VA_ARGS__); printf("\n"); Failures++; return; } } while (0)
+
+/*
+ * Replay of the circular DMA: one word per timer update, HT after the last word of
+ * the first half, TC after the last word of the second half. Returns the number of
+ * slots moved before the driver stopped the stream
+ */
+static uint32_t replayStream(void) {
+	uint32_t count = 0;
+	uint32_t index = 0;
+
+	while (StreamEnabled && count < MAX_SLOTS) {
+		Slots[count++] = Strip.DMABuffer[index++];
+
+		if (index == WS2812_SLOTS_PER_HALF) {
+			DMAHandler.Callback(&DMAHandler, DMA_EVT_HALF_CMPLT);
+		} else if (index == WS2812_DMA_BUFFER_LEN) {
+			index = 0;
+			DMAHandler.Callback(&DMAHandler, DMA_EVT_TRANSFER_CMPLT);
+		}
+	}
+
+	//The stream can fetch one more word before the ISR stops it: it must be a 0
+	if (count < MAX_SLOTS) {
+		Slots[count] = Strip.DMABuffer[index];
+	}
+	return count;
+}
+
+static void testStrip(uint16_t numLeds) {
+	uint32_t count, slot, zeros;
+	uint8_t expected[3], value;
+
+	memset(&Timer, 0, sizeof(Timer));
+	memset(&DMAHandler, 0, sizeof(DMAHandler));
+	memset(&Strip, 0, sizeof(Strip));
+	Strip.pTIMx = &Timer;
+	Strip.Channel = 2;
+	Strip.pDMAHandler = &DMAHandler;
+	Strip.pPixels = Pixels;
+	Strip.NumLeds = numLeds;
+	WS2812_Init(&Strip);
+
+	CHECK(Strip.Bit0 == EXPECTED_BIT0 && Strip.Bit1 == EXPECTED_BIT1 && Timer.ARR == TIMER_PERIOD - 1U,
+		  "%u LEDs: Bit0 %u Bit1 %u ARR %u", numLeds, Strip.Bit0, Strip.Bit1, Timer.ARR);
+	CHECK(DMAHandler.DMA_Config.Circular == ENABLE && DMAHandler.DMA_Config.HalfTransferIT == ENABLE &&
+		  DMAHandler.DMA_Config.DataSize == DMA_DATA_SIZE_WORD && DMAHandler.pContext == &Strip,
+		  "%u LEDs: DMA stream not set up for the half refill", numLeds);
+
+	//Different red, green and blue levels on every LED
+	for (uint16_t i = 0; i < numLeds; i++) {
+		WS2812_SetPixel(&Strip, i, (uint8_t) (i * 7U + 0x81U), (uint8_t) (i * 13U + 0x42U), (uint8_t) (i * 29U + 0x17U));
+	}
+
+	RefreshDone = 0;
+	DMAErrors = 0;
+	CHECK(WS2812_Refresh(&Strip) == WS2812_OK, "%u LEDs: refresh refused", numLeds);
+	CHECK(WS2812_Refresh(&Strip) == WS2812_ERR_BUSY, "%u LEDs: second refresh accepted while busy", numLeds);
+
+	count = replayStream();
+	CHECK(RefreshDone == 1 && DMAErrors == 0 && Strip.State == WS2812_READY,
+		  "%u LEDs: refresh not completed (%u events)", numLeds, RefreshDone);
+	CHECK(Timer.CCR[Strip.Channel - 1] == 0, "%u LEDs: CCRx left at %u", numLeds, Timer.CCR[Strip.Channel - 1]);
+	CHECK(count >= numLeds * WS2812_BITS_PER_LED + WS2812_RESET_SLOTS,
+		  "%u LEDs: %u slots sent", numLeds, count);
+
+	//Data: G, R, B bytes of each LED, MSB first
+	for (uint16_t i = 0; i < numLeds; i++) {
+		expected[0] = (uint8_t) (i * 13U + 0x42U);
+		expected[1] = (uint8_t) (i * 7U + 0x81U);
+		expected[2] = (uint8_t) (i * 29U + 0x17U);
+
+		for (uint8_t color = 0; color < 3; color++) {
+			value = 0;
+			for (uint8_t bit = 0; bit < 8; bit++) {
+				slot = Slots[(i * 3U + color) * 8U + bit];
+				CHECK(slot == Strip.Bit0 || slot == Strip.Bit1,
+					  "%u LEDs: LED %u color %u bit %u: slot %u", numLeds, i, color, bit, slot);
+				value = (uint8_t) ((value << 1) | (slot == Strip.Bit1));
+			}
+			CHECK(value == expected[color], "%u LEDs: LED %u color %u: 0x%02X instead of 0x%02X",
+				  numLeds, i, color, value, expected[color]);
+		}
+	}
+
+	//Reset: every slot after the data is low, including the one fetched at the stop
+	zeros = 0;
+	for (slot = numLeds * WS2812_BITS_PER_LED; slot <= count && slot < MAX_SLOTS; slot++) {
+		CHECK(Slots[slot] == 0, "%u LEDs: reset slot %u is %u", numLeds, slot, Slots[slot]);
+		zeros++;
+	}
+	CHECK(zeros >= WS2812_RESET_SLOTS, "%u LEDs: %u reset slots", numLeds, zeros);
+}
+
+int main(void) {
+	//Empty strip, less than a half, exactly two halves, then several halves
+	//refilled by HT/TC, with and without a partial last half
+	const uint16_t cases[] = { 0, 1, 2 * WS2812_LEDS_PER_HALF, 2 * WS2812_LEDS_PER_HALF + 1,
+							   5 * WS2812_LEDS_PER_HALF, 5 * WS2812_LEDS_PER_HALF + 3, MAX_LEDS };
+
+	for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		testStrip(cases[i]);
+	}
+
+	printf("ws2812_stream_test: %u failure(s)\n", Failures);
+	return Failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}